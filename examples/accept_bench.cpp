@@ -0,0 +1,187 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "event_loop.hpp"
+#include "connection_manager.hpp"
+#include "thread_pool.hpp"
+#include "web_server.hpp"
+
+using namespace ppserver;
+
+/**
+ * 连接建立/关闭速率压测（连接对象池）
+ * 每个客户端线程循环执行：建连 → shutdown(SHUT_WR) → 等服务端关闭 → close，不发送请求，
+ * 只测accept路径；服务端主动关闭，TIME_WAIT留在服务端，不耗尽客户端端口。
+ * 通过替换全局operator new统计测量期间进程内的堆分配次数（客户端循环本身不分配）
+ * 用法：accept_bench [clients=16] [seconds=3] [loops=4]
+ */
+
+static std::atomic<bool> g_counting{false};
+static std::atomic<uint64_t> g_allocations{0};
+static std::atomic<uint64_t> g_allocated_bytes{0};
+
+void* operator new(size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+struct BenchCase {
+    const char* name;
+    WebServer::ReactorMode mode;
+    bool pool_connections;
+};
+
+static bool DoConnect(const sockaddr_in& addr) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+    shutdown(fd, SHUT_WR);
+    char buffer[256];
+    while (read(fd, buffer, sizeof(buffer)) > 0) {
+    }
+    close(fd);
+    return true;
+}
+
+static void RunCase(const BenchCase& bench, uint16_t port, size_t clients,
+                    int seconds, size_t loops) {
+    EventLoop main_loop;
+    ConnectionManager conn_manager;
+    ThreadPool thread_pool({1, 1, 1000, std::chrono::seconds(60)});
+
+    WebServer::Config config;
+    config.host = "127.0.0.1";
+    config.port = port;
+    config.backlog = 4096;
+    config.max_connections = 100000;
+    config.reactor_mode = bench.mode;
+    config.loop_threads = loops;
+    config.pool_connections = bench.pool_connections;
+
+    WebServer server(config, main_loop, conn_manager, thread_pool);
+    if (!server.Start()) {
+        std::printf("%-24s failed to start\n", bench.name);
+        return;
+    }
+    std::thread loop_thread([&main_loop]() { main_loop.Run(); });
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    // 预热：让对象池、fd表、定时轮等达到稳态后再计数
+    for (size_t i = 0; i < clients * 4; ++i) {
+        DoConnect(addr);
+    }
+
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> completed{0};
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < clients; ++i) {
+        workers.emplace_back([&]() {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (DoConnect(addr)) {
+                    completed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    uint64_t accepted_before = 0;
+    for (const auto& s : server.GetLoopStatistics()) {
+        accepted_before += s.total_connections;
+    }
+    g_allocations = 0;
+    g_allocated_bytes = 0;
+    g_counting = true;
+    go.store(true, std::memory_order_release);
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& t : workers) {
+        t.join();
+    }
+    // 等在途连接处理完
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    g_counting = false;
+
+    std::vector<WebServer::LoopStatistics> stats = server.GetLoopStatistics();
+    main_loop.RunInLoop([&server]() { server.Stop(); });
+    loop_thread.join();
+
+    uint64_t accepted = 0;
+    uint64_t reused = 0;
+    uint64_t created = 0;
+    for (const auto& s : stats) {
+        accepted += s.total_connections;
+        reused += s.connections_reused;
+        created += s.connections_created;
+    }
+    accepted -= accepted_before;
+    double per_conn = accepted ? 1.0 / accepted : 0.0;
+
+    std::printf("%-24s %10.0f conn/s  allocs/conn=%.2f bytes/conn=%.0f  objects created=%llu reused=%llu\n",
+                bench.name, static_cast<double>(completed.load()) / seconds,
+                g_allocations.load() * per_conn, g_allocated_bytes.load() * per_conn,
+                static_cast<unsigned long long>(created), static_cast<unsigned long long>(reused));
+}
+
+int main(int argc, char** argv) {
+    size_t clients = argc > 1 ? std::stoul(argv[1]) : 16;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 3;
+    size_t loops = argc > 3 ? std::stoul(argv[3]) : 4;
+
+    // 屏蔽服务器逐连接的日志输出
+    std::cout.rdbuf(nullptr);
+    std::cerr.rdbuf(nullptr);
+
+    std::printf("clients=%zu seconds=%d io_loops=%zu\n", clients, seconds, loops);
+    const BenchCase cases[] = {
+        {"single-loop/make_shared", WebServer::ReactorMode::SINGLE, false},
+        {"single-loop/pooled", WebServer::ReactorMode::SINGLE, true},
+        {"reuseport/make_shared", WebServer::ReactorMode::REUSEPORT, false},
+        {"reuseport/pooled", WebServer::ReactorMode::REUSEPORT, true},
+    };
+
+    uint16_t port = 19180;
+    for (const auto& bench : cases) {
+        RunCase(bench, port++, clients, seconds, loops);
+    }
+    return 0;
+}
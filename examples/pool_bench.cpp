@@ -0,0 +1,84 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdio>
+
+#include "http_request.hpp"
+#include "memory_pool.hpp"
+
+using namespace ppserver;
+
+/**
+ * MemoryPool与new/delete对比测试
+ * T个线程各自循环：创建kWindow个HttpRequest、再全部销毁（模拟一个loop上同时在途的请求），
+ * 统计每个对象一次创建+销毁的平均耗时；池模式同时输出槽总数、使用峰值与批量搬运次数
+ * 用法：pool_bench [rounds_per_thread=200000]
+ */
+
+static constexpr size_t kWindow = 16;
+
+template <typename Create, typename Destroy>
+static double RunCase(size_t threads, size_t rounds, Create create, Destroy destroy) {
+    std::atomic<bool> go{false};
+    std::atomic<size_t> ready{0};
+    std::atomic<size_t> checksum{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            HttpRequest* window[kWindow];
+            size_t local = 0;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            for (size_t r = 0; r < rounds; ++r) {
+                for (size_t i = 0; i < kWindow; ++i) {
+                    window[i] = create();
+                    window[i]->SetMethod(HttpRequest::Method::GET);
+                }
+                for (size_t i = 0; i < kWindow; ++i) {
+                    local += static_cast<size_t>(window[i]->GetMethod());
+                    destroy(window[i]);
+                }
+            }
+            checksum.fetch_add(local);
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) {
+        w.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    return ns / static_cast<double>(threads * rounds * kWindow);
+}
+
+int main(int argc, char** argv) {
+    size_t rounds = argc > 1 ? std::stoul(argv[1]) : 200000;
+    std::printf("object=HttpRequest (%zu bytes) window=%zu rounds/thread=%zu\n",
+                sizeof(HttpRequest), kWindow, rounds);
+
+    for (size_t threads : {1, 8, 32}) {
+        double heap = RunCase(threads, rounds,
+                              []() { return new HttpRequest(); },
+                              [](HttpRequest* request) { delete request; });
+
+        HttpRequestPool pool;
+        double pooled = RunCase(threads, rounds,
+                                [&pool]() { return pool.Construct(); },
+                                [&pool](HttpRequest* request) { pool.Destroy(request); });
+        HttpRequestPool::Statistics stats = pool.GetStatistics();
+
+        std::printf("threads=%-3zu new/delete %8.1f ns/obj  pool %8.1f ns/obj  "
+                    "(capacity=%zu used=%zu high_water=%zu refills=%llu flushes=%llu)\n",
+                    threads, heap, pooled, stats.capacity, stats.used, stats.high_water,
+                    static_cast<unsigned long long>(stats.refills),
+                    static_cast<unsigned long long>(stats.flushes));
+    }
+    return 0;
+}
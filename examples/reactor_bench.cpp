@@ -0,0 +1,200 @@
+#include <iostream>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "event_loop.hpp"
+#include "connection_manager.hpp"
+#include "thread_pool.hpp"
+#include "web_server.hpp"
+
+using namespace ppserver;
+
+/**
+ * Reactor线程模型压测
+ * 对比：单Reactor / 主从Reactor(轮询、最少连接) / SO_REUSEPORT多Reactor
+ * 每个客户端线程循环执行：建连 → 依次发送N个GET并读完整响应（keep-alive，最后一个带Connection: close）
+ * → RST关闭（避免TIME_WAIT耗尽端口）
+ * 用法：reactor_bench [clients=32] [seconds=3] [loops=4] [backend=epoll|io_uring] [requests_per_conn=1]
+ */
+
+struct BenchCase {
+    const char* name;
+    WebServer::ReactorMode mode;
+    WebServer::LoadBalance balance;
+};
+
+// 读一个完整响应：读到头部结束并拿到Content-Length后，读够正文即完成
+static bool ReadResponse(int fd) {
+    std::string response;
+    char buffer[4096];
+    while (true) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            return false;
+        }
+        response.append(buffer, n);
+        size_t header_end = response.find("\r\n\r\n");
+        if (header_end == std::string::npos) {
+            continue;
+        }
+        size_t pos = response.find("Content-Length: ");
+        size_t length = pos == std::string::npos ? 0 : std::stoul(response.substr(pos + 16));
+        if (response.size() >= header_end + 4 + length) {
+            return true;
+        }
+    }
+}
+
+// 在一条连接上依次发送requests个请求，返回完成的请求数
+static uint64_t DoSession(const sockaddr_in& addr, size_t requests) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return 0;
+    }
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+    static const char close_request[] =
+        "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n";
+    static const char keep_alive_request[] =
+        "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    uint64_t completed = 0;
+    for (size_t i = 0; i < requests; ++i) {
+        bool last = (i + 1 == requests);
+        const char* request = last ? close_request : keep_alive_request;
+        size_t length = last ? sizeof(close_request) - 1 : sizeof(keep_alive_request) - 1;
+        if (write(fd, request, length) < 0 || !ReadResponse(fd)) {
+            break;
+        }
+        ++completed;
+    }
+
+    linger lg{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    close(fd);
+    return completed;
+}
+
+static void RunCase(const BenchCase& bench, uint16_t port, size_t clients,
+                    int seconds, size_t loops, EventLoop::Backend backend,
+                    size_t requests_per_conn) {
+    EventLoop main_loop(backend);
+    ConnectionManager conn_manager;
+    ThreadPool thread_pool({1, 1, 1000, std::chrono::seconds(60)});
+
+    WebServer::Config config;
+    config.host = "127.0.0.1";
+    config.port = port;
+    config.backlog = 4096;
+    config.max_connections = 100000;
+    config.reactor_mode = bench.mode;
+    config.load_balance = bench.balance;
+    config.loop_threads = loops;
+    config.io_backend = backend;
+
+    WebServer server(config, main_loop, conn_manager, thread_pool);
+    if (!server.Start()) {
+        std::printf("%-28s failed to start\n", bench.name);
+        return;
+    }
+    std::thread loop_thread([&main_loop]() { main_loop.Run(); });
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < clients; ++i) {
+        workers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint64_t done = DoSession(addr, requests_per_conn);
+                completed.fetch_add(done, std::memory_order_relaxed);
+                if (done < requests_per_conn) {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    std::vector<WebServer::LoopStatistics> stats = server.GetLoopStatistics();
+    main_loop.RunInLoop([&server]() { server.Stop(); });
+    loop_thread.join();
+
+    uint64_t requests = 0;
+    uint64_t read_calls = 0;
+    uint64_t bytes_copied = 0;
+    uint64_t write_calls = 0;
+    for (const auto& s : stats) {
+        requests += s.requests;
+        read_calls += s.read_calls;
+        bytes_copied += s.bytes_copied;
+        write_calls += s.write_calls;
+    }
+    double per_request = requests ? 1.0 / requests : 0.0;
+
+    std::printf("%-28s %10.0f req/s  failed=%llu  readv/req=%.2f writes/req=%.2f copied/req=%.1fB  per-loop:",
+                bench.name, static_cast<double>(completed.load()) / seconds,
+                static_cast<unsigned long long>(failed.load()),
+                read_calls * per_request, write_calls * per_request, bytes_copied * per_request);
+    for (const auto& s : stats) {
+        std::printf(" %llu", static_cast<unsigned long long>(s.total_connections));
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    size_t clients = argc > 1 ? std::stoul(argv[1]) : 32;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 3;
+    size_t loops = argc > 3 ? std::stoul(argv[3]) : 4;
+    EventLoop::Backend backend = (argc > 4 && std::string(argv[4]) == "io_uring")
+                                     ? EventLoop::Backend::IO_URING
+                                     : EventLoop::Backend::EPOLL;
+    size_t requests_per_conn = argc > 5 ? std::max<size_t>(1, std::stoul(argv[5])) : 1;
+
+    // 屏蔽服务器逐连接的日志输出（含客户端RST引起的读错误），避免测成终端吞吐
+    std::cout.rdbuf(nullptr);
+    std::cerr.rdbuf(nullptr);
+
+    // 请求io_uring但内核不支持时EventLoop会回退epoll，以实际后端为准
+    bool uring = EventLoop(backend).GetBackend() == EventLoop::Backend::IO_URING;
+    std::printf("clients=%zu seconds=%d io_loops=%zu backend=%s requests/conn=%zu\n", clients, seconds,
+                loops, uring ? "io_uring" : "epoll", requests_per_conn);
+    const BenchCase cases[] = {
+        {"single-loop", WebServer::ReactorMode::SINGLE, WebServer::LoadBalance::ROUND_ROBIN},
+        {"acceptor/round-robin", WebServer::ReactorMode::ACCEPTOR, WebServer::LoadBalance::ROUND_ROBIN},
+        {"acceptor/least-connections", WebServer::ReactorMode::ACCEPTOR, WebServer::LoadBalance::LEAST_CONNECTIONS},
+        {"reuseport", WebServer::ReactorMode::REUSEPORT, WebServer::LoadBalance::ROUND_ROBIN},
+    };
+
+    uint16_t port = 19080;
+    for (const auto& bench : cases) {
+        RunCase(bench, port++, clients, seconds, loops, backend, requests_per_conn);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "router.hpp"
+
+using namespace ppserver;
+
+/**
+ * Router匹配性能测试：分别注册1,000与10,000条GET路由后，按随机顺序匹配对应的请求路径
+ * 路由四类轮流出现：静态 /api/v1/res{i}、单参数 /api/v1/res{i}/:id、
+ *                 双参数 /users/{i}/:uid/posts/:pid、通配 /files{i}/ 后接 *path
+ * 另测同样数量的未命中路径（与已注册路由共享前缀，需要回溯）；
+ * 输出每次匹配的耗时与每次匹配的堆分配次数（替换全局operator new计数，应为0）
+ * 用法：router_bench [matches=2000000]
+ */
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+struct Sample {
+    double ns_per_match = 0;
+    double allocs_per_match = 0;
+    size_t matched = 0;
+};
+
+static void Register(Router& router, size_t routes, std::vector<std::string>& hits,
+                     std::vector<std::string>& misses) {
+    Router::Handler handler = [](const HttpRequestView&, const RouteParams&, HttpResponse&) {};
+    for (size_t i = 0; i < routes; ++i) {
+        std::string n = std::to_string(i);
+        switch (i % 4) {
+            case 0:
+                router.Add(HttpRequest::Method::GET, "/api/v1/res" + n, handler);
+                hits.push_back("/api/v1/res" + n);
+                misses.push_back("/api/v1/res" + n + "x");
+                break;
+            case 1:
+                router.Add(HttpRequest::Method::GET, "/api/v1/res" + n + "/:id", handler);
+                hits.push_back("/api/v1/res" + n + "/42");
+                misses.push_back("/api/v1/res" + n + "/42/extra");
+                break;
+            case 2:
+                router.Add(HttpRequest::Method::GET, "/users/" + n + "/:uid/posts/:pid", handler);
+                hits.push_back("/users/" + n + "/alice/posts/7");
+                misses.push_back("/users/" + n + "/alice/comments/7");
+                break;
+            default:
+                router.Add(HttpRequest::Method::GET, "/files" + n + "/*path", handler);
+                hits.push_back("/files" + n + "/a/b/c.txt");
+                misses.push_back("/filez" + n + "/a/b/c.txt");
+                break;
+        }
+    }
+}
+
+static Sample Run(const Router& router, const std::vector<std::string>& paths, size_t matches) {
+    std::vector<size_t> order(paths.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(12345));
+
+    RouteParams params;
+    Sample sample;
+    uint64_t allocs_before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < matches; ++i) {
+        const std::string& path = paths[order[i % order.size()]];
+        if (router.Match(HttpRequest::Method::GET, path, params)) {
+            ++sample.matched;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    sample.ns_per_match = elapsed.count() / static_cast<double>(matches);
+    sample.allocs_per_match = static_cast<double>(g_allocations.load() - allocs_before) /
+                              static_cast<double>(matches);
+    return sample;
+}
+
+int main(int argc, char** argv) {
+    size_t matches = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    std::printf("matches=%zu per run\n", matches);
+
+    for (size_t routes : {1000, 10000}) {
+        Router router;
+        std::vector<std::string> hits;
+        std::vector<std::string> misses;
+        Register(router, routes, hits, misses);
+
+        Sample hit = Run(router, hits, matches);
+        Sample miss = Run(router, misses, matches);
+        std::printf("routes=%-6zu hit  %7.1f ns/match %4.2f allocs/match matched=%zu\n",
+                    routes, hit.ns_per_match, hit.allocs_per_match, hit.matched);
+        std::printf("routes=%-6zu miss %7.1f ns/match %4.2f allocs/match matched=%zu\n",
+                    routes, miss.ns_per_match, miss.allocs_per_match, miss.matched);
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdio>
+
+#include "event_loop.hpp"
+
+using namespace ppserver;
+
+/**
+ * QueueInLoop跨线程投递吞吐测试
+ * P个生产者线程各向同一个运行中的EventLoop投递N个任务，统计全部执行完的耗时，
+ * 以及eventfd写入次数（合并唤醒的效果）
+ * 用法：task_queue_bench [tasks_per_producer=200000]
+ */
+
+static void RunCase(size_t producers, size_t tasks_per_producer) {
+    EventLoop loop;
+    std::thread loop_thread([&loop]() { loop.Run(); });
+
+    // 等loop进入Run()
+    std::atomic<bool> ready{false};
+    loop.QueueInLoop([&ready]() { ready = true; });
+    while (!ready.load()) {
+        std::this_thread::yield();
+    }
+    uint64_t writes_before = loop.GetStatistics().wakeup_writes;
+
+    const size_t total = producers * tasks_per_producer;
+    std::atomic<size_t> executed{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&]() {
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            for (size_t i = 0; i < tasks_per_producer; ++i) {
+                loop.QueueInLoop([&executed]() {
+                    executed.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto submitted = std::chrono::steady_clock::now();
+    while (executed.load(std::memory_order_relaxed) < total) {
+        std::this_thread::yield();
+    }
+    auto finished = std::chrono::steady_clock::now();
+
+    EventLoop::Statistics stats = loop.GetStatistics();
+    loop.Stop();
+    loop_thread.join();
+
+    double submit_sec = std::chrono::duration<double>(submitted - start).count();
+    double total_sec = std::chrono::duration<double>(finished - start).count();
+    std::printf("producers=%-3zu submit %8.2f Mtask/s  end-to-end %8.2f Mtask/s  "
+                "eventfd writes=%llu (%.4f per task)  loop iterations=%llu\n",
+                producers, total / submit_sec / 1e6, total / total_sec / 1e6,
+                static_cast<unsigned long long>(stats.wakeup_writes - writes_before),
+                static_cast<double>(stats.wakeup_writes - writes_before) / total,
+                static_cast<unsigned long long>(stats.loop_iterations));
+}
+
+int main(int argc, char** argv) {
+    size_t tasks = argc > 1 ? std::stoul(argv[1]) : 200000;
+    for (size_t producers : {1, 4, 16}) {
+        RunCase(producers, tasks);
+    }
+    return 0;
+}
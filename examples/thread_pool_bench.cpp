@@ -0,0 +1,189 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+using namespace ppserver;
+
+/**
+ * ThreadPool细粒度任务扩展性测试，工作线程数1~32
+ * external：主线程Submit N个小任务（全部经过注入队列）
+ * spawn：   每个根任务在工作线程内再Submit kFanout个子任务（进入本地队列，由空闲线程窃取）
+ * 每个任务只做约kSpinWork次整数运算，耗时由调度开销主导；
+ * 两种场景分别用Submit（返回future）和Post（不关心结果）提交，
+ * 输出吞吐、每个任务的堆分配次数（替换全局operator new计数）与窃取/停放次数；
+ * 以上不限队列长度。最后在max_tasks=kQueueBound下用各拒绝策略外部TryPost，输出入队/完成/拒绝等计数
+ * 用法：thread_pool_bench [tasks=200000]
+ */
+
+static constexpr size_t kSpinWork = 200;
+static constexpr size_t kFanout = 64;
+static constexpr size_t kQueueBound = 1024;
+
+static std::atomic<uint64_t> g_sink{0};
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+struct Sample {
+    double mtasks_per_sec = 0;
+    double allocs_per_task = 0;
+};
+
+enum class Mode { SUBMIT, POST };
+
+template <typename F>
+static void Enqueue(ThreadPool& pool, Mode mode, F&& f) {
+    if (mode == Mode::SUBMIT) {
+        pool.Submit(std::forward<F>(f));
+    } else {
+        pool.Post(std::forward<F>(f));
+    }
+}
+
+static void Work() {
+    uint64_t x = 1;
+    for (size_t i = 0; i < kSpinWork; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    g_sink.fetch_add(x & 1, std::memory_order_relaxed);
+}
+
+static ThreadPool::Config_thread_pool MakeConfig(size_t workers) {
+    ThreadPool::Config_thread_pool config;
+    config.core_threads = workers;
+    config.max_threads = workers;
+    config.max_tasks = 0;
+    return config;
+}
+
+static void WaitFor(const std::atomic<size_t>& done, size_t total) {
+    while (done.load(std::memory_order_acquire) < total) {
+        std::this_thread::yield();
+    }
+}
+
+static Sample Finish(std::chrono::steady_clock::time_point start, uint64_t allocs_before, size_t total) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    Sample sample;
+    sample.mtasks_per_sec = static_cast<double>(total) / elapsed.count() / 1e6;
+    sample.allocs_per_task = static_cast<double>(g_allocations.load() - allocs_before) /
+                             static_cast<double>(total);
+    return sample;
+}
+
+static Sample RunExternal(ThreadPool& pool, Mode mode, size_t tasks) {
+    std::atomic<size_t> done{0};
+    uint64_t allocs_before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        Enqueue(pool, mode, [&done]() {
+            Work();
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    WaitFor(done, tasks);
+    return Finish(start, allocs_before, tasks);
+}
+
+static Sample RunSpawn(ThreadPool& pool, Mode mode, size_t tasks) {
+    size_t roots = tasks / kFanout;
+    size_t total = roots * kFanout;
+    std::atomic<size_t> done{0};
+    uint64_t allocs_before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < roots; ++r) {
+        Enqueue(pool, mode, [&pool, &done, mode]() {
+            for (size_t i = 0; i < kFanout; ++i) {
+                Enqueue(pool, mode, [&done]() {
+                    Work();
+                    done.fetch_add(1, std::memory_order_release);
+                });
+            }
+        });
+    }
+    WaitFor(done, total);
+    return Finish(start, allocs_before, total);
+}
+
+int main(int argc, char** argv) {
+    size_t tasks = argc > 1 ? std::stoul(argv[1]) : 200000;
+    std::printf("tasks=%zu work=%zu iterations/task fanout=%zu hardware_concurrency=%u\n",
+                tasks, kSpinWork, kFanout, std::thread::hardware_concurrency());
+
+    for (size_t workers : {1, 2, 4, 8, 16, 32}) {
+        ThreadPool pool(MakeConfig(workers));
+        for (Mode mode : {Mode::SUBMIT, Mode::POST}) {
+            Sample external = RunExternal(pool, mode, tasks);
+            Sample spawn = RunSpawn(pool, mode, tasks);
+            std::printf("workers=%-3zu %-6s external %6.2f Mtasks/s %5.2f allocs/task  "
+                        "spawn %6.2f Mtasks/s %5.2f allocs/task\n",
+                        workers, mode == Mode::SUBMIT ? "submit" : "post",
+                        external.mtasks_per_sec, external.allocs_per_task,
+                        spawn.mtasks_per_sec, spawn.allocs_per_task);
+        }
+        ThreadPool::Statistics stats = pool.GetStatistics();
+        std::printf("            (injected=%llu local=%llu stolen=%llu parks=%llu)\n",
+                    static_cast<unsigned long long>(stats.injected),
+                    static_cast<unsigned long long>(stats.local_pushes),
+                    static_cast<unsigned long long>(stats.stolen),
+                    static_cast<unsigned long long>(stats.parks));
+    }
+
+    const std::pair<ThreadPool::RejectPolicy, const char*> policies[] = {
+        {ThreadPool::RejectPolicy::BLOCK, "block"},
+        {ThreadPool::RejectPolicy::REJECT, "reject"},
+        {ThreadPool::RejectPolicy::CALLER_RUNS, "caller_runs"},
+        {ThreadPool::RejectPolicy::DROP_OLDEST, "drop_oldest"},
+    };
+    for (const auto& [policy, name] : policies) {
+        ThreadPool::Config_thread_pool config = MakeConfig(4);
+        config.max_tasks = kQueueBound;
+        config.reject_policy = policy;
+        ThreadPool pool(config);
+        std::atomic<size_t> done{0};
+        size_t accepted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < tasks; ++i) {
+            accepted += pool.TryPost([&done]() {
+                Work();
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        pool.Shutdown(true);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        ThreadPool::Statistics stats = pool.GetStatistics();
+        std::printf("policy=%-12s max_tasks=%zu %6.2f Mposts/s  accepted=%zu queued=%llu completed=%llu "
+                    "rejected=%llu caller_runs=%llu dropped=%llu\n",
+                    name, kQueueBound, static_cast<double>(tasks) / elapsed.count() / 1e6, accepted,
+                    static_cast<unsigned long long>(stats.queued),
+                    static_cast<unsigned long long>(stats.completed),
+                    static_cast<unsigned long long>(stats.rejected),
+                    static_cast<unsigned long long>(stats.caller_runs),
+                    static_cast<unsigned long long>(stats.dropped));
+    }
+    return 0;
+}
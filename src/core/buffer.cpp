@@ -0,0 +1,90 @@
+#include "buffer.hpp"
+#include <cstring>
+#include <algorithm>
+#include <sys/uio.h>
+
+namespace ppserver {
+
+Buffer::Buffer(size_t initial_size)
+    : buffer_(initial_size),
+      reader_index_(0),
+      writer_index_(0),
+      bytes_copied_(0) {
+}
+
+void Buffer::Retrieve(size_t n) {
+    if (n >= ReadableBytes()) {
+        RetrieveAll();
+        return;
+    }
+    reader_index_ += n;
+}
+
+void Buffer::RetrieveAll() {
+    // 数据全部消费后下标归零，下一次读从头开始，无需挪动
+    reader_index_ = 0;
+    writer_index_ = 0;
+}
+
+void Buffer::Append(const char* data, size_t len) {
+    EnsureWritable(len);
+    std::memcpy(BeginWrite(), data, len);
+    writer_index_ += len;
+    bytes_copied_ += len;
+}
+
+void Buffer::EnsureWritable(size_t len) {
+    if (WritableBytes() >= len) {
+        return;
+    }
+    size_t readable = ReadableBytes();
+    if (reader_index_ + WritableBytes() >= len) {
+        // 头部已消费的空间足够：把未消费数据挪到头部
+        std::memmove(buffer_.data(), Peek(), readable);
+        bytes_copied_ += readable;
+    } else {
+        std::vector<char> grown(std::max(buffer_.size() * 2, readable + len));
+        std::memcpy(grown.data(), Peek(), readable);
+        bytes_copied_ += readable;
+        buffer_.swap(grown);
+    }
+    reader_index_ = 0;
+    writer_index_ = readable;
+}
+
+ssize_t Buffer::ReadFd(int fd) {
+    // 剩余空间不够时，多出的部分先落在栈上，避免为偶发的大请求预留大块内存
+    char extra[65536];
+    iovec vec[2];
+    size_t writable = WritableBytes();
+    vec[0].iov_base = BeginWrite();
+    vec[0].iov_len = writable;
+    vec[1].iov_base = extra;
+    vec[1].iov_len = sizeof(extra);
+    int iovcnt = writable < sizeof(extra) ? 2 : 1;
+
+    ssize_t n = readv(fd, vec, iovcnt);
+    if (n <= 0) {
+        return n;
+    }
+    if (static_cast<size_t>(n) <= writable) {
+        writer_index_ += n;
+    } else {
+        writer_index_ = buffer_.size();
+        Append(extra, n - writable);
+    }
+    return n;
+}
+
+void Buffer::Shrink() {
+    if (buffer_.size() <= kInitialSize) {
+        return;
+    }
+    std::vector<char> shrunk(std::max(kInitialSize, ReadableBytes()));
+    std::memcpy(shrunk.data(), Peek(), ReadableBytes());
+    writer_index_ = ReadableBytes();
+    reader_index_ = 0;
+    buffer_.swap(shrunk);
+}
+
+} // namespace ppserver
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <sys/types.h>
+
+namespace ppserver {
+
+/**
+ * Buffer - 连接读缓冲区
+ * 负责：从socket批量读入数据，供解析器原地消费
+ * 设计特点：单块连续内存 + 读写下标，[reader, writer)为未消费数据；
+ *          消费只移动读下标，空间不足时优先把未消费数据挪回头部而不是扩容，
+ *          内存随连接复用；ReadFd用readv同时读入剩余空间和栈上64KB临时区，
+ *          一次系统调用即可读完大请求，只有溢出到临时区的部分需要拷贝
+ * 线程安全：非线程安全，只在连接所属loop线程内访问
+ */
+class Buffer {
+public:
+    static constexpr size_t kInitialSize = 4096;
+
+    explicit Buffer(size_t initial_size = kInitialSize);
+
+    // 可读（未消费）数据
+    size_t ReadableBytes() const { return writer_index_ - reader_index_; }
+    size_t WritableBytes() const { return buffer_.size() - writer_index_; }
+    const char* Peek() const { return buffer_.data() + reader_index_; }
+
+    // 消费n字节（解析器处理完的数据）
+    void Retrieve(size_t n);
+    void RetrieveAll();
+
+    void Append(const char* data, size_t len);
+
+    // 从fd读一次（readv），返回值与read相同，出错时errno保留
+    ssize_t ReadFd(int fd);
+
+    // 释放多余容量（连接空闲/关闭时）
+    void Shrink();
+
+    // 因挪动、扩容、临时区溢出产生的用户态拷贝字节数（累计）
+    uint64_t BytesCopied() const { return bytes_copied_; }
+
+private:
+    char* BeginWrite() { return buffer_.data() + writer_index_; }
+    void EnsureWritable(size_t len);
+
+    std::vector<char> buffer_;
+    size_t reader_index_;
+    size_t writer_index_;
+    uint64_t bytes_copied_;
+};
+
+} // namespace ppserver
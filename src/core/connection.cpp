@@ -10,27 +10,67 @@
 namespace ppserver {
 
 // 构造函数
-Connection::Connection(int socket_fd, WebServer& server)
-    : socket_fd_(socket_fd),
+Connection::Connection(int socket_fd, WebServer& server, EventLoop& loop)
+    : socket_fd_(-1),
       state_(State::DISCONNECTED),
       server_(server),
-      event_loop_(server.GetEventLoop()),
-      create_time_(time(nullptr)),
-      last_activity_time_(create_time_),
+      event_loop_(loop),
+      pinned_bytes_(0),
+      write_armed_(false),
+      in_read_handler_(false),
+      peer_closed_(false),
+      close_after_write_(false),
+      reading_paused_(false),
+      read_pending_(false),
+      extra_bytes_copied_(0),
+      create_time_(0),
+      last_activity_time_(0),
       max_buffer_size_(1048576),   // 默认1MB缓冲区
-      timeout_seconds_(30) {       
-    
+      timeout_seconds_(30),
+      keep_alive_timeout_seconds_(0),
+      idle_timer_id_(0) {
+    http_parser_.SetArena(&request_arena_);
+    Reset(socket_fd);
+}
 
-    if (socket_fd_ < 0) {
+void Connection::Reset(int socket_fd) {
+    // 回收的对象已经Close()：缓冲区、输出队列、解析器保留各自已分配的内存，只清空内容
+    read_buffer_.RetrieveAll();
+    output_queue_.Clear();
+    http_parser_.Reset();
+    current_request_.reset();
+    request_view_.Clear();
+    view_backing_.reset();
+    request_arena_.Reset();
+    pinned_bytes_ = 0;
+    write_armed_ = false;
+    in_read_handler_ = false;
+    peer_closed_ = false;
+    close_after_write_ = false;
+    reading_paused_ = false;
+    read_pending_ = false;
+    io_stats_ = IoStatistics();
+    extra_bytes_copied_ = 0;
+    idle_timer_id_ = 0;
+    create_time_ = time(nullptr);
+    last_activity_time_ = create_time_;
+    state_ = State::DISCONNECTED;
+
+    if (socket_fd < 0) {
         throw std::invalid_argument("Invalid socket file descriptor");
     }
     socklen_t addr_len = sizeof(remote_addr_);
-    if (getpeername(socket_fd_, reinterpret_cast<sockaddr*>(&remote_addr_), &addr_len) < 0) {
+    if (getpeername(socket_fd, reinterpret_cast<sockaddr*>(&remote_addr_), &addr_len) < 0) {
         throw std::system_error(errno, std::system_category(), "Failed to get peer address");
     }
-    SetupSocketOptions();
+    socket_fd_ = socket_fd;
+    try {
+        SetupSocketOptions();
+    } catch (...) {
+        socket_fd_ = -1;   // fd仍归调用方所有
+        throw;
+    }
     state_ = State::CONNECTING;
-    
 }
 
 Connection::~Connection() {
@@ -53,6 +93,15 @@ void Connection::Start() {
     
     state_ = State::CONNECTED;
 
+    // 空闲超时：同一个定时器在每次活动时touch续期，不反复创建/取消
+    if (timeout_seconds_ > 0) {
+        // Close()会取消该定时器，回调触发时对象必然存活；只捕获this，闭包不额外分配内存
+        idle_timer_id_ = event_loop_.RunAfter(static_cast<uint64_t>(timeout_seconds_) * 1000,
+            [this]() {
+                HandleIdleTimeout();
+            });
+    }
+
     UpdateActivityTime();
     // Handler切入连接建立流程的入口点
     if (handler_) {
@@ -66,10 +115,22 @@ void Connection::Close() {
     }
     
     state_ = State::CLOSING;
+    // close_callback_会释放管理器持有的引用，保活到函数结束（析构中调用时为空）
+    std::shared_ptr<Connection> self = weak_from_this().lock();
+
+    if (idle_timer_id_ != 0) {
+        event_loop_.CancelTimer(idle_timer_id_);
+        idle_timer_id_ = 0;
+    }
     
     // 从事件循环中移除监控
     event_loop_.RemoveFd(socket_fd_);
     
+    // 通知所属的ConnectionManager移除连接（需在fd关闭前，避免fd复用冲突）
+    if (close_callback_) {
+        close_callback_();
+    }
+
     // 关闭套接字
     if (socket_fd_ >= 0) {
         shutdown(socket_fd_, SHUT_RDWR);
@@ -78,8 +139,8 @@ void Connection::Close() {
     }
     
     // Handler切入连接关闭流程的入口点
-    if (handler_) {
-        handler_->OnDisconnection(shared_from_this());
+    if (handler_ && self) {
+        handler_->OnDisconnection(self);
     }
     
     // 清理资源
@@ -92,75 +153,177 @@ ssize_t Connection::ReadData() {
     if (state_ != State::CONNECTED && state_ != State::READING) {
         return -1;
     }
-    char buffer[4096];
-    ssize_t n = read(socket_fd_, buffer, sizeof(buffer));// *****读取数据*****
-    
-    if (n > 0) {
+
+    read_pending_ = false;
+    if (reading_paused_) {
+        // 暂停期间数据留在socket中，ResumeReading时再读
+        errno = EAGAIN;
+        return -1;
+    }
+
+    // 读入可能挪动缓冲区，先释放上一个视图请求
+    ReleaseRequestView();
+
+    // 上一次读满后解析也没能消费：正文会被边到达边消费，只可能是请求行/头部超出缓冲区，
+    // 回复431后关闭，而不是让客户端只看到连接被重置
+    if (read_buffer_.ReadableBytes() >= max_buffer_size_) {
+        ParseState parse_state = http_parser_.GetCurrentState();
+        bool in_head = parse_state == ParseState::START_LINE || parse_state == ParseState::HEADERS;
+        RejectBadRequest("Read buffer overflow",
+                         in_head ? HttpResponse::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE
+                                 : HttpResponse::HttpStatusCode::BAD_REQUEST);
+        return -1;
+    }
+
+    // 边缘触发：一直读到EAGAIN，否则残留数据不会再触发可读事件
+    ssize_t total = 0;
+    while (true) {
+        ssize_t n = read_buffer_.ReadFd(socket_fd_);// *****读取数据*****
+        ++io_stats_.read_calls;
+        if (n > 0) {
+            total += n;
+            // 缓冲区已满：先交给解析器消费（正文边到达边交付），调用方随后再次读取
+            if (read_buffer_.ReadableBytes() >= max_buffer_size_) {
+                read_pending_ = true;
+                break;
+            }
+            continue;
+        }
+        if (n == 0) {
+            peer_closed_ = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        // 读取错误处理
+        NotifyError("Read error: " + std::string(strerror(errno)));
+        Close();
+        return -1;
+    }
+
+    if (total > 0) {
+        io_stats_.bytes_read += total;
         // 更新活动时间
         UpdateActivityTime();
-        
-        // 保护缓冲区访问
-        std::lock_guard<std::mutex> lock(buffer_mutex_);
-        
-        // 将数据追加到读缓冲区
-        read_buffer_.append(buffer, n);
-        
-        // 检查缓冲区大小限制
-        if (read_buffer_.size() > max_buffer_size_) {
-            NotifyError("Read buffer overflow");
-            Close();
-            return -1;
-        }
-        
         // 更新状态
         state_ = State::READING;
-        
-        return n;
-    } else if (n == 0) {
+        return total;
+    }
+    if (peer_closed_) {
         // 对端关闭连接
         Close();
         return 0;
-    } else {
-        // 读取错误处理
-        if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            NotifyError("Read error: " + std::string(strerror(errno)));
-            Close();
-        }
-        return -1;
     }
+    errno = EAGAIN;
+    return -1;
 }
 
 // 写入数据
 ssize_t Connection::WriteData(const std::string& data) {//给handler自实现handlewrite用的
-    // if (state_ != State::CONNECTED && state_ != State::WRITING) {
-    //     return -1;
-    // }
-    std::cout << "write_buffer_size111:" << write_buffer_.size() << std::endl;
-    // 保护缓冲区访问
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    
-    // 追加数据到写缓冲区
-    size_t old_size = write_buffer_.size();
-    write_buffer_.append(data);
-    std::cout << "write_buffer_size222:" << write_buffer_.size() << std::endl;
+    return WriteData(std::string(data));
+}
+
+ssize_t Connection::WriteData(std::string&& data) {
+    size_t length = data.size();
+    return EnqueueOutput(length, [data = std::move(data)](OutputQueue& queue) mutable {
+        queue.Append(std::move(data));
+    });
+}
+
+ssize_t Connection::WriteData(std::shared_ptr<const std::string> data) {
+    size_t length = data ? data->size() : 0;
+    return EnqueueOutput(length, [data = std::move(data)](OutputQueue& queue) mutable {
+        queue.Append(std::move(data));
+    });
+}
+
+ssize_t Connection::WriteFile(std::shared_ptr<const FileHandle> file, off_t offset, size_t length) {
+    return EnqueueOutput(length, [file = std::move(file), offset, length](OutputQueue& queue) mutable {
+        queue.AppendFile(std::move(file), offset, length);
+    });
+}
+
+template <typename Enqueue>
+ssize_t Connection::EnqueueOutput(size_t length, Enqueue&& enqueue) {
+    if (!event_loop_.IsInLoopThread()) {
+        // 输出队列只在loop线程内访问，跨线程写入转交loop线程
+        event_loop_.QueueInLoop([self = shared_from_this(), enqueue = std::move(enqueue)]() mutable {
+            if (self->GetState() != State::DISCONNECTED && self->GetState() != State::CLOSING) {
+                self->EnqueueOutput(0, std::move(enqueue));
+            }
+        });
+        return static_cast<ssize_t>(length);
+    }
+    if (socket_fd_ < 0) {
+        return -1;
+    }
+
+    enqueue(output_queue_);
     
-    // 检查缓冲区大小限制
-    if (write_buffer_.size() > max_buffer_size_) {
+    // 检查缓冲区大小限制（文件段不占内存，不计入）
+    if (output_queue_.BufferedBytes() > max_buffer_size_) {
         NotifyError("Write buffer overflow");
         Close();
         return -1;
     }
     
-    // 如果写缓冲区非空，注册写事件监控
-    if ( ! write_buffer_.empty()) {
-        ////////////////////////////////////////////updatefd只关注写事件////////////////////////////////////
-        event_loop_.UpdateFd(socket_fd_, 
-            EventLoop::EPOLL_READ | EventLoop::EPOLL_WRITE | EventLoop::EPOLL_ET);//*****注册写事件*****
-        
+    // 读回调中先只入队，回调结束后把流水线上的多个响应一次写出
+    if (!in_read_handler_ && !write_armed_) {
+        FlushOutput();
+    }
+    return static_cast<ssize_t>(length);
+}
+
+void Connection::FlushOutput() {
+    if (socket_fd_ < 0) {
+        return;
+    }
+    ssize_t n = output_queue_.Flush(socket_fd_, &io_stats_.write_calls);
+    if (n < 0) {
+        // 处理写错误
+        NotifyError("Write error: " + std::string(strerror(errno)));
+        Close();
+        return;
+    }
+    if (n > 0) {
+        io_stats_.bytes_written += static_cast<uint64_t>(n);
+        UpdateActivityTime();
+    }
+
+    if (!output_queue_.Empty()) {
+        // 写不完：注册写事件监控，等socket可写时继续
+        if (!write_armed_) {
+            event_loop_.UpdateFd(socket_fd_,
+                EventLoop::EPOLL_READ | EventLoop::EPOLL_WRITE | EventLoop::EPOLL_ET);//*****注册写事件*****
+            write_armed_ = true;
+        }
         state_ = State::WRITING;
+        return;
+    }
+
+    // 队列已清空
+    if (write_armed_) {
+        // //////////////////////更新事件监控，只关注读事件/////////////////////
+        event_loop_.UpdateFd(socket_fd_, EventLoop::EPOLL_READ | EventLoop::EPOLL_ET);
+        write_armed_ = false;
     }
+    state_ = State::CONNECTED;
+    // 响应已全部发出（序列化结果不在内存区中），归还本轮请求占用的内存
+    request_arena_.Reset();
     
-    return write_buffer_.size() - old_size;
+    // 触发写回调 
+    if (write_callback_) {
+        write_callback_();
+    }
+
+    // 对端已半关闭或请求不保持连接，响应发完即可关闭
+    if ((peer_closed_ || close_after_write_) && state_ == State::CONNECTED) {
+        Close();
+    }
 }
 
 
@@ -168,6 +331,7 @@ void Connection::HandleReadable() {
 
 
     // 这是Handler切入事件处理流程的入口点
+    in_read_handler_ = true;
     if (handler_) {
 
         handler_->HandleRead(shared_from_this());
@@ -175,6 +339,17 @@ void Connection::HandleReadable() {
 
         DefaultHandleRead();
     }
+    in_read_handler_ = false;
+    FlushAfterRead();
+}
+
+void Connection::FlushAfterRead() {
+    // 发送本次读回调中产生的全部响应
+    if (!output_queue_.Empty() && !write_armed_ && state_ != State::DISCONNECTED) {
+        FlushOutput();
+    } else if (close_after_write_ && output_queue_.Empty() && state_ != State::DISCONNECTED) {
+        Close();
+    }
 }
 
 void Connection::HandleWritable() {
@@ -195,12 +370,11 @@ void Connection::HandleError() {
 
 
 std::string Connection::GetReadBuffer() const{
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    return read_buffer_;
+    extra_bytes_copied_ += read_buffer_.ReadableBytes();
+    return std::string(read_buffer_.Peek(), read_buffer_.ReadableBytes());
 }
     void Connection::ClearReadBuffer(){
-        std::lock_guard<std::mutex> lock(buffer_mutex_);
-        read_buffer_.clear();
+        read_buffer_.RetrieveAll();
     }
 
 
@@ -237,11 +411,14 @@ std::string Connection::GetRemoteAddress() const {
 
 
 void Connection::CleanupResources() {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    read_buffer_.clear();
-    read_buffer_.shrink_to_fit();
-    write_buffer_.clear();
-    write_buffer_.shrink_to_fit();
+    pinned_bytes_ = 0;
+    request_view_.Clear();
+    view_backing_.reset();
+    request_arena_.Reset();
+    read_buffer_.RetrieveAll();
+    read_buffer_.Shrink();
+    output_queue_.Clear();
+    write_armed_ = false;
 }
 
 
@@ -269,33 +446,10 @@ void Connection::DefaultHandleRead() {
 
  
 
-void Connection::DefaultHandleWrite() {//buffer写到socket
+void Connection::DefaultHandleWrite() {//输出队列写到socket
     // 默认写处理逻辑
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    if (!write_buffer_.empty()) {//如果缓冲区非空
-        ssize_t n = write(socket_fd_, write_buffer_.c_str(), write_buffer_.size());
-        if (n > 0) {//如果写入成功
-            // 移除已写入的数据
-            write_buffer_.erase(0, n);
-            
-            // 如果缓冲区已清空
-            if (write_buffer_.empty()) {
-                // //////////////////////更新事件监控，只关注读事件/////////////////////
-                event_loop_.UpdateFd(socket_fd_, EventLoop::EPOLL_READ | EventLoop::EPOLL_ET);
-                state_ = State::CONNECTED;
-                
-                // 触发写回调 
-                if (write_callback_) {
-                    write_callback_();
-                }
-            }
-        } else if (n < 0) {
-            // 处理写错误
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                NotifyError("Write error: " + std::string(strerror(errno)));
-                Close();
-            }
-        }
+    if (!output_queue_.Empty()) {//如果队列非空
+        FlushOutput();
     }
 }
 void Connection::DefaultHandleError() {
@@ -305,42 +459,178 @@ void Connection::DefaultHandleError() {
 }
 
 bool Connection::TryParseHttpRequest() {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (read_buffer_.ReadableBytes() == 0 || close_after_write_ || reading_paused_) {
+        return false;
+    }
     
-    if (read_buffer_.empty()) {
+    // 解析器直接读连接缓冲区，已解析部分原地消费，未完成的行留待下次
+    ParseResult result = http_parser_.Parse(read_buffer_.Peek(), read_buffer_.ReadableBytes());
+    read_buffer_.Retrieve(result.bytes_parsed);
+    
+    if (!result.success) {
+        RejectBadRequest(result.error_message, result.payload_too_large
+                                                   ? HttpResponse::HttpStatusCode::PAYLOAD_TOO_LARGE
+                                                   : HttpResponse::HttpStatusCode::BAD_REQUEST);
+        return false;
+    }
+    if (result.paused) {
+        PauseReading();
+    }
+    if (result.state != ParseState::COMPLETE) {
         return false;
     }
     
-    auto request = http_parser_.Parse(read_buffer_.c_str(),read_buffer_.length());
+    ++io_stats_.requests;
+    current_request_ = http_parser_.GetRequest();
+    http_parser_.Reset(); // 为同一连接上的下一个请求做准备
     
-    if (request.success) {
+    if (read_callback_) {
+        read_callback_();
+    }
     
-        read_buffer_.clear(); // 清空已处理数据
-        
-        if (read_callback_) {
-            read_callback_();
+    return true;
+}
+
+
+bool Connection::TryParseRequestView() {
+    ReleaseRequestView();
+    if (read_buffer_.ReadableBytes() == 0 || close_after_write_ || reading_paused_) {
+        return false;
+    }
+
+    // 拷贝解析进行到一半（分块正文回退后）时继续用拷贝解析
+    if (http_parser_.GetCurrentState() == ParseState::START_LINE) {
+        ParseResult result = http_parser_.ParseView(read_buffer_.Peek(), read_buffer_.ReadableBytes(),
+                                                    request_view_);
+        if (!result.success) {
+            http_parser_.Reset();
+            RejectBadRequest(result.error_message, result.payload_too_large
+                                                       ? HttpResponse::HttpStatusCode::PAYLOAD_TOO_LARGE
+                                                       : HttpResponse::HttpStatusCode::BAD_REQUEST);
+            return false;
+        }
+        if (result.state == ParseState::COMPLETE) {
+            ++io_stats_.requests;
+            pinned_bytes_ = result.bytes_parsed;
+            if (read_callback_) {
+                read_callback_();
+            }
+            return true;
+        }
+        if (!result.fallback) {
+            return false;   // 需要更多数据
         }
-        
-        return true;
     }
-    
-    return false; 
+
+    if (!TryParseHttpRequest()) {
+        return false;
+    }
+    view_backing_ = std::move(current_request_);
+    request_view_.Assign(*view_backing_);
+    return true;
+}
+
+void Connection::ReleaseRequestView() {
+    if (pinned_bytes_ > 0) {
+        read_buffer_.Retrieve(pinned_bytes_);
+        pinned_bytes_ = 0;
+    }
+    request_view_.Clear();
+    view_backing_.reset();
 }
 
+void Connection::RejectBadRequest(const std::string& reason, HttpResponse::HttpStatusCode status) {
+    NotifyError("Bad request: " + reason);
+    // 回复400（正文过大为413，头部过大为431）后关闭；之前流水线请求的响应已在队列中，顺序不变
+    RequestArena::Lease lease(request_arena_);
+    HttpResponse response(request_arena_.Resource());
+    response.SetStatusCode(status);
+    response.SetHeader("Content-Type", "text/plain; charset=utf-8");
+    response.SetBody(std::string(HttpResponse::GetReasonPhrase(status)) + "\n");
+    response.SetKeepAlive(false);
+    read_buffer_.RetrieveAll();
+    WriteData(response.Serialize());
+    CloseAfterWrite();
+}
 
 // 其余getter和setter方法实现
 Connection::State Connection::GetState() const { return state_; }
 int Connection::GetFd() const { return socket_fd_; }
 time_t Connection::GetLastActivityTime() const { return last_activity_time_; }
-void Connection::UpdateActivityTime() { last_activity_time_ = time(nullptr); }
-size_t Connection::GetReadBufferSize() const { std::lock_guard<std::mutex> lock(buffer_mutex_); return read_buffer_.size(); }
-size_t Connection::GetWriteBufferSize() const { std::lock_guard<std::mutex> lock(buffer_mutex_); return write_buffer_.size(); }
+bool Connection::IsPeerClosed() const { return peer_closed_; }
+HttpRequestPtr Connection::TakeRequest() { return std::move(current_request_); }
+void Connection::CloseAfterWrite() { close_after_write_ = true; }
+const HttpRequestView& Connection::GetRequestView() const { return request_view_; }
+HttpRequestPtr Connection::TakeRequestViewBacking() { return std::move(view_backing_); }
+RequestArena& Connection::GetRequestArena() { return request_arena_; }
+void Connection::PauseReading() { reading_paused_ = true; }
+bool Connection::IsReadingPaused() const { return reading_paused_; }
+bool Connection::HasPendingRead() const { return read_pending_; }
+
+void Connection::ResumeReading() {
+    if (!event_loop_.IsInLoopThread()) {
+        event_loop_.QueueInLoop([self = shared_from_this()]() {
+            self->ResumeReading();
+        });
+        return;
+    }
+    if (!reading_paused_ || state_ == State::DISCONNECTED || state_ == State::CLOSING) {
+        return;
+    }
+    reading_paused_ = false;
+    UpdateActivityTime();
+    // 暂停期间没有读到EAGAIN，不会再有可读事件，由Handler主动处理并继续读取
+    if (handler_) {
+        in_read_handler_ = true;
+        handler_->HandleResume(shared_from_this());
+        in_read_handler_ = false;
+        FlushAfterRead();
+    }
+}
+Connection::IoStatistics Connection::GetIoStatistics() const {
+    IoStatistics stats = io_stats_;
+    stats.bytes_copied = read_buffer_.BytesCopied() + extra_bytes_copied_;
+    return stats;
+}
+void Connection::UpdateActivityTime() {
+    last_activity_time_ = time(nullptr);
+    if (idle_timer_id_ != 0) {
+        // 没有未完成的请求、也没有待发送的响应：处于两个请求之间，按keep-alive超时计算
+        bool between_requests = read_buffer_.ReadableBytes() == 0 && output_queue_.Empty() &&
+                                http_parser_.GetCurrentState() == ParseState::START_LINE;
+        int seconds = (between_requests && keep_alive_timeout_seconds_ > 0)
+                          ? keep_alive_timeout_seconds_ : timeout_seconds_;
+        event_loop_.TouchTimer(idle_timer_id_, static_cast<uint64_t>(seconds) * 1000);
+    }
+}
+
+void Connection::HandleIdleTimeout() {
+    idle_timer_id_ = 0;   // 一次性定时器已到期，节点随回调结束释放
+    // 空闲超时是常态（大量keep-alive连接逐个到期），不逐个输出日志
+    Close();
+}
+size_t Connection::GetReadBufferSize() const { return read_buffer_.ReadableBytes(); }
+size_t Connection::GetWriteBufferSize() const { return output_queue_.Size(); }
 void Connection::SetReadCallback(std::function<void()> callback) { read_callback_ = std::move(callback); }
 void Connection::SetWriteCallback(std::function<void()> callback) { write_callback_ = std::move(callback); }
 void Connection::SetCloseCallback(std::function<void()> callback) { close_callback_ = std::move(callback); }
 void Connection::SetErrorCallback(std::function<void(const std::string&)> callback) { error_callback_ = std::move(callback); }
 void Connection::SetTimeout(int seconds) { timeout_seconds_ = seconds; }
+void Connection::SetKeepAliveTimeout(int seconds) { keep_alive_timeout_seconds_ = seconds; }
 void Connection::SetMaxBufferSize(size_t size) { max_buffer_size_ = size; }
+void Connection::SetBodyLimits(size_t memory_limit, size_t max_body_size) {
+    http_parser_.SetBodyLimits(memory_limit, max_body_size);
+}
+void Connection::SetBodyHandler(BodyHandler handler) {
+    if (!handler) {
+        http_parser_.SetBodyStreamFactory(nullptr);
+        return;
+    }
+    // 解析器是连接的成员，回调中的this在解析期间必然有效
+    http_parser_.SetBodyStreamFactory([this, handler = std::move(handler)](const HttpRequest& request) {
+        return handler(*this, request);
+    });
+}
 
 
 
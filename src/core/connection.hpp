@@ -17,6 +17,9 @@
 #include "http_request.hpp"
 #include "http_response.hpp"
 #include "http_parser.hpp"
+#include "http_request_view.hpp"
+#include "buffer.hpp"
+#include "output_queue.hpp"
 #include "handler.hpp"
 #include "connection.hpp"
 #include "connection_manager.hpp"
@@ -39,7 +42,21 @@ public:
         CLOSING         // 连接关闭中
     };
 
-    Connection(int socket_fd, WebServer& server);
+    // 读写路径统计（只在loop线程内更新）
+    struct IoStatistics {
+        uint64_t bytes_read = 0;      // 从socket读入的字节数
+        uint64_t read_calls = 0;      // readv调用次数（含读到EAGAIN的最后一次）
+        uint64_t bytes_copied = 0;    // 读路径上的用户态拷贝字节数（缓冲区挪动/扩容/临时区溢出/GetReadBuffer）
+        uint64_t requests = 0;        // 解析完成的请求数
+        uint64_t bytes_written = 0;   // 写入socket的字节数
+        uint64_t write_calls = 0;     // sendmsg/sendfile调用次数
+    };
+
+    // 请求头部到达、正文开始前调用：返回非空回调时正文分段交给该回调（回调返回false则暂停读取，
+    // 由消费方稍后调用ResumeReading），返回空回调时正文保存到请求对象，超出内存上限的部分溢出到临时文件
+    using BodyHandler = std::function<BodyChunkCallback(Connection& conn, const HttpRequest& request)>;
+
+    Connection(int socket_fd, WebServer& server, EventLoop& loop);
 
     ~Connection();
     Connection(const Connection&) = delete;
@@ -50,17 +67,49 @@ public:
 
     void Start();
     void Close();
+    // 把已关闭的对象重新绑定到新的socket（对象池复用），失败时抛出异常且不接管fd
+    void Reset(int socket_fd);
 
 
     // 设置处理器
     void SetHandler(std::shared_ptr<Handler> handler) ;
 
     // 数据读写操作
+    // 读到EAGAIN为止（边缘触发下不会遗留数据），返回本次读入的总字节数；
+    // 对端关闭且没有新数据时关闭连接并返回0，无数据可读或出错返回-1
     ssize_t ReadData();
+    // 写入接口：数据进入输出队列，返回入队字节数（溢出返回-1）。
+    // loop线程内会立即尝试发送，剩余部分在可写事件中继续；其它线程调用时转交loop线程
     ssize_t WriteData(const std::string& data);
+    ssize_t WriteData(std::string&& data);
+    ssize_t WriteData(std::shared_ptr<const std::string> data);   // 共享只读缓冲，不拷贝
+    ssize_t WriteFile(std::shared_ptr<const FileHandle> file, off_t offset, size_t length); // sendfile发送
+    // 在读缓冲区上原地解析，得到一个完整请求返回true；请求格式错误时关闭连接
     bool TryParseHttpRequest();
-
-    // 获取数据接口
+    // 取出最近一次TryParseHttpRequest解析完成的请求（内存在连接的RequestArena中，须在loop线程内释放）
+    HttpRequestPtr TakeRequest();
+    // 零拷贝解析：得到一个完整请求返回true，GetRequestView引用读缓冲区中的原始数据。
+    // 这段缓冲区固定到下一次TryParseRequestView/ReadData才消费，Handler在此之前处理完请求即可；
+    // 分块正文等无法原地引用的请求自动回退为拷贝解析，对调用方透明
+    bool TryParseRequestView();
+    const HttpRequestView& GetRequestView() const;
+    // 取走视图回退到拷贝解析时引用的请求对象（原地引用读缓冲区的视图返回空）；
+    // 视图在该对象释放前仍然有效，对象的内存在连接的RequestArena中，须在loop线程内释放
+    HttpRequestPtr TakeRequestViewBacking();
+    // 非keep-alive请求：不再解析后续（流水线）请求，已入队的响应发完后关闭
+    void CloseAfterWrite();
+    // 在途请求的内存区：输出队列发空且请求对象都已释放时整体归还
+    RequestArena& GetRequestArena();
+
+    // 正文流控：暂停期间不读socket（内核接收窗口填满后对端自然停止发送），已读入的数据保留在读缓冲区。
+    // ResumeReading可在任意线程调用，在loop线程内先处理缓冲区中的数据，再继续读socket
+    void PauseReading();
+    void ResumeReading();
+    bool IsReadingPaused() const;
+    // 上一次ReadData因读缓冲区满而提前停止，socket中可能还有数据
+    bool HasPendingRead() const;
+
+    // 获取数据接口（GetReadBuffer会拷贝数据，计入bytes_copied）
     std::string GetReadBuffer() const;
     void ClearReadBuffer();
 
@@ -69,6 +118,8 @@ public:
     int GetFd() const;
     std::string GetRemoteAddress() const;
     time_t GetLastActivityTime() const;
+    bool IsPeerClosed() const;// 对端已半关闭（读到EOF），处理完已读数据后应关闭
+    IoStatistics GetIoStatistics() const;
     size_t GetReadBufferSize() const;
     size_t GetWriteBufferSize() const;
 
@@ -85,7 +136,10 @@ public:
 
     // 配置接口
     void SetTimeout(int seconds);
+    void SetKeepAliveTimeout(int seconds);  // 两个请求之间的空闲超时，0表示沿用SetTimeout
     void SetMaxBufferSize(size_t size);
+    void SetBodyLimits(size_t memory_limit, size_t max_body_size);
+    void SetBodyHandler(BodyHandler handler);
 
         // 默认事件处理方法
     void DefaultHandleRead();
@@ -98,7 +152,15 @@ private:
     // 内部辅助方法
     void SetupSocketOptions();
     void UpdateActivityTime();
+    template <typename Enqueue>
+    ssize_t EnqueueOutput(size_t length, Enqueue&& enqueue);
+    void FlushOutput();// 发送输出队列，按剩余情况开关EPOLLOUT
+    void FlushAfterRead();// 读回调结束：一次写出回调中入队的响应
+    void HandleIdleTimeout();
     void CleanupResources();
+    void ReleaseRequestView();// 消费上一个视图请求占用的读缓冲区
+    void RejectBadRequest(const std::string& reason,
+                          HttpResponse::HttpStatusCode status = HttpResponse::HttpStatusCode::BAD_REQUEST);
     void NotifyError(const std::string& error_msg);
 
 
@@ -109,16 +171,29 @@ private:
     int socket_fd_;                         // 套接字文件描述符
     State state_;                           // 当前连接状态
     WebServer& server_;                     // 所属服务器引用
-    EventLoop& event_loop_;                 // 事件循环引用
+    EventLoop& event_loop_;                 // 所属事件循环（连接只在该loop线程内读写）
 
     std::shared_ptr<Handler> handler_;     // 连接处理器
     
-    // HTTP解析器
+    // HTTP解析器（request_arena_须先于使用它的成员声明，最后析构）
+    RequestArena request_arena_;            // 在途请求与出错响应的单调内存区
     HttpParser http_parser_;                // HTTP解析器实例
+    HttpRequestPtr current_request_;        // 已解析完成、等待Handler处理的请求
+    HttpRequestView request_view_;          // 零拷贝模式下当前请求的视图
+    HttpRequestPtr view_backing_;           // 回退到拷贝解析时视图引用的请求
+    size_t pinned_bytes_;                   // 视图引用、尚未消费的读缓冲区字节数
 
     // 数据缓冲区
-    std::string read_buffer_;               // 读数据缓冲区
-    std::string write_buffer_;              // 写数据缓冲区
+    Buffer read_buffer_;                    // 读数据缓冲区（只在loop线程内访问，无需加锁）
+    OutputQueue output_queue_;              // 写数据队列（只在loop线程内访问，无需加锁）
+    bool write_armed_;                      // 是否已关注EPOLLOUT
+    bool in_read_handler_;                  // 处于读回调中：响应先入队，回调结束后统一发送
+    bool peer_closed_;                      // 读到EOF
+    bool close_after_write_;                // 输出队列发完后关闭
+    bool reading_paused_;                   // 正文消费方跟不上，暂停读socket
+    bool read_pending_;                     // 读缓冲区满时提前停止了读取
+    IoStatistics io_stats_;
+    mutable uint64_t extra_bytes_copied_;   // GetReadBuffer产生的拷贝
     
     // 回调函数
     std::function<void()> read_callback_;
@@ -134,9 +209,8 @@ private:
     // 配置参数
     size_t max_buffer_size_;               // 缓冲区最大大小
     int timeout_seconds_;                  // 超时时间（秒）
-    
-    // 线程安全
-    mutable std::mutex buffer_mutex_;      // 缓冲区访问互斥锁
+    int keep_alive_timeout_seconds_;       // 请求之间的空闲超时（秒）
+    uint64_t idle_timer_id_;               // 空闲超时定时器（有读写活动时touch续期）
 
  
 };
@@ -2,37 +2,57 @@
 #include "connection.hpp"
 #include <algorithm>
 #include <ctime>
+#include <vector>
 
 namespace ppserver {
 
 ConnectionManager::ConnectionManager() = default;
 
+ConnectionManager::ConnectionManager(const Config& config)
+    : config_(config) {
+}
+
 bool ConnectionManager::AddConnection(int fd, std::shared_ptr<Connection> conn) {
-    if (!conn) {
+    if (!conn || fd < 0) {
         return false;
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
     
     // 检查是否超过最大连接数限制
-    if (connections_.size() >= config_.max_connections) {
+    if (active_count_ >= config_.max_connections) {
         return false;
     }
 
-    connections_[fd] = conn;
+    size_t index = static_cast<size_t>(fd);
+    if (index >= connections_.size()) {
+        connections_.resize(std::max(index + 1, connections_.size() * 2));
+    }
+    if (!connections_[index]) {
+        ++active_count_;
+    }
+    connections_[index] = std::move(conn);
     return true;
 }
 
 void ConnectionManager::RemoveConnection(int fd) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    connections_.erase(fd);
+    std::shared_ptr<Connection> removed;  // 在锁外释放，析构可能回调到其它模块
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t index = static_cast<size_t>(fd);
+        if (fd < 0 || index >= connections_.size() || !connections_[index]) {
+            return;
+        }
+        removed.swap(connections_[index]);
+        --active_count_;
+    }
 }
 
 std::shared_ptr<Connection> ConnectionManager::GetConnection(int fd) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = connections_.find(fd);
-    if (it != connections_.end()) {
-        return it->second;
+    size_t index = static_cast<size_t>(fd);
+    if (fd >= 0 && index < connections_.size()) {
+        return connections_[index];
     }
     return nullptr;
 }
@@ -40,36 +60,45 @@ std::shared_ptr<Connection> ConnectionManager::GetConnection(int fd) {
 ConnectionManager::Statistics ConnectionManager::GetStatistics() {
     std::lock_guard<std::mutex> lock(mutex_);
     Statistics stats;
-    stats.active_connections = connections_.size();
-    stats.total_connections = connections_.size(); // 在实际实现中可能需要跟踪总连接数
+    stats.active_connections = active_count_;
+    stats.total_connections = active_count_; // 在实际实现中可能需要跟踪总连接数
     return stats;
 }
 
 void ConnectionManager::CleanupTimeoutConnections() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    time_t current_time = time(nullptr);
-    
-    for (auto it = connections_.begin(); it != connections_.end();) {
-        auto conn = it->second;
-        if (conn && (current_time - conn->GetLastActivityTime()) > config_.timeout_seconds) {
-            conn->Close();
-            it = connections_.erase(it);
-        } else {
-            ++it;
+    std::vector<std::shared_ptr<Connection>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        time_t current_time = time(nullptr);
+
+        for (auto& slot : connections_) {
+            if (slot && (current_time - slot->GetLastActivityTime()) > config_.timeout_seconds) {
+                expired.push_back(std::move(slot));
+                slot.reset();
+                --active_count_;
+            }
         }
     }
+
+    // Close()会回调RemoveConnection，必须在锁外执行
+    for (auto& conn : expired) {
+        conn->Close();
+    }
 }
 
 void ConnectionManager::CloseAllConnections() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    for (auto& pair : connections_) {
-        if (pair.second) {
-            pair.second->Close();
+    std::vector<std::shared_ptr<Connection>> connections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections.swap(connections_);
+        active_count_ = 0;
+    }
+
+    for (auto& conn : connections) {
+        if (conn) {
+            conn->Close();
         }
     }
-    
-    connections_.clear();
 }
 
 bool ConnectionManager::IsPortAvailable(const std::string& host, uint16_t port) {
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <unordered_map>
+#include <vector>
 #include <memory>
 #include <mutex>
 #include <cstdint>
@@ -23,6 +23,7 @@ public:
     };
 
     ConnectionManager();
+    explicit ConnectionManager(const Config& config);
     ~ConnectionManager() = default;
 
     // 禁止拷贝和移动
@@ -55,7 +56,9 @@ public:
 
 private:
     Config config_;
-    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+    // 按fd下标索引（fd由内核从小到大复用，表长随最大并发fd增长），接入连接时无需分配节点
+    std::vector<std::shared_ptr<Connection>> connections_;
+    size_t active_count_ = 0;
     mutable std::mutex mutex_;  // 保护连接映射的互斥锁
 };
 
@@ -0,0 +1,108 @@
+#include "connection_slab.hpp"
+#include "connection.hpp"
+
+namespace ppserver {
+
+ConnectionSlab::State::~State() {
+    for (void* block : free_blocks) {
+        ::operator delete(block);
+    }
+}
+
+void ConnectionSlab::State::Release(Connection* conn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 未正常关闭的对象（如启动途中失败）不回收，由析构函数收尾
+        if (!closed && idle.size() < max_idle &&
+            conn->GetState() == Connection::State::DISCONNECTED) {
+            idle.push_back(conn);
+            return;
+        }
+    }
+    delete conn;
+}
+
+void* ConnectionSlab::State::AllocateBlock(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (block_size == 0) {
+            block_size = size;
+        }
+        if (size == block_size && !free_blocks.empty()) {
+            void* block = free_blocks.back();
+            free_blocks.pop_back();
+            return block;
+        }
+    }
+    return ::operator new(size);
+}
+
+void ConnectionSlab::State::FreeBlock(void* block, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 控制块数不会超过对象数，空闲块随对象一起受max_idle约束
+        if (!closed && size == block_size && free_blocks.size() < max_idle) {
+            free_blocks.push_back(block);
+            return;
+        }
+    }
+    ::operator delete(block);
+}
+
+ConnectionSlab::ConnectionSlab(size_t max_idle, Factory factory)
+    : state_(std::make_shared<State>(max_idle)),
+      factory_(std::move(factory)) {
+}
+
+ConnectionSlab::~ConnectionSlab() {
+    std::vector<Connection*> idle;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->closed = true;
+        idle.swap(state_->idle);
+    }
+    // 空闲对象已关闭，不再持有fd和定时器，可以直接释放
+    for (Connection* conn : idle) {
+        delete conn;
+    }
+}
+
+std::shared_ptr<Connection> ConnectionSlab::Acquire(int fd) {
+    Connection* conn = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->idle.empty()) {
+            conn = state_->idle.back();
+            state_->idle.pop_back();
+        }
+    }
+
+    if (conn) {
+        try {
+            conn->Reset(fd);
+        } catch (...) {
+            state_->Release(conn);
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        ++state_->reused;
+    } else {
+        conn = factory_(fd);
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        ++state_->created;
+    }
+
+    // 对象上一轮的weak_this已过期，新的shared_ptr会重新绑定enable_shared_from_this
+    return std::shared_ptr<Connection>(conn, Recycler{state_}, BlockAllocator<Connection>(state_));
+}
+
+ConnectionSlab::Statistics ConnectionSlab::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    Statistics stats;
+    stats.created = state_->created;
+    stats.reused = state_->reused;
+    stats.idle = state_->idle.size();
+    return stats;
+}
+
+} // namespace ppserver
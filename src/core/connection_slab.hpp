@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ppserver {
+
+class Connection;
+
+/**
+ * ConnectionSlab - 连接对象池
+ * 负责：为一个EventLoop回收并复用Connection对象（连同其Handler、读缓冲区、
+ *      输出队列、解析器），accept时只重新绑定fd，不再new/delete整个对象
+ * 设计特点：Acquire返回的shared_ptr带自定义删除器，最后一个引用释放时对象回到空闲链表；
+ *          shared_ptr的控制块也由池内的定长块分配，复用时不触碰全局堆；
+ *          池销毁后仍在外部的引用释放时直接delete，池状态由引用计数保活
+ * 线程安全：Acquire只在所属loop线程调用；释放可能发生在任意线程（跨线程任务持有引用），内部加锁
+ */
+class ConnectionSlab {
+public:
+    // 新建一个绑定到fd的连接对象（池为空时调用），构造失败时抛出异常
+    using Factory = std::function<Connection*(int fd)>;
+
+    struct Statistics {
+        uint64_t created = 0;   // 新建的对象数
+        uint64_t reused = 0;    // 从空闲链表复用的次数
+        size_t idle = 0;        // 当前空闲对象数
+    };
+
+    ConnectionSlab(size_t max_idle, Factory factory);
+    ~ConnectionSlab();
+
+    ConnectionSlab(const ConnectionSlab&) = delete;
+    ConnectionSlab& operator=(const ConnectionSlab&) = delete;
+
+    // 取一个绑定到fd的连接：优先复用空闲对象（Connection::Reset），否则调用factory新建。
+    // 失败时抛出异常，fd由调用方关闭
+    std::shared_ptr<Connection> Acquire(int fd);
+
+    Statistics GetStatistics() const;
+
+private:
+    struct State {
+        explicit State(size_t max_idle) : max_idle(max_idle) {}
+        ~State();
+
+        void Release(Connection* conn);
+        void* AllocateBlock(size_t size);
+        void FreeBlock(void* block, size_t size);
+
+        mutable std::mutex mutex;
+        std::vector<Connection*> idle;      // 已关闭、可复用的连接对象
+        std::vector<void*> free_blocks;     // 回收的控制块内存
+        size_t block_size = 0;              // 控制块大小（首次分配时确定）
+        size_t max_idle;
+        bool closed = false;                // 池已销毁，释放的对象不再回收
+        uint64_t created = 0;
+        uint64_t reused = 0;
+    };
+
+    // 控制块分配器：shared_ptr按其内部控制块类型rebind后分配
+    template <typename T>
+    struct BlockAllocator {
+        using value_type = T;
+
+        explicit BlockAllocator(std::shared_ptr<State> state) : state(std::move(state)) {}
+        template <typename U>
+        BlockAllocator(const BlockAllocator<U>& other) : state(other.state) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(state->AllocateBlock(n * sizeof(T))); }
+        void deallocate(T* p, size_t n) { state->FreeBlock(p, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const BlockAllocator<U>& other) const { return state == other.state; }
+        template <typename U>
+        bool operator!=(const BlockAllocator<U>& other) const { return state != other.state; }
+
+        std::shared_ptr<State> state;
+    };
+
+    // 删除器：对象回到空闲链表而不是delete
+    struct Recycler {
+        void operator()(Connection* conn) const { state->Release(conn); }
+        std::shared_ptr<State> state;
+    };
+
+    std::shared_ptr<State> state_;
+    Factory factory_;
+};
+
+} // namespace ppserver
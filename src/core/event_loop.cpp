@@ -1,4 +1,5 @@
 #include "event_loop.hpp"
+#include "io_uring_poller.hpp"
 #include <system_error>
 #include <fcntl.h>
 #include <cstring>
@@ -12,23 +13,40 @@
 
 namespace ppserver {
 
-EventLoop::EventLoop() 
+EventLoop::EventLoop(Backend backend) 
     : epoll_fd_(-1),
       event_fd_(-1),
       running_(false),
-      next_timer_id_(1) {
-    
+      owner_thread_id_(std::this_thread::get_id()),
+      registered_fd_count_(0),
+      timer_wheel_(GetCurrentTimeMs()),
+      pending_task_count_(0),
+      polling_(false),
+      wakeup_pending_(false),
+      wakeup_writes_(0),
+      loop_iterations_(0) {
+    
+    if (backend == Backend::IO_URING) {
+        try {
+            uring_ = std::make_unique<IoUringPoller>();
+        } catch (const std::exception& e) {
+            std::cerr << "io_uring unavailable, falling back to epoll: " << e.what() << std::endl;
+        }
+    }
+
     // 创建epoll实例
-    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);//EPOLL_CLOEXEC确保子进程不会继承该文件描述符
-    if (epoll_fd_ < 0) {
-        throw std::runtime_error("Failed to create epoll instance: " + 
-                               std::string(strerror(errno)));
+    if (!uring_) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);//EPOLL_CLOEXEC确保子进程不会继承该文件描述符
+        if (epoll_fd_ < 0) {
+            throw std::runtime_error("Failed to create epoll instance: " + 
+                                   std::string(strerror(errno)));
+        }
     }
     
     // 创建eventfd用于任务通知
     event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
     if (event_fd_ < 0) {
-        close(epoll_fd_);
+        if (epoll_fd_ >= 0) close(epoll_fd_);
         throw std::runtime_error("Failed to create eventfd: " + 
                                std::string(strerror(errno)));
     }
@@ -36,9 +54,9 @@ EventLoop::EventLoop()
     // 注册eventfd到epoll监控
     epoll_event event{};//
     event.events = EPOLL_READ;
-    event.data.fd = event_fd_;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event) < 0) {
-        close(epoll_fd_);
+    event.data.u64 = static_cast<uint32_t>(event_fd_);
+    if (ControlFd(EPOLL_CTL_ADD, event_fd_, &event) < 0) {
+        if (epoll_fd_ >= 0) close(epoll_fd_);
         close(event_fd_);
         throw std::runtime_error("Failed to add eventfd to epoll: " + 
                                std::string(strerror(errno)));
@@ -47,6 +65,11 @@ EventLoop::EventLoop()
 
 EventLoop::~EventLoop() {
     Stop();
+    // 释放未执行的任务节点
+    while (TaskNode* node = task_queue_.Pop()) {
+        delete node;
+    }
+    uring_.reset();
     if (epoll_fd_ >= 0) close(epoll_fd_);
     if (event_fd_ >= 0) close(event_fd_);
 }
@@ -64,26 +87,37 @@ int EventLoop::Run() {
     
     // 主事件循环
     while (running_) {
+        // 先声明即将阻塞，再检查定时器和任务计数：与QueueInLoop/RunAfter中"先入队再检查polling_"配对，
+        // 保证要么这里看到新任务/定时器不阻塞，要么对方看到polling_并写eventfd
+        polling_.store(true);
+
         // 计算最近定时器到期时间
         int timeout = CalculateNextTimeout();
+        if (pending_task_count_.load() > 0 || !running_.load()) {
+            timeout = 0;
+        }
         
         // 等待事件或超时
-        int num_events = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
+        int num_events = WaitEvents(events, MAX_EVENTS, timeout);
+        polling_.store(false, std::memory_order_relaxed);
+        loop_iterations_.fetch_add(1, std::memory_order_relaxed);
 
         if (num_events < 0 && errno != EINTR) {
             // 非中断性错误，记录并继续
-            std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+            std::cerr << (uring_ ? "io_uring wait error: " : "epoll_wait error: ")
+                      << strerror(errno) << std::endl;
             continue;
         }
         
         // 处理I/O事件
         for (int i = 0; i < num_events; ++i) {
-            if (events[i].data.fd == event_fd_) {//如果fd==event_fd_,说明是任务通知事件
+            if (events[i].data.u64 == static_cast<uint32_t>(event_fd_)) {//说明是任务通知事件
                 HandleTaskNotification(); // 内部任务通知
             } else {
                 HandleIoEvent(events[i]); // 外部I/O事件
             }
         }
+        retired_callbacks_.clear();
         
         // 处理到期定时器
         ProcessExpiredTimers();
@@ -91,6 +125,9 @@ int EventLoop::Run() {
         // 执行待处理任务
         ProcessPendingTasks();
     }
+
+    // 退出前执行Stop()之前投递的收尾任务（如关闭监听fd、关闭连接）
+    ProcessPendingTasks();
     
     return 0;
 }
@@ -104,137 +141,139 @@ bool EventLoop::IsInLoopThread() const {
     return owner_thread_id_ == std::this_thread::get_id();
 }
 
+EventLoop::Backend EventLoop::GetBackend() const {
+    return uring_ ? Backend::IO_URING : Backend::EPOLL;
+}
+
 void EventLoop::AddFd(int fd, uint32_t events, EventCallback callback) {
-    
-    std::lock_guard<std::recursive_mutex> lock(fd_mutex_);//保护共享资源 fd_callbacks_（文件描述符回调映射）的线程安全访问
+    if (!IsInLoopThread()) {
+        // 跨线程注册经任务队列转交，分发表始终只被loop线程读写
+        QueueInLoop([this, fd, events, callback = std::move(callback)]() mutable {
+            AddFdInLoop(fd, events, std::move(callback));
+        });
+        return;
+    }
+    AddFdInLoop(fd, events, std::move(callback));
+}
+
+void EventLoop::AddFdInLoop(int fd, uint32_t events, EventCallback callback) {
+    if (fd < 0) {
+        throw std::invalid_argument("Invalid fd for epoll");
+    }
+    if (static_cast<size_t>(fd) >= channels_.size()) {
+        channels_.resize(std::max<size_t>(static_cast<size_t>(fd) + 1, channels_.size() * 2));
+    }
+    Channel& channel = channels_[fd];
     
     // 设置边缘触发模式
     events |= EPOLL_ET;//uint32_t类型的位掩码（bitmask），用于指定要监控的事件类型
     
     epoll_event event{};
     event.events = events;
-    event.data.fd = fd;
+    event.data.u64 = (static_cast<uint64_t>(channel.generation + 1) << 32) | static_cast<uint32_t>(fd);
     
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    if (ControlFd(EPOLL_CTL_ADD, fd, &event) < 0) {
         throw std::runtime_error("Failed to add fd to epoll: " + 
                                std::string(strerror(errno)));
     }
     
-    fd_callbacks_[fd] = std::move(callback);
-
-
+    ++channel.generation;
+    if (!channel.callback) {
+        registered_fd_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    channel.callback = std::move(callback);
 }
-//==================================重入锁问题 使用递归锁==================================
-// void EventLoop::AddFd(int fd, uint32_t events, EventCallback callback) {
-//     std::cout << "🔄 进入 AddFd，线程ID: " << std::this_thread::get_id() 
-//               << ", 文件描述符: " << fd << std::endl;
-    
-//     auto start_time = std::chrono::steady_clock::now();
-    
-    
-//     {
-//         std::cout << "🔒 尝试获取 fd_mutex_..." << std::endl;
-//         std::lock_guard<std::recursive_mutex> lock(fd_mutex_);
-//         std::cout << "✅ 成功获取 fd_mutex_" << std::endl;
-        
-//         // 设置边缘触发模式
-//         events |= EPOLL_ET;
-        
-//         epoll_event event{};
-//         event.events = events;
-//         event.data.fd = fd;
-        
-//         std::cout << "🔧 准备调用 epoll_ctl，epoll_fd: " << epoll_fd_ 
-//                   << ", 目标fd: " << fd << std::endl;
-        
-//         if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
-//             std::string error_msg = "Failed to add fd to epoll: " + std::string(strerror(errno));
-//             std::cerr << "❌ " << error_msg << std::endl;
-//             throw std::runtime_error(error_msg);
-//         }
-        
-//         std::cout << "✅ epoll_ctl 调用成功" << std::endl;
-        
-//         fd_callbacks_[fd] = std::move(callback);
-//         std::cout << "✅ 回调函数注册成功" << std::endl;
-   
-//     }
-    
-//     auto end_time = std::chrono::steady_clock::now();
-//     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-//     std::cout << "⏱️  AddFd 完成，耗时: " << duration.count() << "ms" << std::endl;
-// }
 
 void EventLoop::UpdateFd(int fd, uint32_t events) {
+    if (!IsInLoopThread()) {
+        QueueInLoop([this, fd, events]() { UpdateFdInLoop(fd, events); });
+        return;
+    }
+    UpdateFdInLoop(fd, events);
+}
+
+void EventLoop::UpdateFdInLoop(int fd, uint32_t events) {
+    if (fd < 0 || static_cast<size_t>(fd) >= channels_.size()) {
+        throw std::runtime_error("Failed to update fd in epoll: fd not registered");
+    }
+
     epoll_event event{};
     event.events = events | EPOLL_ET; // 保持边缘触发
-    event.data.fd = fd;
+    event.data.u64 = (static_cast<uint64_t>(channels_[fd].generation) << 32) | static_cast<uint32_t>(fd);
     
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+    if (ControlFd(EPOLL_CTL_MOD, fd, &event) < 0) {
         throw std::runtime_error("Failed to update fd in epoll: " + 
                                std::string(strerror(errno)));
     }
 }
 
 void EventLoop::RemoveFd(int fd) {
-    std::lock_guard<std::recursive_mutex> lock(fd_mutex_);
-    
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) < 0) {
+    if (!IsInLoopThread()) {
+        QueueInLoop([this, fd]() { RemoveFdInLoop(fd); });
+        return;
+    }
+    RemoveFdInLoop(fd);
+}
+
+void EventLoop::RemoveFdInLoop(int fd) {
+    if (ControlFd(EPOLL_CTL_DEL, fd, nullptr) < 0) {
         // 记录警告但继续执行（可能fd已关闭）
         std::cerr << "Warning: Failed to remove fd from epoll: " 
                   << strerror(errno) << std::endl;
     }
     
-    fd_callbacks_.erase(fd);
+    if (fd >= 0 && static_cast<size_t>(fd) < channels_.size() && channels_[fd].callback) {
+        // 可能正处于该fd自己的回调中，延迟销毁闭包
+        retired_callbacks_.push_back(std::move(channels_[fd].callback));
+        channels_[fd].callback = nullptr;
+        registered_fd_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
 }
 
 
 EventLoop::TimerId EventLoop::RunAfter(uint64_t delay_ms, Task callback) {//返回类型为 TimerId，即定时器的唯一标识符
-    //传入delay_ms参数
-    std::lock_guard<std::mutex> lock(timer_mutex_);
-   
-
-        Timer timer;
-    timer.id = next_timer_id_++;
-    timer.expiration = GetCurrentTimeMs() + delay_ms;//计算过期时间
-    timer.interval = 0;//间隔时间是0，表示一次性定时器
-    timer.callback = std::move(callback);
-    timer.repeated = false;//间隔时间是0，表示一次性定时器 那就不会重复执行
-    
-    timers_.push_back(timer);
-    std::push_heap(timers_.begin(), timers_.end(), Timer::Compare());
+    TimerId timer_id;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        //间隔时间是0，表示一次性定时器 那就不会重复执行
+        timer_id = timer_wheel_.Add(GetCurrentTimeMs() + delay_ms, 0, std::move(callback));
+    }
     
-    WakeUp(); // 唤醒事件循环重新计算超时
-    return timer.id;
+    if (!IsInLoopThread()) {
+        WakeUp(); // 唤醒事件循环重新计算超时（loop线程内会在下次等待前重新计算）
+    }
+    return timer_id;
 }
 
 EventLoop::TimerId EventLoop::RunEvery(uint64_t interval_ms, Task callback) {//可以用来执行心跳检测任务
-    std::lock_guard<std::mutex> lock(timer_mutex_);
-    
-    Timer timer;
-    timer.id = next_timer_id_++;//生成唯一定时器ID
-    timer.expiration = GetCurrentTimeMs() + interval_ms;//过期时间
-    timer.interval = interval_ms;//间隔时间
-    timer.callback = std::move(callback);//回调函数
-    timer.repeated = true;//是否重复执行标志
-    
-    timers_.push_back(timer);
-    std::push_heap(timers_.begin(), timers_.end(), Timer::Compare());
+    interval_ms = std::max<uint64_t>(interval_ms, 1); // 间隔为0会在同一轮里无限重复
+    TimerId timer_id;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        timer_id = timer_wheel_.Add(GetCurrentTimeMs() + interval_ms, interval_ms, std::move(callback));
+    }
     
-    WakeUp(); // 唤醒事件循环重新计算超时
-    return timer.id;
+    if (!IsInLoopThread()) {
+        WakeUp(); // 唤醒事件循环重新计算超时
+    }
+    return timer_id;
 }
 
-void EventLoop::CancelTimer(TimerId timer_id) {//取消定时器 在最小堆里删除
+void EventLoop::CancelTimer(TimerId timer_id) {//取消定时器 从时间轮槽位链表中摘除
     std::lock_guard<std::mutex> lock(timer_mutex_);
-    
-    auto it = std::find_if(timers_.begin(), timers_.end(),
-        [timer_id](const Timer& timer) { return timer.id == timer_id; });
-    
-    if (it != timers_.end()) {
-        timers_.erase(it);
-        std::make_heap(timers_.begin(), timers_.end(), Timer::Compare());
+    timer_wheel_.Cancel(timer_id);
+}
+
+bool EventLoop::TouchTimer(TimerId timer_id, uint64_t delay_ms) {
+    bool touched;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        touched = timer_wheel_.Reschedule(timer_id, GetCurrentTimeMs() + delay_ms);
+    }
+    if (touched && !IsInLoopThread()) {
+        WakeUp();
     }
+    return touched;
 }
 
 void EventLoop::RunInLoop(Task task) {
@@ -246,27 +285,26 @@ void EventLoop::RunInLoop(Task task) {
 }
 
 void EventLoop::QueueInLoop(Task task) {
-    {
-        std::lock_guard<std::recursive_mutex> lock(task_mutex_);
-        pending_tasks_.push_back(std::move(task));
+    TaskNode* node = new TaskNode;
+    node->task = std::move(task);
+
+    // 队列由空变非空时才需要唤醒；后续生产者由第一个生产者或loop自身的计数检查兜底
+    size_t prev_count = pending_task_count_.fetch_add(1);
+    task_queue_.Push(node);
+    if (prev_count == 0) {
+        WakeUp(); // 唤醒事件循环处理新任务
     }
-    WakeUp(); // 唤醒事件循环处理新任务
 }
 
 EventLoop::Statistics EventLoop::GetStatistics() const {
     Statistics stats;
+    stats.active_fd_count = registered_fd_count_.load(std::memory_order_relaxed);
+    stats.pending_tasks = pending_task_count_.load(std::memory_order_relaxed);
+    stats.loop_iterations = loop_iterations_.load(std::memory_order_relaxed);
+    stats.wakeup_writes = wakeup_writes_.load(std::memory_order_relaxed);
     {
-        std::lock_guard<std::recursive_mutex> lock(fd_mutex_);//保护fd_callbacks_的互斥锁
-        //将所有对同一个 epfd 的 epoll_ctl 操作，串行化到同一个线程（通常是事件循环线程）执行，避免多线程直接调用 epoll_ctl。
-        stats.active_fd_count = fd_callbacks_.size();
-    }
-    {
-        std::lock_guard<std::recursive_mutex> lock(task_mutex_);//保护任务队列的互斥锁
-        stats.pending_tasks = pending_tasks_.size();
-    }
-    {
-        std::lock_guard<std::mutex> lock(timer_mutex_);//最小堆的
-        stats.active_timers = timers_.size();
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        stats.active_timers = timer_wheel_.Size();
     }
     return stats;
 }
@@ -282,65 +320,53 @@ uint64_t EventLoop::GetCurrentTimeMs() const {
 int EventLoop::CalculateNextTimeout() const {
     std::lock_guard<std::mutex> lock(timer_mutex_);
     
-    if (timers_.empty()) {
-        return -1; // 无定时器，无限等待
-    }
-    
-    uint64_t now = GetCurrentTimeMs();
-    uint64_t next_expire = timers_.front().expiration;
-    
-    if (next_expire <= now) {
-        return 0; // 有定时器已到期，立即处理
+    // 时间轮基于上次推进的时间计算，-1表示无定时器，无限等待
+    int64_t timeout = timer_wheel_.NextTimeout();
+    if (timeout < 0) {
+        return -1;
     }
-    
-    return static_cast<int>(next_expire - now); // 返回精确等待时间
+    return static_cast<int>(std::min<int64_t>(timeout, INT32_MAX)); // 返回精确等待时间
 }
 
 void EventLoop::ProcessExpiredTimers() {
-    std::vector<Timer> expired_timers;
-    uint64_t now = GetCurrentTimeMs();
-    
-    // 批量取出所有到期定时器
-    {
-        std::lock_guard<std::mutex> lock(timer_mutex_);
-        while (!timers_.empty() && timers_.front().expiration <= now) {
-            expired_timers.push_back(timers_.front());
-            std::pop_heap(timers_.begin(), timers_.end(), Timer::Compare());
-            timers_.pop_back();
-        }
-    }
-    
-    // 执行到期定时器回调
-    for (auto& timer : expired_timers) {
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+    timer_wheel_.Advance(GetCurrentTimeMs());
+
+    // 逐个执行到期定时器；回调在锁外执行，可在回调中增删/touch定时器
+    TimerId timer_id;
+    while ((timer_id = timer_wheel_.PopExpired()) != TimingWheel::kInvalidTimerId) {
+        Task& callback = timer_wheel_.GetCallback(timer_id);
+        lock.unlock();
         try {
-            timer.callback();
+            callback();
         } catch (const std::exception& e) {
             std::cerr << "Timer callback error: " << e.what() << std::endl;
         }
-        
-        // 重复定时器重新加入队列
-        if (timer.repeated) {
-            std::lock_guard<std::mutex> lock(timer_mutex_);
-            timer.expiration = now + timer.interval;
-            timers_.push_back(timer);
-            std::push_heap(timers_.begin(), timers_.end(), Timer::Compare());
-        }
+        lock.lock();
+        // 重复定时器原地重新放入时间轮
+        timer_wheel_.FinishRun(timer_id);
     }
 }
 
 void EventLoop::ProcessPendingTasks() {
-    std::vector<Task> tasks;
-    {
-        std::lock_guard<std::recursive_mutex> lock(task_mutex_);
-        tasks.swap(pending_tasks_); // 批量取出所有任务
-    }
-    
-    for (auto& task : tasks) {
+    // 只处理进入本函数时已计数的任务，任务中再投递的任务留到下一轮，避免饿死I/O
+    size_t budget = pending_task_count_.load(std::memory_order_acquire);
+    size_t executed = 0;
+    while (executed < budget) {
+        TaskNode* node = task_queue_.Pop();
+        if (node == nullptr) {
+            break; // 生产者已计数但尚未链接完成，下一轮（timeout为0）再取
+        }
+        ++executed;
         try {
-            task();
+            node->task();
         } catch (const std::exception& e) {
             std::cerr << "Task execution error: " << e.what() << std::endl;
         }
+        delete node;
+    }
+    if (executed > 0) {
+        pending_task_count_.fetch_sub(executed);
     }
 }
 
@@ -350,25 +376,47 @@ void EventLoop::HandleTaskNotification() {
     if (read(event_fd_, &value, sizeof(value)) < 0 && errno != EAGAIN) {
         std::cerr << "Failed to read from eventfd: " << strerror(errno) << std::endl;
     }
+    wakeup_pending_.store(false);
 }
 
 void EventLoop::WakeUp() {
+    if (!polling_.load()) {
+        return; // loop醒着，本轮结束前会检查任务计数与running_
+    }
+    if (wakeup_pending_.exchange(true)) {
+        return; // 已有尚未消费的唤醒
+    }
     uint64_t value = 1;
     // 写入eventfd触发通知
     if (write(event_fd_, &value, sizeof(value)) < 0 && errno != EAGAIN) {
         std::cerr << "Failed to write to eventfd: " << strerror(errno) << std::endl;
     }
+    wakeup_writes_.fetch_add(1, std::memory_order_relaxed);
+}
+
+int EventLoop::ControlFd(int op, int fd, epoll_event* event) {
+    // io_uring后端只把请求写入SQ，随下一次等待一起提交
+    return uring_ ? uring_->Control(op, fd, event) : epoll_ctl(epoll_fd_, op, fd, event);
+}
+
+int EventLoop::WaitEvents(epoll_event* events, int max_events, int timeout) {
+    return uring_ ? uring_->Wait(events, max_events, timeout)
+                  : epoll_wait(epoll_fd_, events, max_events, timeout);
 }
 
 void EventLoop::HandleIoEvent(const epoll_event& event) {
-    std::lock_guard<std::recursive_mutex> lock(fd_mutex_);
-    auto it = fd_callbacks_.find(event.data.fd);
-    if (it != fd_callbacks_.end()) {
-        try {
-            it->second(event.data.fd, event.events); // 执行注册的回调
-        } catch (const std::exception& e) {
-            std::cerr << "IO event callback error: " << e.what() << std::endl;
-        }
+    uint32_t fd = static_cast<uint32_t>(event.data.u64);
+    if (fd >= channels_.size()) {
+        return;
+    }
+    Channel& channel = channels_[fd];
+    if (channel.generation != static_cast<uint32_t>(event.data.u64 >> 32) || !channel.callback) {
+        return; // fd已移除或已被复用，丢弃旧事件
+    }
+    try {
+        channel.callback(static_cast<int>(fd), event.events); // 执行注册的回调
+    } catch (const std::exception& e) {
+        std::cerr << "IO event callback error: " << e.what() << std::endl;
     }
 }
 
@@ -13,13 +13,19 @@
 #include <iostream>
 #include <algorithm>
 #include <queue>
+#include <memory>
+#include "timing_wheel.hpp"
+#include "mpsc_queue.hpp"
 
 namespace ppserver {
 
+class IoUringPoller;
+
 /**
  * EventLoop - 事件循环核心组件
  * 负责：I/O事件多路复用、定时器管理、跨线程任务调度
- * 设计特点：单线程事件循环、边缘触发模式、最小堆定时器
+ * 设计特点：单线程事件循环、边缘触发模式、分层时间轮定时器
+ *          多路复用后端可选epoll（默认）或io_uring，io_uring不可用时自动回退epoll
  */
 class EventLoop {
 public:
@@ -34,7 +40,13 @@ public:
     using Task = std::function<void()>;
     using TimerId = uint64_t;
 
-    EventLoop();
+    // 多路复用后端
+    enum class Backend {
+        EPOLL,      // epoll（默认）
+        IO_URING    // io_uring multishot poll（仅就绪通知），注册变更与等待合并为一次系统调用
+    };
+
+    explicit EventLoop(Backend backend = Backend::EPOLL);
  
     ~EventLoop();
     
@@ -47,20 +59,24 @@ public:
     int Run();
     void Stop();
     bool IsInLoopThread() const;
+    Backend GetBackend() const;// 实际使用的后端（请求io_uring但不可用时为EPOLL）
 
     // 文件描述符管理  将所有对同一个 epfd 的 epoll_ctl 操作，串行化到同一个线程（通常是事件循环线程）执行，避免多线程直接调用 epoll_ctl。
+    // 非loop线程调用时经任务队列转交给loop线程执行
     void AddFd(int fd, uint32_t events, EventCallback callback);
     void UpdateFd(int fd, uint32_t events);
     void RemoveFd(int fd);
 
-    // 定时器接口
+    // 定时器接口（插入、取消、touch均为O(1)）
     TimerId RunAfter(uint64_t delay_ms, Task callback);
     TimerId RunEvery(uint64_t interval_ms, Task callback);
     void CancelTimer(TimerId timer_id);
+    // 把已有定时器推迟到delay_ms之后，复用原回调（如连接空闲超时的续期）；定时器已失效时返回false
+    bool TouchTimer(TimerId timer_id, uint64_t delay_ms);
 
     // 任务调度接口
     void RunInLoop(Task task);// 在事件循环线程中执行任务
-    void QueueInLoop(Task task);// 在线程安全队列中添加任务，稍后执行
+    void QueueInLoop(Task task);// 在无锁任务队列中添加任务，稍后执行
 
     // 性能监控接口
     struct Statistics {
@@ -68,26 +84,10 @@ public:
         size_t pending_tasks;         // 待处理任务数
         size_t active_timers;         // 活跃定时器数
         uint64_t loop_iterations;     // 事件循环迭代次数
+        uint64_t wakeup_writes;       // eventfd写入次数（合并唤醒后远小于投递任务数）
     };
     Statistics GetStatistics() const;
 
-   
-    // 定时器结构
-    struct Timer {
-        TimerId id;
-        uint64_t expiration;          // 到期时间戳(毫秒)
-        uint64_t interval;           // 重复间隔(毫秒)
-        Task callback;
-        bool repeated;               // 是否重复执行
-
-        // 最小堆比较函数
-        struct Compare {
-            bool operator()(const Timer& a, const Timer& b) const {
-                return a.expiration > b.expiration;
-            }
-        };
-    };
- 
 
 private:
     
@@ -98,27 +98,50 @@ private:
     void ProcessExpiredTimers();// 处理到期定时器
     void ProcessPendingTasks();// 处理待执行任务
     void HandleTaskNotification();// 处理任务通知事件
-    void WakeUp();// 唤醒事件循环
+    void WakeUp();// 唤醒事件循环：仅在loop阻塞于epoll_wait且没有未消费的唤醒时写eventfd
     void HandleIoEvent(const epoll_event& event);// 处理I/O事件
+    int ControlFd(int op, int fd, epoll_event* event);// 按后端转发epoll_ctl
+    int WaitEvents(epoll_event* events, int max_events, int timeout);// 按后端转发epoll_wait
+    void AddFdInLoop(int fd, uint32_t events, EventCallback callback);
+    void UpdateFdInLoop(int fd, uint32_t events);
+    void RemoveFdInLoop(int fd);
+
+    // fd分发表表项：generation随每次AddFd递增，与epoll_event.data一起校验，
+    // 丢弃同一批事件中fd被关闭又复用后残留的旧事件
+    struct Channel {
+        EventCallback callback;
+        uint32_t generation = 0;
+    };
 
     // 成员变量
-    int epoll_fd_;                   // epoll实例文件描述符
+    int epoll_fd_;                   // epoll实例文件描述符（io_uring后端时为-1）
+    std::unique_ptr<IoUringPoller> uring_; // io_uring后端，epoll后端时为空
     int event_fd_;                   // 事件通知文件描述符
     std::atomic<bool> running_;      // 运行状态标志
     std::thread::id owner_thread_id_; // 所属线程ID
 
-    // 文件描述符回调映射
-    std::unordered_map<int, EventCallback> fd_callbacks_;
-    mutable std::recursive_mutex fd_mutex_;     // FD映射的互斥锁
+    // 文件描述符分发表（下标即fd），只在loop线程内访问，无需加锁
+    std::vector<Channel> channels_;
+    std::vector<EventCallback> retired_callbacks_; // 分发过程中被移除的回调，本批事件处理完再销毁
+    std::atomic<size_t> registered_fd_count_;      // 已注册fd数（供统计跨线程读取）
 
-    // 定时器队列（最小堆）
-    std::vector<Timer> timers_;
-    mutable std::mutex timer_mutex_;  // 定时器队列的互斥锁
-    std::atomic<TimerId> next_timer_id_; // 定时器ID生成器
+    // 定时器（分层时间轮）
+    TimingWheel timer_wheel_;
+    mutable std::mutex timer_mutex_;  // 时间轮的互斥锁（回调在锁外执行）
+
+    // 任务队列节点：每个任务一次分配，入队无锁
+    struct TaskNode {
+        std::atomic<TaskNode*> next{nullptr};
+        Task task;
+    };
 
     // 任务队列
-    std::vector<Task> pending_tasks_;//
-    mutable std::recursive_mutex task_mutex_;   // 任务队列的互斥锁
+    MpscQueue<TaskNode> task_queue_;
+    std::atomic<size_t> pending_task_count_;   // 已计数未执行的任务数（先计数再入队）
+    std::atomic<bool> polling_;                // loop是否阻塞（或即将阻塞）在epoll_wait中
+    std::atomic<bool> wakeup_pending_;         // eventfd已写入尚未读取
+    std::atomic<uint64_t> wakeup_writes_;
+    std::atomic<uint64_t> loop_iterations_;
 };
 
 } // namespace ppsever
\ No newline at end of file
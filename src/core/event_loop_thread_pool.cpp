@@ -0,0 +1,99 @@
+#include "event_loop_thread_pool.hpp"
+#include <stdexcept>
+#include <csignal>
+#include <pthread.h>
+
+namespace ppserver {
+
+EventLoopThreadPool::EventLoopThreadPool(size_t num_threads, EventLoop::Backend backend)
+    : num_threads_(num_threads),
+      backend_(backend),
+      loops_(num_threads, nullptr),
+      ready_count_(0),
+      started_(false) {
+}
+
+EventLoopThreadPool::~EventLoopThreadPool() {
+    Stop();
+}
+
+void EventLoopThreadPool::Start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+
+    threads_.reserve(num_threads_);
+    for (size_t i = 0; i < num_threads_; ++i) {
+        threads_.emplace_back(&EventLoopThreadPool::ThreadFunc, this, i);
+    }
+
+    // 等待所有loop进入Run()，避免Stop()先于Run()执行导致loop无法退出
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return ready_count_ == num_threads_; });
+}
+
+void EventLoopThreadPool::Stop() {
+    if (!started_) {
+        return;
+    }
+    started_ = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (EventLoop* loop : loops_) {
+            if (loop) {
+                loop->Stop();
+            }
+        }
+    }
+
+    for (std::thread& t : threads_) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    threads_.clear();
+    ready_count_ = 0;
+}
+
+size_t EventLoopThreadPool::Size() const {
+    return num_threads_;
+}
+
+EventLoop& EventLoopThreadPool::GetLoop(size_t index) const {
+    if (index >= loops_.size() || loops_[index] == nullptr) {
+        throw std::out_of_range("EventLoopThreadPool: invalid loop index");
+    }
+    return *loops_[index];
+}
+
+void EventLoopThreadPool::ThreadFunc(size_t index) {
+    // 屏蔽退出信号，让信号处理函数只在主线程执行（其中会join本线程）
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    EventLoop loop(backend_);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loops_[index] = &loop;
+    }
+
+    // 第一个任务在Run()内执行，此时running_已置位
+    loop.QueueInLoop([this]() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++ready_count_;
+        cond_.notify_all();
+    });
+
+    loop.Run();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    loops_[index] = nullptr;
+}
+
+} // namespace ppserver
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "event_loop.hpp"
+
+namespace ppserver {
+
+/**
+ * EventLoopThreadPool - IO线程池（one loop per thread）
+ * 负责：创建N个线程，每个线程在自己的栈上构造并运行一个EventLoop
+ * 设计特点：EventLoop在所属线程内构造，保证owner_thread_id_正确；
+ *          Start()阻塞到所有loop都进入Run()后才返回
+ */
+class EventLoopThreadPool {
+public:
+    explicit EventLoopThreadPool(size_t num_threads,
+                                 EventLoop::Backend backend = EventLoop::Backend::EPOLL);
+    ~EventLoopThreadPool();
+
+    EventLoopThreadPool(const EventLoopThreadPool&) = delete;
+    EventLoopThreadPool& operator=(const EventLoopThreadPool&) = delete;
+
+    void Start();
+    void Stop();// 停止所有loop并join线程
+
+    size_t Size() const;
+    EventLoop& GetLoop(size_t index) const;
+
+private:
+    void ThreadFunc(size_t index);
+
+    size_t num_threads_;
+    EventLoop::Backend backend_;       // 各loop使用的多路复用后端
+    std::vector<std::thread> threads_;
+    std::vector<EventLoop*> loops_;     // 指向各线程栈上的EventLoop
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    size_t ready_count_;
+    bool started_;
+};
+
+} // namespace ppserver
@@ -1,9 +1,11 @@
 #include "handler.hpp"
+#include "static_file_handler.hpp"
 #include <system_error>
 #include <cstring>
 #include <unistd.h>
 #include <fcntl.h>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace ppserver {
@@ -15,54 +17,307 @@ Handler::Handler(EventLoop& loop, Connection& conn, ThreadPool& thread_pool)
       thread_pool_(thread_pool) {
 }
 
+namespace {
+
+std::shared_ptr<const std::string> BuildDefaultResponse(bool keep_alive) {
+    HttpResponse response;
+    response.SetHeader("Content-Type", "text/html; charset=utf-8"); // 添加字符集
+    response.SetHeader("Access-Control-Allow-Origin", "*");         // 添加CORS头
+    response.SetBody("<h1>Hello PP</h1>");
+    response.SetKeepAlive(keep_alive);
+    return std::make_shared<const std::string>(response.Serialize());
+}
+
+// 默认页面的响应只生成一次，各连接共享发送，不再逐请求拼接
+const std::shared_ptr<const std::string>& DefaultResponse(bool keep_alive) {
+    static const std::shared_ptr<const std::string> keep_alive_response = BuildDefaultResponse(true);
+    static const std::shared_ptr<const std::string> close_response = BuildDefaultResponse(false);
+    return keep_alive ? keep_alive_response : close_response;
+}
+
+// 执行业务处理函数，处理函数抛出异常时改为回复500
+template<typename F>
+bool InvokeRequestHandler(const F& handler, const HttpRequestView& request, HttpResponse& response) {
+    try {
+        return handler(request, response);
+    } catch (const std::exception& e) {
+        std::cerr << "Request handler threw: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Request handler threw unknown exception" << std::endl;
+    }
+    response.SetStatusCode(HttpResponse::HttpStatusCode::INTERNAL_SERVER_ERROR);
+    response.SetHeader("Content-Type", "text/plain; charset=utf-8");
+    response.SetBody("Internal Server Error\n");
+    return true;
+}
+
+} // namespace
+
+// 交给线程池的请求。持有连接的强引用：在途期间客户端断开时连接照常关闭，
+// 但对象不会被ConnectionSlab回收复用，响应交回时按状态丢弃即可
+struct Handler::OffloadContext {
+    std::shared_ptr<Connection> connection;
+    std::shared_ptr<const RequestHandler> request_handler;
+    // 独立于读缓冲区的请求：拷贝解析得到的对象直接移交（内存仍在连接的RequestArena中，
+    // 工作线程只读不分配，释放在loop线程内进行），零拷贝视图则拷贝一份
+    HttpRequestPtr request;
+    bool keep_alive = true;
+    bool executed = false;         // 处理函数已执行；任务被拒绝或丢弃时为false
+    bool handled = false;          // 处理函数返回true
+    std::string response;          // 工作线程内序列化好的响应
+    RouteCostTracker::Route* route = nullptr;   // ADAPTIVE模式下的路由条目，交回loop后记录耗时
+    bool routed = false;                        // ADAPTIVE模式下已匹配过路由，执行时使用match
+    RouteMatch match;                           // 参数值已改为引用request中的路径
+    std::chrono::nanoseconds elapsed{0};        // 处理函数耗时
+};
+
+// 线程池任务：执行处理函数后把结果交回loop。任务被拒绝或丢弃（DROP_OLDEST、关闭）时不会执行，
+// 析构时同样交回（回复503），连接因此不会停在暂停读取状态
+class Handler::OffloadTask {
+public:
+    OffloadTask(Handler* handler, std::shared_ptr<OffloadContext> context)
+        : handler_(handler), context_(std::move(context)) {}
+    OffloadTask(OffloadTask&&) noexcept = default;
+    OffloadTask& operator=(OffloadTask&&) noexcept = default;
+
+    ~OffloadTask() {
+        if (context_) {
+            handler_->PostCompletion(std::move(context_));
+        }
+    }
+
+    void operator()() {
+        OffloadContext& context = *context_;
+        HttpRequestView view;
+        view.Assign(*context.request);
+        HttpResponse response;
+        auto start = std::chrono::steady_clock::now();
+        context.handled = handler_->Execute(*context.request_handler, view,
+                                            context.routed ? &context.match : nullptr, response);
+        context.elapsed = std::chrono::steady_clock::now() - start;
+        if (context.handled) {
+            response.SetKeepAlive(context.keep_alive);
+            context.response = response.Serialize();
+        }
+        context.executed = true;
+        handler_->PostCompletion(std::move(context_));
+    }
+
+private:
+    Handler* handler_;      // 连接拥有Handler，context_持有连接，因此一直有效
+    std::shared_ptr<OffloadContext> context_;
+};
+
 // HTTP处理器方法实现
 
 void Handler::HandleRead(std::shared_ptr<Connection> conn) {
-    std::cout << "Handling HTTP request from: " << conn->GetRemoteAddress() << std::endl;
-    
-    // 读取数据
-    ssize_t bytes_read = conn->ReadData();
-    if (bytes_read < 0) {
-        std::cerr << "Failed to read data from client" << std::endl;
+    // 读取数据（读到EAGAIN为止）；对端关闭或读错误时ReadData已关闭连接。
+    // 读缓冲区满时ReadData提前返回，处理掉已读数据（大正文边到达边交付）后继续读
+    do {
+        ssize_t bytes_read = conn->ReadData();
+        if (bytes_read <= 0) {
+            return;
+        }
+        ProcessRequests(*conn);
+    } while (conn->HasPendingRead() && !conn->IsReadingPaused());
+
+    // 对端已半关闭且没有待发送数据时直接关闭；否则在写完后关闭
+    if (conn->IsPeerClosed() && conn->GetWriteBufferSize() == 0 && !conn->IsReadingPaused()) {
         conn->Close();
+    }
+}
+
+void Handler::HandleResume(std::shared_ptr<Connection> conn) {
+    if (offload_in_flight_) {
+        // 正文消费方提前恢复了读取：仍须等在途请求的响应交回，否则后续请求的响应会抢在前面
+        conn->PauseReading();
         return;
     }
-    
-    if (bytes_read == 0) {
-        // 客户端关闭连接
-        conn->Close();
+    ProcessRequests(*conn);
+    if (!conn->IsReadingPaused()) {
+        HandleRead(std::move(conn));
+    }
+}
+
+void Handler::ProcessRequests(Connection& conn) {
+    // 一次读入的数据可能包含多个（流水线）请求，逐个在读缓冲区上原地解析，
+    // 响应按请求顺序入队，读回调结束后一次写出
+    if (zero_copy_) {
+        while (conn.TryParseRequestView()) {
+            if (!Respond(conn, conn.GetRequestView())) {
+                break;
+            }
+        }
+    } else {
+        HttpRequestView view;
+        while (conn.TryParseHttpRequest()) {
+            HttpRequestPtr request = conn.TakeRequest();
+            if (!request) {
+                continue;
+            }
+            view.Assign(*request);
+            if (!Respond(conn, view, &request)) {
+                break;
+            }
+        }
+    }
+}
+
+
+bool Handler::Respond(Connection& conn, const HttpRequestView& request, HttpRequestPtr* owned) {
+    bool keep_alive = request.IsKeepAlive();
+    if (!request_handler_) {
+        RespondDefault(conn, request, keep_alive);
+        return FinishResponse(conn, keep_alive);
+    }
+
+    bool offload = handler_mode_ == HandlerMode::ASYNC;
+    RouteCostTracker::Route* route = nullptr;
+    RouteMatch match;
+    const RouteMatch* routed = nullptr;
+    if (handler_mode_ == HandlerMode::ADAPTIVE && route_costs_) {
+        std::string_view path = Router::PathOf(request.GetPath());
+        if (router_) {
+            // 带参数的路由共用一个条目；未匹配的请求仍按原始路径统计。匹配结果留给执行时使用
+            match.route = router_->Match(request.GetMethod(), path, match.params);
+            if (match.route) {
+                path = match.route->pattern;
+            }
+            routed = &match;
+        }
+        route = &route_costs_->Find(request.GetMethod(), path);
+        offload = !route->IsInline();
+    }
+    if (offload) {
+        Offload(conn, request, owned, keep_alive, route, routed);
+        return false;   // 响应交回之前不处理后续流水线请求
+    }
+    if (!RespondInline(conn, request, keep_alive, route, routed)) {
+        RespondDefault(conn, request, keep_alive);
+    }
+    return FinishResponse(conn, keep_alive);
+}
+
+void Handler::RespondDefault(Connection& conn, const HttpRequestView& request, bool keep_alive) {
+    if (static_files_) {
+        static_files_->Serve(conn, request);
+    } else {
+        conn.WriteData(DefaultResponse(keep_alive));
+    }
+}
+
+bool Handler::Execute(const RequestHandler& handler, const HttpRequestView& request, const RouteMatch* routed,
+                      HttpResponse& response) const {
+    if (!routed) {
+        return InvokeRequestHandler(handler, request, response);
+    }
+    // 与WebServer组合的处理函数相同（路由器分发，未匹配的交给fallback_），只是不再重复匹配
+    return InvokeRequestHandler(
+        [this, routed](const HttpRequestView& view, HttpResponse& out) {
+            return router_->Dispatch(view, routed->route, routed->params, out) ||
+                   (fallback_ && (*fallback_)(view, out));
+        },
+        request, response);
+}
+
+bool Handler::RespondInline(Connection& conn, const HttpRequestView& request, bool keep_alive,
+                            RouteCostTracker::Route* route, const RouteMatch* routed) {
+    RequestArena::Lease lease(conn.GetRequestArena());
+    HttpResponse response(conn.GetRequestArena().Resource());
+    auto start = std::chrono::steady_clock::now();
+    bool handled = Execute(*request_handler_, request, routed, response);
+    if (route) {
+        route_costs_->Record(*route, std::chrono::steady_clock::now() - start, true);
+    }
+    if (!handled) {
+        return false;
+    }
+    response.SetKeepAlive(keep_alive);
+    conn.WriteData(response.Serialize());
+    return true;
+}
+
+void Handler::Offload(Connection& conn, const HttpRequestView& request, HttpRequestPtr* owned,
+                      bool keep_alive, RouteCostTracker::Route* route, const RouteMatch* routed) {
+    auto context = std::make_shared<OffloadContext>();
+    context->connection = conn.shared_from_this();
+    context->request_handler = request_handler_;
+    // 回退路径的正文可能已溢出到临时文件，拷贝意味着在loop线程内重写整个文件，因此移交原对象
+    context->request = owned && *owned ? std::move(*owned) : conn.TakeRequestViewBacking();
+    if (!context->request) {
+        context->request = request.Copy();
+    }
+    context->keep_alive = keep_alive;
+    context->route = route;
+    if (routed) {
+        // 参数值引用原请求的路径，改为引用交给工作线程的请求（移交原对象时不变）
+        context->routed = true;
+        context->match = *routed;
+        context->match.params.Rebase(Router::PathOf(request.GetPath()),
+                                     Router::PathOf(context->request->GetPath()));
+    }
+
+    conn.PauseReading();
+    offload_in_flight_ = true;
+    if (offloads_in_flight_) {
+        offloads_in_flight_->fetch_add(1, std::memory_order_relaxed);
+    }
+    // 在loop线程提交，队列满时不能等待空位；被拒绝时任务随即析构并交回，由CompleteOffload回复503，
+    // 返回值因此不必处理
+    thread_pool_.TryPostNoWait(OffloadTask(this, std::move(context)));
+}
+
+void Handler::PostCompletion(std::shared_ptr<OffloadContext> context) {
+    loop_.QueueInLoop([this, context = std::move(context)]() mutable {
+        std::atomic<size_t>* counter = offloads_in_flight_;
+        CompleteOffload(*context);
+        // 释放连接引用之后才计数：连接可能随之回到ConnectionSlab或析构（Handler也随之失效）
+        context.reset();
+        if (counter) {
+            counter->fetch_sub(1, std::memory_order_release);
+        }
+    });
+}
+
+void Handler::CompleteOffload(OffloadContext& context) {
+    offload_in_flight_ = false;
+    if (context.route && context.executed) {
+        route_costs_->Record(*context.route, context.elapsed, false);
+    }
+    Connection& conn = *context.connection;
+    Connection::State state = conn.GetState();
+    if (state == Connection::State::DISCONNECTED || state == Connection::State::CLOSING) {
+        return;   // 客户端已断开（或连接已超时关闭），丢弃响应
+    }
+    if (!context.executed) {
+        conn.WriteData(HttpResponse::ServiceUnavailable(context.keep_alive));
+    } else if (context.handled) {
+        conn.WriteData(std::move(context.response));
+    } else {
+        HttpRequestView view;
+        view.Assign(*context.request);
+        RespondDefault(conn, view, context.keep_alive);
+    }
+    if (!context.keep_alive) {
+        conn.CloseAfterWrite();
+        // 不在读回调中，响应已直接写出：写完时不会再有关闭的时机，这里关闭
+        if (conn.GetWriteBufferSize() == 0 && conn.GetState() != Connection::State::DISCONNECTED) {
+            conn.Close();
+        }
         return;
     }
-    
-    // 获取读取的数据
-    std::string requestData = conn->GetReadBuffer();
-    
-    
-    // 检查是否收到完整的HTTP请求（以\r\n\r\n结尾）
-    if (requestData.find("\r\n\r\n") != std::string::npos) {
-        // 构建HTTP响应
-        std::cout << "Received data: " << requestData << std::endl;
-        
-        std::string content = "<h1>Hello PP</h1>";
-    
-        std::string response = 
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: text/html; charset=utf-8\r\n" // 添加字符集
-        "Content-Length: " + std::to_string(content.length()) + "\r\n"
-        "Connection: close\r\n"
-        "Access-Control-Allow-Origin: *\r\n" // 添加CORS头
-        "\r\n" // 空行分隔头部和主体
-        + content;
-        
-        std::cout << "Sending response to client" << std::endl;
-        conn->WriteData(response);
-        
-        // 设置写回调，在写完成后关闭连接
-       conn->ClearReadBuffer();
-    }
-    
+    // 处理暂停期间留在读缓冲区中的流水线请求，再继续读socket
+    conn.ResumeReading();
 }
 
+bool Handler::FinishResponse(Connection& conn, bool keep_alive) {
+    if (!keep_alive) {
+        // 之后的流水线请求不再处理，响应发完后关闭
+        conn.CloseAfterWrite();
+        return false;
+    }
+    return true;
+}
 
 void Handler::HandleWrite(std::shared_ptr<Connection> conn) {
     // 使用默认处理
@@ -74,12 +329,12 @@ void Handler::HandleError(std::shared_ptr<Connection> conn) {
     conn->DefaultHandleError();
 }
 
-void Handler::OnConnection(std::shared_ptr<Connection> conn) {
-    std::cout << "New HTTP connection from: " << conn->GetRemoteAddress() << std::endl;
+// 默认不输出逐连接日志：每次std::endl都同步刷新stdout，高连接速率下会拖慢IO线程；
+// 排查问题需要时再在这里临时加上
+void Handler::OnConnection(std::shared_ptr<Connection> /*conn*/) {
 }
 
-void Handler::OnDisconnection(std::shared_ptr<Connection> conn) {
-    std::cout << "HTTP connection closed: " << conn->GetRemoteAddress() << std::endl;
+void Handler::OnDisconnection(std::shared_ptr<Connection> /*conn*/) {
 }
 
 } // namespace ppserver
\ No newline at end of file
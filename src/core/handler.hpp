@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <functional>
 #include <string>
@@ -10,12 +11,16 @@
 #include "thread_pool.hpp"
 #include "connection_manager.hpp"
 #include "connection.hpp"
+#include "request_handler.hpp"
+#include "route_cost_tracker.hpp"
+#include "router.hpp"
 
 
 namespace ppserver {
 
 // 前置声明
 class Connection;
+class StaticFileHandler;
 
 /**
  * Handler - 抽象处理器基类
@@ -31,6 +36,8 @@ public:
     
     // 纯虚函数 - 定义必须实现的接口
      void HandleRead(std::shared_ptr<Connection> conn) ;
+     // Connection::ResumeReading之后：先处理暂停期间留在读缓冲区的数据，再继续读socket
+     void HandleResume(std::shared_ptr<Connection> conn);
      void HandleWrite(std::shared_ptr<Connection> conn) ;
      void HandleError(std::shared_ptr<Connection> conn) ;
 
@@ -41,6 +48,43 @@ public:
     void SetNextHandler(std::shared_ptr<Handler> next) {
         next_handler_ = next;
     }
+
+    // 配置了document_root时由WebServer设置（所属loop的实例），请求交给静态文件处理器
+    void SetStaticFileHandler(StaticFileHandler* static_files) {
+        static_files_ = static_files;
+    }
+
+    // 零拷贝解析（默认）：请求以视图形式引用读缓冲区；关闭后每个请求拷贝为HttpRequest
+    void SetZeroCopyParsing(bool enabled) {
+        zero_copy_ = enabled;
+    }
+
+    // 业务处理函数（WebServer所有，各连接共享），未设置或返回false时回复静态文件/默认页面。
+    // mode为ASYNC时在thread_pool_中执行，响应经EventLoop::QueueInLoop交回本连接的loop发送
+    void SetRequestHandler(std::shared_ptr<const RequestHandler> handler,
+                           HandlerMode mode) {
+        request_handler_ = std::move(handler);
+        handler_mode_ = mode;
+    }
+
+    // ADAPTIVE模式下由WebServer设置（所属loop的实例），按路由记录耗时并决定执行位置
+    void SetRouteCostTracker(RouteCostTracker* route_costs) {
+        route_costs_ = route_costs;
+    }
+
+    // 由WebServer设置（所属loop的计数）：交给线程池时加一，结果在loop内处理完、连接引用释放后减一，
+    // WebServer停止时等其归零再销毁loop
+    void SetOffloadCounter(std::atomic<size_t>* offloads_in_flight) {
+        offloads_in_flight_ = offloads_in_flight;
+    }
+
+    // 注册了路由时由WebServer设置：ADAPTIVE模式下按匹配到的路由模式（而不是原始路径）统计耗时，
+    // 并用这次匹配的结果直接分发，未匹配的交给fallback（SetRequestHandler设置的处理函数，可为空）。
+    // 两者都由request_handler_持有，生命周期不短于在途请求
+    void SetRouter(const Router* router, const RequestHandler* fallback) {
+        router_ = router;
+        fallback_ = fallback;
+    }
     
 protected:
     // 受保护的成员变量
@@ -51,6 +95,52 @@ protected:
     // 受保护的构造函数 - 防止直接实例化
 protected:
     std::shared_ptr<Handler> next_handler_;
+    StaticFileHandler* static_files_ = nullptr;
+    bool zero_copy_ = true;
+    std::shared_ptr<const RequestHandler> request_handler_;
+    HandlerMode handler_mode_ = HandlerMode::INLINE;
+    RouteCostTracker* route_costs_ = nullptr;
+    const Router* router_ = nullptr;
+    const RequestHandler* fallback_ = nullptr;
+    std::atomic<size_t>* offloads_in_flight_ = nullptr;
+
+private:
+    struct OffloadContext;
+    class OffloadTask;
+
+    // ADAPTIVE模式下为选择统计条目所做的路由匹配
+    struct RouteMatch {
+        const Router::Route* route = nullptr;   // 没有匹配的路由时为nullptr
+        RouteParams params;
+    };
+
+    // 解析并响应读缓冲区中所有完整的请求
+    void ProcessRequests(Connection& conn);
+    // 为一个请求生成响应，返回连接是否继续处理后续请求；
+    // owned非空时为request引用的请求对象，交给线程池时直接移走而不拷贝
+    bool Respond(Connection& conn, const HttpRequestView& request, HttpRequestPtr* owned = nullptr);
+    // 静态文件或默认页面
+    void RespondDefault(Connection& conn, const HttpRequestView& request, bool keep_alive);
+    // 在loop线程内执行业务处理函数并发送响应，处理函数返回false时返回false（未发送）；
+    // route非空时记录耗时
+    bool RespondInline(Connection& conn, const HttpRequestView& request, bool keep_alive,
+                       RouteCostTracker::Route* route, const RouteMatch* routed);
+    // 执行业务处理函数；routed非空时用已有的匹配结果经路由器分发，不再重复匹配（可在工作线程调用）
+    bool Execute(const RequestHandler& handler, const HttpRequestView& request, const RouteMatch* routed,
+                 HttpResponse& response) const;
+    // 响应已入队：非keep-alive时在写完后关闭，返回连接是否继续处理后续请求
+    static bool FinishResponse(Connection& conn, bool keep_alive);
+
+    // 把请求交给线程池，并暂停读取直到响应交回（保证流水线请求按顺序响应）。
+    // 拷贝解析得到的请求对象（owned或视图背后的对象）直接移交，原地引用读缓冲区的视图才拷贝
+    void Offload(Connection& conn, const HttpRequestView& request, HttpRequestPtr* owned, bool keep_alive,
+                 RouteCostTracker::Route* route, const RouteMatch* routed);
+    // 把执行结果（或任务未执行）交回本连接的loop
+    void PostCompletion(std::shared_ptr<OffloadContext> context);
+    // loop线程内：连接仍在则发送响应并恢复读取，客户端已断开则丢弃
+    void CompleteOffload(OffloadContext& context);
+
+    bool offload_in_flight_ = false;   // 有请求在线程池中处理（只在loop线程访问）
 };
 
 
@@ -0,0 +1,236 @@
+#include "http_headers.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace ppserver {
+
+HttpHeaders::HttpHeaders(std::pmr::memory_resource* resource)
+    : resource_(resource),
+      overflow_entries_(resource),
+      count_(0),
+      heap_text_(nullptr),
+      text_size_(0),
+      text_capacity_(kInlineBytes) {
+    known_.fill(kNone);
+}
+
+HttpHeaders::HttpHeaders(const HttpHeaders& other)
+    : HttpHeaders() {
+    CopyFrom(other);
+}
+
+HttpHeaders::~HttpHeaders() {
+    FreeText();
+}
+
+HttpHeaders& HttpHeaders::operator=(const HttpHeaders& other) {
+    if (this != &other) {
+        Clear();
+        CopyFrom(other);
+    }
+    return *this;
+}
+
+HttpHeaders::HttpHeaders(HttpHeaders&& other) noexcept
+    : HttpHeaders(other.resource_) {
+    *this = std::move(other);
+}
+
+HttpHeaders& HttpHeaders::operator=(HttpHeaders&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    if (resource_ != other.resource_) {
+        // 内存来源不同不能接管对方的堆内存，逐项拷贝
+        Clear();
+        CopyFrom(other);
+        other.Clear();
+        return *this;
+    }
+    // 字段记录只含偏移，字符区无论在内联缓冲还是堆上都可以直接搬走
+    FreeText();
+    inline_entries_ = other.inline_entries_;
+    overflow_entries_ = std::move(other.overflow_entries_);
+    count_ = other.count_;
+    known_ = other.known_;
+    heap_text_ = other.heap_text_;
+    if (!heap_text_) {
+        std::memcpy(inline_text_, other.inline_text_, other.text_size_);
+    }
+    text_size_ = other.text_size_;
+    text_capacity_ = other.text_capacity_;
+    other.heap_text_ = nullptr;
+    other.overflow_entries_.clear();
+    other.count_ = 0;
+    other.known_.fill(kNone);
+    other.text_size_ = 0;
+    other.text_capacity_ = kInlineBytes;
+    return *this;
+}
+
+void HttpHeaders::FreeText() {
+    if (heap_text_) {
+        resource_->deallocate(heap_text_, text_capacity_, 1);
+        heap_text_ = nullptr;
+        text_capacity_ = kInlineBytes;
+    }
+}
+
+void HttpHeaders::CopyFrom(const HttpHeaders& other) {
+    for (const Field& field : other) {
+        Set(field.name, field.value);
+    }
+}
+
+void HttpHeaders::Set(std::string_view name, std::string_view value) {
+    HeaderId id = LookupHeader(name);
+    size_t index = Find(id, name);
+    if (index != count_) {
+        Entry& entry = EntryAt(index);
+        if (value.size() <= entry.value_length) {
+            // 新值不比旧值长：原地覆盖
+            if (!value.empty()) {
+                std::memmove(Text() + entry.value_offset, value.data(), value.size());
+            }
+        } else {
+            entry.value_offset = Store(value);
+        }
+        entry.value_length = static_cast<uint32_t>(value.size());
+        return;
+    }
+
+    if (name.size() > UINT16_MAX || count_ >= kNone) {
+        throw std::runtime_error("HTTP header too large");
+    }
+    Entry entry;
+    entry.name_offset = Store(name);
+    entry.name_length = static_cast<uint16_t>(name.size());
+    entry.value_offset = Store(value);
+    entry.value_length = static_cast<uint32_t>(value.size());
+    entry.id = id;
+    if (count_ < kInlineFields) {
+        inline_entries_[count_] = entry;
+    } else {
+        overflow_entries_.push_back(entry);
+    }
+    if (id != HeaderId::UNKNOWN) {
+        known_[static_cast<size_t>(id)] = static_cast<uint16_t>(count_);
+    }
+    ++count_;
+}
+
+bool HttpHeaders::Remove(std::string_view name) {
+    size_t index = Find(LookupHeader(name), name);
+    if (index == count_) {
+        return false;
+    }
+    // 后面的字段前移保持顺序；字符区中的旧数据不回收，Clear时整体复用
+    for (size_t i = index; i + 1 < count_; ++i) {
+        EntryAt(i) = EntryAt(i + 1);
+    }
+    --count_;
+    if (count_ >= kInlineFields) {
+        overflow_entries_.pop_back();
+    }
+    known_.fill(kNone);
+    for (size_t i = 0; i < count_; ++i) {
+        const Entry& entry = EntryAt(i);
+        if (entry.id != HeaderId::UNKNOWN) {
+            known_[static_cast<size_t>(entry.id)] = static_cast<uint16_t>(i);
+        }
+    }
+    return true;
+}
+
+void HttpHeaders::Clear() {
+    // 保留已分配的字符区和溢出数组容量，供下一个请求复用
+    overflow_entries_.clear();
+    count_ = 0;
+    known_.fill(kNone);
+    text_size_ = 0;
+}
+
+std::string_view HttpHeaders::Get(std::string_view name) const {
+    size_t index = Find(LookupHeader(name), name);
+    return index == count_ ? std::string_view() : At(index).value;
+}
+
+std::string_view HttpHeaders::Get(HeaderId id) const {
+    if (id == HeaderId::UNKNOWN) {
+        return std::string_view();
+    }
+    uint16_t index = known_[static_cast<size_t>(id)];
+    return index == kNone ? std::string_view() : At(index).value;
+}
+
+bool HttpHeaders::Has(std::string_view name) const {
+    return Find(LookupHeader(name), name) != count_;
+}
+
+bool HttpHeaders::Has(HeaderId id) const {
+    return id != HeaderId::UNKNOWN && known_[static_cast<size_t>(id)] != kNone;
+}
+
+HttpHeaders::Field HttpHeaders::At(size_t index) const {
+    const Entry& entry = EntryAt(index);
+    const char* text = Text();
+    return Field{std::string_view(text + entry.name_offset, entry.name_length),
+                 std::string_view(text + entry.value_offset, entry.value_length)};
+}
+
+size_t HttpHeaders::HeapBytes() const {
+    return (heap_text_ ? text_capacity_ : 0) + overflow_entries_.capacity() * sizeof(Entry);
+}
+
+size_t HttpHeaders::Find(HeaderId id, std::string_view name) const {
+    if (id != HeaderId::UNKNOWN) {
+        uint16_t index = known_[static_cast<size_t>(id)];
+        return index == kNone ? count_ : index;
+    }
+    HeaderNameEqual equal;
+    for (size_t i = 0; i < count_; ++i) {
+        const Entry& entry = EntryAt(i);
+        if (entry.id == HeaderId::UNKNOWN &&
+            equal(std::string_view(Text() + entry.name_offset, entry.name_length), name)) {
+            return i;
+        }
+    }
+    return count_;
+}
+
+HttpHeaders::Entry& HttpHeaders::EntryAt(size_t index) {
+    return index < kInlineFields ? inline_entries_[index] : overflow_entries_[index - kInlineFields];
+}
+
+const HttpHeaders::Entry& HttpHeaders::EntryAt(size_t index) const {
+    return index < kInlineFields ? inline_entries_[index] : overflow_entries_[index - kInlineFields];
+}
+
+uint32_t HttpHeaders::Store(std::string_view data) {
+    uint32_t offset = static_cast<uint32_t>(text_size_);
+    if (data.empty()) {
+        return offset;
+    }
+    if (text_size_ + data.size() > UINT32_MAX) {
+        throw std::runtime_error("HTTP headers too large");
+    }
+    if (text_size_ + data.size() > text_capacity_) {
+        size_t capacity = text_capacity_ * 2;
+        while (capacity < text_size_ + data.size()) {
+            capacity *= 2;
+        }
+        // 先写入新区再释放旧区：data可能引用表内已有的值
+        char* grown = static_cast<char*>(resource_->allocate(capacity, 1));
+        std::memcpy(grown, Text(), text_size_);
+        std::memcpy(grown + text_size_, data.data(), data.size());
+        FreeText();
+        heap_text_ = grown;
+        text_capacity_ = capacity;
+    } else {
+        std::memmove(Text() + text_size_, data.data(), data.size());
+    }
+    text_size_ += data.size();
+    return offset;
+}
+
+} // namespace ppserver
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "http_tokens.hpp"
+
+namespace ppserver {
+
+/**
+ * HttpHeaders - 请求头部字段表
+ * 负责：按到达顺序保存头部名和值，提供大小写不敏感的按名查找
+ * 设计特点：所有名和值连续存放在同一块字符区里（先用内联缓冲，不够时整体翻倍到堆上），
+ *          字段记录为区内偏移，前kInlineFields个字段记录也是内联的，
+ *          典型请求（8~20个头部、1KB以内）整张表只有0~1次堆分配，堆内存来自构造时给定的
+ *          memory_resource（如连接的RequestArena）；
+ *          常用头部经HeaderId索引O(1)定位，其余字段线性比较
+ */
+class HttpHeaders {
+public:
+    static constexpr size_t kInlineFields = 24;
+    static constexpr size_t kInlineBytes = 768;
+
+    struct Field {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    class Iterator {
+    public:
+        Iterator(const HttpHeaders* headers, size_t index) : headers_(headers), index_(index) {}
+        Field operator*() const { return headers_->At(index_); }
+        Iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const HttpHeaders* headers_;
+        size_t index_;
+    };
+
+    explicit HttpHeaders(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // 与pmr容器一致：拷贝构造使用默认资源，移动构造沿用来源的资源
+    HttpHeaders(const HttpHeaders& other);
+    HttpHeaders& operator=(const HttpHeaders& other);
+    HttpHeaders(HttpHeaders&& other) noexcept;
+    HttpHeaders& operator=(HttpHeaders&& other) noexcept;
+    ~HttpHeaders();
+
+    // 同名字段（大小写不敏感）已存在时替换其值，保留原位置和原始名字
+    void Set(std::string_view name, std::string_view value);
+    bool Remove(std::string_view name);
+    void Clear();
+
+    // 不存在时返回空视图
+    std::string_view Get(std::string_view name) const;
+    std::string_view Get(HeaderId id) const;
+    bool Has(std::string_view name) const;
+    bool Has(HeaderId id) const;
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    Field At(size_t index) const;
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, count_); }
+
+    // 字符区与字段记录占用的堆内存（内联部分不计）
+    size_t HeapBytes() const;
+
+private:
+    static constexpr uint16_t kNone = 0xffff;
+
+    struct Entry {
+        uint32_t name_offset;
+        uint32_t value_offset;
+        uint16_t name_length;
+        HeaderId id;
+        uint32_t value_length;
+    };
+
+    size_t Find(HeaderId id, std::string_view name) const;
+    Entry& EntryAt(size_t index);
+    const Entry& EntryAt(size_t index) const;
+    // 把数据追加到字符区，返回偏移
+    uint32_t Store(std::string_view data);
+    char* Text() { return heap_text_ ? heap_text_ : inline_text_; }
+    const char* Text() const { return heap_text_ ? heap_text_ : inline_text_; }
+    void CopyFrom(const HttpHeaders& other);
+    void FreeText();
+
+    std::array<Entry, kInlineFields> inline_entries_;
+    std::pmr::memory_resource* resource_;
+    std::pmr::vector<Entry> overflow_entries_;    // 第kInlineFields个之后的字段
+    size_t count_;
+    std::array<uint16_t, kKnownHeaderCount> known_;   // 常用头部 -> 字段下标
+    char inline_text_[kInlineBytes];
+    char* heap_text_;                             // 超出内联缓冲后的字符区，容量为text_capacity_
+    size_t text_size_;
+    size_t text_capacity_;
+};
+
+} // namespace ppserver
@@ -1,156 +1,154 @@
 #include "http_parser.hpp"
+#include "http_scanner.hpp"
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cstring>
 #include <sstream>
 #include <iostream>
 
 namespace ppserver {
 
+namespace {
+
+std::string_view TrimWhitespace(std::string_view value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+// Content-Length须整个值都是十进制数字（不接受符号、空值与尾随字符），两种解析模式共用
+bool ParseContentLength(std::string_view value, size_t& length) {
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+    return ec == std::errc() && end == value.data() + value.size() && !value.empty();
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+} // namespace
+
 HttpParser::HttpParser() 
     : state_(ParseState::START_LINE),
+      arena_(nullptr),
       content_length_(0),
       chunked_encoding_(false),
+      has_content_length_(false),
+      has_transfer_encoding_(false),
+      body_memory_limit_(RequestBody::kDefaultMemoryLimit),
+      max_body_size_(kDefaultMaxBodySize),
+      body_received_(0),
+      paused_(false),
       total_bytes_parsed_(0),
       current_chunk_size_(0),
-      chunk_size_parsed_(false) {
-    
-    request_ = std::make_unique<HttpRequest>();
+      chunk_size_parsed_(false),
+      chunk_trailers_(false),
+      view_scanned_(0),
+      view_needed_(0) {
 }
 
-// ... existing code ...
 ParseResult HttpParser::Parse(const char* data, size_t len) {
     if (len == 0 || data == nullptr) {
         ParseResult result;
         result.success = false;
         result.state = state_;
-        result.bytes_parsed = total_bytes_parsed_;
+        result.bytes_parsed = 0;
         result.error_message = "Invalid input data";
         return result;
     }
     
-    // 将新数据追加到缓冲区（处理跨数据包的情况）
-    buffer_.append(data, len);
-    
     size_t pos = 0;
     ParseResult result;
-    result.bytes_parsed = 0;
+    result.success = true;
+    paused_ = false;
+    if (!request_) {
+        request_ = HttpRequest::Create(arena_);
+    }
     
     try {
-        // 基于当前状态进行解析
-        while (pos < buffer_.size() && state_ != ParseState::COMPLETE && state_ != ParseState::ERROR) {
+        // 基于当前状态进行解析，某一阶段没有前进说明需要更多数据
+        while (pos < len && state_ != ParseState::COMPLETE && state_ != ParseState::ERROR) {
             size_t prev_pos = pos;
             
             switch (state_) {
                 case ParseState::START_LINE:
-                    result = ParseStartLine(buffer_.c_str(), buffer_.size(), pos);
+                    result = ParseStartLine(data, len, pos);
                     break;
                 case ParseState::HEADERS:
-                    result = ParseHeaders(buffer_.c_str(), buffer_.size(), pos);
+                    result = ParseHeaders(data, len, pos);
                     break;
                 case ParseState::BODY:
-                    result = ParseBody(buffer_.c_str(), buffer_.size(), pos);
+                    result = ParseBody(data, len, pos);
                     break;
                 case ParseState::CHUNKED_BODY:
-                    result = ParseChunkedBody(buffer_.c_str(), buffer_.size(), pos);
+                    result = ParseChunkedBody(data, len, pos);
                     break;
                 default:
                     HandleError("Invalid parser state");
                     break;
             }
             
-            if (!result.success) {
-                return result;
+            if (!result.success || paused_) {
+                break;
+            }
+            if (pos == prev_pos) {
+                break;
             }
-            
-            // 更新已处理位置
-            result.bytes_parsed += (pos - prev_pos);
-            total_bytes_parsed_ += (pos - prev_pos);
-        }
-        
-        // 检查是否完成解析
-        if (state_ == ParseState::COMPLETE) {
-            result.success = true;
-            result.state = state_;
-        }
-        
-        // 清理已处理的数据
-        if (pos > 0) {
-            buffer_.erase(0, pos);
         }
-        
     } catch (const std::exception& e) {
         HandleError(std::string("Parser exception: ") + e.what());
         result.success = false;
         result.error_message = e.what();
     }
     
+    // success表示没有出错；请求是否完整看state是否为COMPLETE
+    total_bytes_parsed_ += pos;
+    result.state = state_;
+    result.bytes_parsed = pos;
+    result.paused = paused_;
     return result;
 }
-// ... existing code ...
 ParseResult HttpParser::ParseStartLine(const char* data, size_t len, size_t& pos) {
-    // 查找请求行结束标记（CRLF）
-    size_t line_end = FindCRLF(data, len, pos);
-    if (line_end == std::string::npos) {
-        ParseResult result;
-        result.success = true;
-        result.state = state_;
-        result.bytes_parsed = total_bytes_parsed_;
-        result.error_message = "";
+    ParseResult result;
+    result.success = true;
+    result.state = state_;
+    result.bytes_parsed = total_bytes_parsed_;
+
+    // 查找请求行结束标记（CRLF），同时检查非法字符
+    HttpScanner::Line line = HttpScanner::ScanLine(data, len, pos);
+    if (line.end == HttpScanner::npos) {
         return result; // 需要更多数据
     }
-    
-    // 提取整行数据
-    std::string line(data + pos, line_end - pos);
-    pos = line_end + 2; // 跳过CRLF
-    
+    std::string_view text(data + pos, line.end - pos);
+    pos = line.end + 2; // 跳过CRLF
+
     // 解析请求行：方法、路径、版本
-    std::istringstream iss(line);
-    std::string method, path, version;
-    
-    if (!(iss >> method >> path >> version)) {
+    HttpRequest::Method method;
+    HttpRequest::Version version;
+    std::string_view target;
+    if (line.invalid || !ParseRequestLine(text, method, version, target)) {
         HandleError("Malformed request line");
-        ParseResult result;
         result.success = false;
         result.state = state_;
-        result.bytes_parsed = total_bytes_parsed_;
         result.error_message = "Invalid request line format";
         return result;
     }
-    
-    // 验证HTTP方法和版本
-    if (!ValidateHttpMethod(method)) {
-        HandleError("Unsupported HTTP method: " + method);
-        ParseResult result;
-        result.success = false;
-        result.state = state_;
-        result.bytes_parsed = total_bytes_parsed_;
-        result.error_message = "Unsupported HTTP method";
-        return result;
-    }
-    
-    if (!ValidateHttpVersion(version)) {
-        HandleError("Unsupported HTTP version: " + version);
-        ParseResult result;
-        result.success = false;
-        result.state = state_;
-        result.bytes_parsed = total_bytes_parsed_;
-        result.error_message = "Unsupported HTTP version";
-        return result;
-    }
-    
+
     // 设置请求对象
-    request_->SetMethod(StringToMethod(method));
-    request_->SetPath(path);
-    request_->SetVersion(StringToVersion(version));
-    
+    request_->SetMethod(method);
+    request_->SetPath(target);
+    request_->SetVersion(version);
+
     // 转换到头部解析状态
     TransitionTo(ParseState::HEADERS);
-    
-    ParseResult result;
-    result.success = true;
     result.state = state_;
-    result.bytes_parsed = total_bytes_parsed_;
-    result.error_message = "";
     return result;
 }
 
@@ -162,33 +160,32 @@ ParseResult HttpParser::ParseHeaders(const char* data, size_t len, size_t& pos)
     result.error_message = "";
     
     while (pos < len) {
-        // 查找行结束标记
-        size_t line_end = FindCRLF(data, len, pos);
-        if (line_end == std::string::npos) {
+        // 一次扫描得到行尾、冒号位置并检查非法字符
+        HttpScanner::Line line = HttpScanner::ScanLine(data, len, pos);
+        if (line.end == HttpScanner::npos) {
             return result; // 需要更多数据
         }
+        size_t line_end = line.end;
         
         // 空行表示头部结束
         if (line_end == pos) {
             pos = line_end + 2; // 跳过空行的CRLF
             
-            // 检查是否需要解析正文
-            std::string content_length = request_->GetHeader("Content-Length");
-            std::string transfer_encoding = request_->GetHeader("Transfer-Encoding");
-            
-            if (!content_length.empty()) {
-                try {
-                    content_length_ = std::stoul(content_length);
-                    TransitionTo(ParseState::BODY);
-                } catch (const std::exception&) {
-                    HandleError("Invalid Content-Length header");
-                    result.success = false;
-                    result.error_message = "Invalid Content-Length";
-                    return result;
+            // 正文长度的判定须与ParseView一致，否则keep-alive/流水线下两种模式对请求边界的理解不同
+            if (has_transfer_encoding_ && has_content_length_) {
+                return HeaderError(result, "Both Transfer-Encoding and Content-Length");
+            }
+            if (has_transfer_encoding_) {
+                if (!chunked_encoding_) {
+                    return HeaderError(result, "Unsupported Transfer-Encoding");
                 }
-            } else if (transfer_encoding == "chunked") {
-                chunked_encoding_ = true;
+                StartBody();
                 TransitionTo(ParseState::CHUNKED_BODY);
+            } else if (content_length_ > max_body_size_) {
+                return PayloadTooLarge();
+            } else if (content_length_ > 0) {
+                StartBody();
+                TransitionTo(ParseState::BODY);
             } else {
                 // 无正文，解析完成
                 TransitionTo(ParseState::COMPLETE);
@@ -197,12 +194,14 @@ ParseResult HttpParser::ParseHeaders(const char* data, size_t len, size_t& pos)
         }
         
         // 解析单个头部字段
-        std::string line(data + pos, line_end - pos);
+        std::string_view text(data + pos, line_end - pos);
+        size_t colon = line.colon == HttpScanner::npos ? HttpScanner::npos : line.colon - pos;
         pos = line_end + 2;
         
-        size_t colon_pos = line.find(':');
-        if (colon_pos == std::string::npos) {
-            HandleError("Malformed header: " + line);
+        std::string_view name;
+        std::string_view value;
+        if (line.invalid || !SplitHeaderLine(text, colon, name, value)) {
+            HandleError("Malformed header: " + std::string(text));
             result.success = false;
             result.state = state_;
             result.bytes_parsed = total_bytes_parsed_;
@@ -210,21 +209,37 @@ ParseResult HttpParser::ParseHeaders(const char* data, size_t len, size_t& pos)
             return result;
         }
         
-        std::string name = line.substr(0, colon_pos);
-        std::string value = line.substr(colon_pos + 1);
-        
-        // 去除首尾空白字符
-        name.erase(0, name.find_first_not_of(" \t"));
-        name.erase(name.find_last_not_of(" \t") + 1);
-        value.erase(0, value.find_first_not_of(" \t"));
-        value.erase(value.find_last_not_of(" \t") + 1);
-        
+        HeaderId id = LookupHeader(name);
+        if (id == HeaderId::CONTENT_LENGTH) {
+            size_t length = 0;
+            if (!ParseContentLength(value, length) || (has_content_length_ && length != content_length_)) {
+                return HeaderError(result, "Invalid Content-Length");
+            }
+            content_length_ = length;
+            has_content_length_ = true;
+        } else if (id == HeaderId::TRANSFER_ENCODING) {
+            // 只支持单独的chunked；重复的Transfer-Encoding相当于编码列表，同样拒绝
+            if (has_transfer_encoding_) {
+                return HeaderError(result, "Unsupported Transfer-Encoding");
+            }
+            has_transfer_encoding_ = true;
+            chunked_encoding_ = EqualsIgnoreCase(value, "chunked");
+        }
         request_->AddHeader(name, value);
     }
     
     return result;
 }
 
+ParseResult HttpParser::HeaderError(ParseResult& result, const char* message) {
+    HandleError(message);
+    result.success = false;
+    result.state = state_;
+    result.bytes_parsed = total_bytes_parsed_;
+    result.error_message = message;
+    return result;
+}
+
 ParseResult HttpParser::ParseBody(const char* data, size_t len, size_t& pos) {
     ParseResult result;
     result.success = true;
@@ -233,17 +248,17 @@ ParseResult HttpParser::ParseBody(const char* data, size_t len, size_t& pos) {
     result.error_message = "";
     
     size_t bytes_remaining = len - pos;
-    size_t bytes_needed = content_length_ - request_->GetBody().size();
+    size_t bytes_needed = content_length_ - body_received_;
     
     if (bytes_remaining >= bytes_needed) {
         // 有足够数据完成正文解析
-        request_->AppendBody(data + pos, bytes_needed);
         pos += bytes_needed;
         TransitionTo(ParseState::COMPLETE);
+        DeliverBody(data + pos - bytes_needed, bytes_needed, true);
     } else {
         // 需要更多数据
-        request_->AppendBody(data + pos, bytes_remaining);
         pos += bytes_remaining;
+        DeliverBody(data + pos - bytes_remaining, bytes_remaining, false);
     }
     
     return result;
@@ -257,51 +272,77 @@ ParseResult HttpParser::ParseChunkedBody(const char* data, size_t len, size_t& p
     result.error_message = "";
     
     while (pos < len) {
-        if (!chunk_size_parsed_) {
+        if (chunk_trailers_) {
+            // 0长度分块之后是可选的尾部字段，以空行结束
+            size_t line_end = FindCRLF(data, len, pos);
+            if (line_end == std::string::npos) {
+                return result; // 需要更多数据
+            }
+            bool empty_line = (line_end == pos);
+            pos = line_end + 2;
+            if (empty_line) {
+                TransitionTo(ParseState::COMPLETE);
+                DeliverBody(data + pos, 0, true);
+                break;
+            }
+        } else if (!chunk_size_parsed_) {
             // 解析分块大小行
             size_t line_end = FindCRLF(data, len, pos);
             if (line_end == std::string::npos) {
                 return result; // 需要更多数据
             }
             
-            std::string chunk_size_line(data + pos, line_end - pos);
+            std::string_view chunk_size_line(data + pos, line_end - pos);
             pos = line_end + 2;
             
-            // 解析分块大小（十六进制）
-            try {
-                current_chunk_size_ = std::stoul(chunk_size_line, nullptr, 16);
-                chunk_size_parsed_ = true;
-                
-                // 分块大小为0表示正文结束
-                if (current_chunk_size_ == 0) {
-                    TransitionTo(ParseState::COMPLETE);
-                    break;
-                }
-            } catch (const std::exception&) {
-                HandleError("Invalid chunk size: " + chunk_size_line);
+            // 解析分块大小（十六进制，忽略其后的分块扩展）
+            auto [end, ec] = std::from_chars(chunk_size_line.data(),
+                                             chunk_size_line.data() + chunk_size_line.size(),
+                                             current_chunk_size_, 16);
+            (void)end;
+            if (ec != std::errc()) {
+                HandleError("Invalid chunk size: " + std::string(chunk_size_line));
                 result.success = false;
                 result.state = state_;
                 result.bytes_parsed = total_bytes_parsed_;
                 result.error_message = "Invalid chunk size";
                 return result;
             }
+            chunk_size_parsed_ = true;
+            if (current_chunk_size_ > max_body_size_ - body_received_) {
+                return PayloadTooLarge();
+            }
+            
+            // 分块大小为0表示正文结束
+            if (current_chunk_size_ == 0) {
+                chunk_trailers_ = true;
+            }
         } else {
             // 解析分块数据
             size_t bytes_available = len - pos;
             size_t bytes_to_read = std::min(current_chunk_size_, bytes_available);
             
-            request_->AppendBody(data + pos, bytes_to_read);
+            bool more = bytes_to_read == 0 || DeliverBody(data + pos, bytes_to_read, false);
             pos += bytes_to_read;
             current_chunk_size_ -= bytes_to_read;
+            if (!more) {
+                return result;   // 消费方要求暂停，分块尾部的CRLF留到恢复后处理
+            }
             
-            // 当前分块读取完成
+            // 当前分块读取完成，分块后的CRLF到齐才算消费完
             if (current_chunk_size_ == 0) {
-                chunk_size_parsed_ = false;
-                
-                // 跳过分块结束的CRLF
-                if (pos + 2 <= len && data[pos] == '\r' && data[pos + 1] == '\n') {
-                    pos += 2;
+                if (pos + 2 > len) {
+                    return result; // 需要更多数据
+                }
+                if (data[pos] != '\r' || data[pos + 1] != '\n') {
+                    HandleError("Missing CRLF after chunk data");
+                    result.success = false;
+                    result.state = state_;
+                    result.error_message = "Invalid chunk terminator";
+                    return result;
                 }
+                pos += 2;
+                chunk_size_parsed_ = false;
             }
         }
     }
@@ -309,32 +350,171 @@ ParseResult HttpParser::ParseChunkedBody(const char* data, size_t len, size_t& p
     return result;
 }
 
-// 添加缺失的辅助函数实现
-size_t HttpParser::FindCRLF(const char* data, size_t len, size_t start_pos) const {
-    for (size_t i = start_pos; i + 1 < len; ++i) {
-        if (data[i] == '\r' && data[i + 1] == '\n') {
-            return i;
+ParseResult HttpParser::ParseView(const char* data, size_t len, HttpRequestView& view) {
+    ParseResult result;
+    result.success = true;
+    result.state = ParseState::HEADERS;   // 默认：需要更多数据
+
+    // 上次头部已到齐、正文没有到齐：正文到齐前不重解析头部
+    if (view_needed_ > 0) {
+        if (len < view_needed_) {
+            result.state = ParseState::BODY;
+            return result;
+        }
+        view_needed_ = 0;
+    } else if (view_scanned_ > 0) {
+        // 上次头部没有到齐：先确认结束标记已经到达，避免逐段到达时反复重解析
+        size_t start = view_scanned_ > 3 ? view_scanned_ - 3 : 0;
+        if (HttpScanner::FindHeaderEnd(data, len, start) == HttpScanner::npos) {
+            view_scanned_ = len;
+            return result;
         }
     }
-    return std::string::npos;
+
+    auto fail = [&](const char* message) {
+        HandleError(message);
+        view.Clear();
+        view_scanned_ = 0;
+        view_needed_ = 0;
+        result.success = false;
+        result.state = ParseState::ERROR;
+        result.error_message = message;
+        return result;
+    };
+    // 头部不完整：记录已扫描的长度，下次只检查新到的数据
+    auto need_more = [&](ParseState state) {
+        view.Clear();
+        view_scanned_ = len;
+        result.state = state;
+        return result;
+    };
+    auto fallback = [&]() {
+        view.Clear();
+        view_scanned_ = 0;
+        result.fallback = true;
+        return result;
+    };
+
+    view.Clear();
+    HttpScanner::Line line = HttpScanner::ScanLine(data, len, 0);
+    if (line.end == HttpScanner::npos) {
+        return need_more(ParseState::START_LINE);
+    }
+    if (line.invalid ||
+        !ParseRequestLine(std::string_view(data, line.end), view.method_, view.version_, view.target_)) {
+        return fail("Invalid request line format");
+    }
+    view.method_string_ = std::string_view(data, view.target_.data() - data - 1);
+
+    size_t content_length = 0;
+    bool has_content_length = false;
+    size_t pos = line.end + 2;
+    while (true) {
+        // 每行一次扫描：行尾、冒号和非法字符
+        line = HttpScanner::ScanLine(data, len, pos);
+        if (line.end == HttpScanner::npos) {
+            return need_more(ParseState::HEADERS);
+        }
+        if (line.invalid) {
+            return fail("Invalid header format");
+        }
+        if (line.end == pos) {
+            pos += 2;   // 空行：头部结束
+            break;
+        }
+
+        std::string_view text(data + pos, line.end - pos);
+        std::string_view name;
+        std::string_view value;
+        if (line.colon == HttpScanner::npos || !SplitHeaderLine(text, line.colon - pos, name, value)) {
+            return fail("Invalid header format");
+        }
+        pos = line.end + 2;
+
+        HeaderId id = LookupHeader(name);
+        if (id == HeaderId::CONTENT_LENGTH) {
+            size_t length = 0;
+            if (!ParseContentLength(value, length) || (has_content_length && length != content_length)) {
+                return fail("Invalid Content-Length");
+            }
+            content_length = length;
+            has_content_length = true;
+        } else if (id == HeaderId::TRANSFER_ENCODING) {
+            return fallback();   // 分块正文需要解码，无法原地引用
+        }
+        if (!view.AddHeader(id, name, value)) {
+            return fallback();
+        }
+    }
+
+    if (content_length > max_body_size_) {
+        result.payload_too_large = true;
+        return fail("Payload too large");
+    }
+    if (content_length > 0 && (content_length > body_memory_limit_ || body_stream_factory_)) {
+        return fallback();   // 大正文或需要分段回调：由Parse边到达边交付，不等整个正文进入读缓冲区
+    }
+    if (len - pos < content_length) {
+        // 头部已完整：结束标记已在已扫描范围之前，不能再走上面的头部检查，改为记录请求的总长度
+        view.Clear();
+        view_scanned_ = 0;
+        view_needed_ = pos + content_length;
+        result.state = ParseState::BODY;
+        return result;
+    }
+    view.body_ = std::string_view(data + pos, content_length);
+
+    view_scanned_ = 0;
+    result.state = ParseState::COMPLETE;
+    result.bytes_parsed = pos + content_length;
+    return result;
+}
+
+bool HttpParser::ParseRequestLine(std::string_view line, HttpRequest::Method& method,
+                                  HttpRequest::Version& version, std::string_view& target) const {
+    // 方法 SP 请求目标 SP 版本
+    size_t first = line.find(' ');
+    if (first == std::string_view::npos) {
+        return false;
+    }
+    size_t second = line.find(' ', first + 1);
+    if (second == std::string_view::npos || second == first + 1) {
+        return false;
+    }
+    std::string_view method_text = line.substr(0, first);
+    std::string_view version_text = line.substr(second + 1);
+    target = line.substr(first + 1, second - first - 1);
+
+    method = HttpRequest::ParseMethod(method_text);
+    version = HttpRequest::ParseVersion(version_text);
+    return method != HttpRequest::Method::UNKNOWN && version != HttpRequest::Version::UNKNOWN;
+}
+
+bool HttpParser::SplitHeaderLine(std::string_view line, size_t colon,
+                                 std::string_view& name, std::string_view& value) const {
+    if (colon == 0 || colon >= line.size()) {
+        return false;
+    }
+    name = line.substr(0, colon);
+    // 字段名内不允许空白（也拒绝以空白开头的折行）
+    if (name.find_first_of(" \t") != std::string_view::npos) {
+        return false;
+    }
+    value = TrimWhitespace(line.substr(colon + 1));
+    return true;
+}
+
+// 添加缺失的辅助函数实现
+size_t HttpParser::FindCRLF(const char* data, size_t len, size_t start_pos) const {
+    return HttpScanner::FindLineEnd(data, len, start_pos);
 }
 
 bool HttpParser::ValidateHttpMethod(const std::string& method) const {
-    // 检查是否为有效的HTTP方法
-    static const std::unordered_set<std::string> valid_methods = {
-        "GET", "POST", "PUT", "DELETE", "HEAD", "OPTIONS", "PATCH", "TRACE", "CONNECT"
-    };
-    
-    return valid_methods.find(method) != valid_methods.end();
+    return HttpRequest::ParseMethod(method) != HttpRequest::Method::UNKNOWN;
 }
 
 bool HttpParser::ValidateHttpVersion(const std::string& version) const {
-    // 检查是否为有效的HTTP版本
-    static const std::unordered_set<std::string> valid_versions = {
-        "HTTP/1.0", "HTTP/1.1", "HTTP/2.0"
-    };
-    
-    return valid_versions.find(version) != valid_versions.end();
+    return HttpRequest::ParseVersion(version) != HttpRequest::Version::UNKNOWN;
 }
 
 void HttpParser::TransitionTo(ParseState new_state) {
@@ -347,19 +527,80 @@ void HttpParser::HandleError(const std::string& message) {
     std::cerr << "HTTP Parser Error: " << message << std::endl;
 }
 
-std::unique_ptr<HttpRequest> HttpParser::GetRequest() {
+HttpRequestPtr HttpParser::GetRequest() {
     return std::move(request_);
 }
 
+void HttpParser::SetArena(RequestArena* arena) {
+    arena_ = arena;
+}
+
 void HttpParser::Reset() {
     state_ = ParseState::START_LINE;
     content_length_ = 0;
     chunked_encoding_ = false;
-    buffer_.clear();
+    has_content_length_ = false;
+    has_transfer_encoding_ = false;
     total_bytes_parsed_ = 0;
     current_chunk_size_ = 0;
     chunk_size_parsed_ = false;
-    request_ = std::make_unique<HttpRequest>();
+    chunk_trailers_ = false;
+    view_scanned_ = 0;
+    view_needed_ = 0;
+    body_stream_ = nullptr;
+    body_received_ = 0;
+    paused_ = false;
+    // 下一个请求开始解析时再创建请求对象，空闲时不占用arena
+    request_.reset();
+}
+
+void HttpParser::SetBodyLimits(size_t memory_limit, size_t max_body_size) {
+    body_memory_limit_ = memory_limit;
+    max_body_size_ = max_body_size;
+}
+
+void HttpParser::SetBodyStreamFactory(BodyStreamFactory factory) {
+    body_stream_factory_ = std::move(factory);
+}
+
+void HttpParser::StartBody() {
+    body_received_ = 0;
+    if (body_stream_factory_) {
+        body_stream_ = body_stream_factory_(*request_);
+    }
+    if (body_stream_) {
+        request_->SetBodyStreamed(true);
+        return;
+    }
+    request_->SetBodyMemoryLimit(body_memory_limit_);
+    if (!chunked_encoding_) {
+        // 正文一次预留到位（不超过内存上限），单调内存区中逐次扩容的旧缓冲无法回收
+        request_->ReserveBody(content_length_);
+    }
+}
+
+bool HttpParser::DeliverBody(const char* data, size_t length, bool last) {
+    body_received_ += length;
+    if (!body_stream_) {
+        request_->AppendBody(data, length);
+        return true;
+    }
+    if (!body_stream_(std::string_view(data, length), last)) {
+        paused_ = true;
+        return false;
+    }
+    return true;
+}
+
+ParseResult HttpParser::PayloadTooLarge() {
+    HandleError("Request body too large");
+    ParseResult result;
+    result.success = false;
+    result.state = state_;
+    result.bytes_parsed = total_bytes_parsed_;
+    result.error_message = "Payload too large";
+    result.payload_too_large = true;
+    return result;
 }
 
 bool HttpParser::IsParsing() const {
@@ -4,8 +4,8 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
-#include<unordered_set>
 #include "http_request.hpp"
+#include "http_request_view.hpp"
 
 namespace ppserver {
 
@@ -23,15 +23,24 @@ enum class ParseState {
 struct ParseResult {
     bool success;                    // 解析是否成功
     ParseState state;               // 当前解析状态
-    size_t bytes_parsed;           // 已解析字节数
+    size_t bytes_parsed;           // 本次调用消费的字节数（调用方据此从读缓冲区移除）
     std::string error_message;     // 错误描述信息
+    bool fallback;                 // ParseView无法原地表示该请求（分块正文、头部过多、正文较大），需改用Parse
+    bool paused;                   // 正文回调要求暂停：调用方停止读取socket，恢复后再继续传入数据
+    bool payload_too_large;        // 出错原因是正文超过上限（应回复413）
     
-    ParseResult() : success(false), state(ParseState::START_LINE), bytes_parsed(0) {}
+    ParseResult() : success(false), state(ParseState::START_LINE), bytes_parsed(0), fallback(false),
+                    paused(false), payload_too_large(false) {}
 };
 
 
+// 请求头部解析完、正文开始前调用：返回非空回调时正文分段交给该回调，不保存在请求对象中
+using BodyStreamFactory = std::function<BodyChunkCallback(const HttpRequest& request)>;
+
 class HttpParser {
 public:
+    static constexpr size_t kDefaultMaxBodySize = 1024ull * 1024 * 1024;
+
     HttpParser();
     ~HttpParser() = default;
 
@@ -40,8 +49,22 @@ public:
     HttpParser& operator=(const HttpParser&) = delete;
     HttpParser(HttpParser&&) = delete;
     HttpParser& operator=(HttpParser&&) = delete;
+    // 在调用方的缓冲区上原地解析，不保存数据：不完整的行不消费，
+    // 调用方保留未消费部分，下次连同新数据一起传入。解析完一个请求即停止（支持流水线）
     ParseResult Parse(const char* data, size_t len);
-    std::unique_ptr<HttpRequest> GetRequest();
+    HttpRequestPtr GetRequest();
+
+    // 之后开始解析的请求在arena中创建（为nullptr时用全局堆）；arena须比解析器产生的请求活得长
+    void SetArena(RequestArena* arena);
+
+    // 正文在内存中保留的上限（其余溢出到临时文件）与正文总长度上限（超出时解析失败，payload_too_large）
+    void SetBodyLimits(size_t memory_limit, size_t max_body_size);
+    void SetBodyStreamFactory(BodyStreamFactory factory);
+
+    // 零拷贝模式：头部（及定长正文）完整到达后一次解析，view引用data中的请求行、头部和正文，
+    // 不分配内存。完成时state为COMPLETE、bytes_parsed为整个请求的长度，调用方须在请求处理完后
+    // 才消费这段数据；未完整时不消费任何字节。不改变Parse的状态，fallback时调用方改用Parse
+    ParseResult ParseView(const char* data, size_t len, HttpRequestView& view);
     
   
     void Reset();
@@ -61,24 +84,47 @@ private:
     // 辅助方法
     bool CheckComplete() const;
     size_t FindCRLF(const char* data, size_t len, size_t start_pos) const;
+    bool ParseRequestLine(std::string_view line, HttpRequest::Method& method,
+                          HttpRequest::Version& version, std::string_view& target) const;
+    // 按冒号位置切分头部行并去掉值两端空白，字段名不合法时返回false
+    bool SplitHeaderLine(std::string_view line, size_t colon,
+                         std::string_view& name, std::string_view& value) const;
     bool ValidateHttpVersion(const std::string& version) const;
     bool ValidateHttpMethod(const std::string& method) const;
     
+    // 正文开始时选择保存或分段回调；交付一段正文，回调要求暂停时返回false
+    void StartBody();
+    bool DeliverBody(const char* data, size_t length, bool last);
+    ParseResult PayloadTooLarge();
+    // 头部不合法（含正文长度无法确定）：记录错误并返回失败结果
+    ParseResult HeaderError(ParseResult& result, const char* message);
+
     // 状态转换处理
     void TransitionTo(ParseState new_state);
     void HandleError(const std::string& message);
     
     // 成员变量
     ParseState state_;                      // 当前解析状态
-    std::unique_ptr<HttpRequest> request_;  // 正在构建的请求对象
+    RequestArena* arena_;                   // 请求对象的内存来源
+    HttpRequestPtr request_;                // 正在构建的请求对象，开始解析时才创建
     size_t content_length_;                 // 内容长度（用于定长正文）
     bool chunked_encoding_;                 // 是否分块传输编码
-    std::string buffer_;                    // 临时缓冲区（用于跨数据包解析）
+    bool has_content_length_;               // 已读到Content-Length（重复时值须相同）
+    bool has_transfer_encoding_;            // 已读到Transfer-Encoding（与Content-Length同时出现时拒绝）
+    size_t body_memory_limit_;              // 正文内存部分上限
+    size_t max_body_size_;                  // 正文总长度上限
+    BodyStreamFactory body_stream_factory_;
+    BodyChunkCallback body_stream_;         // 当前请求的正文回调，为空时正文保存到请求对象
+    size_t body_received_;                  // 当前请求已收到的正文字节数
+    bool paused_;                           // 本次Parse中正文回调要求暂停
     
     // 解析统计
     size_t total_bytes_parsed_;             // 总解析字节数
     size_t current_chunk_size_;              // 当前分块大小
     bool chunk_size_parsed_;                // 分块大小是否已解析
+    bool chunk_trailers_;                   // 已读到0长度分块，正在跳过尾部字段
+    size_t view_scanned_;                   // ParseView上次头部不完整时已扫描的长度，之后先确认头部到齐再解析
+    size_t view_needed_;                    // ParseView上次头部完整、正文不完整时整个请求的长度，到齐前不重解析
 };
 
 } // namespace ppsever
\ No newline at end of file
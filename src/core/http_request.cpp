@@ -33,21 +33,77 @@ HttpRequest::VERSION_STRINGS = {
     {Version::UNKNOWN, "UNKNOWN"}
 };
 
+namespace {
+
+// 顺序须与下面的枚举数组一致
+constexpr std::array<std::string_view, 9> kMethodNames = {
+    "GET", "POST", "PUT", "DELETE", "HEAD", "OPTIONS", "PATCH", "TRACE", "CONNECT"
+};
+constexpr std::array<HttpRequest::Method, 9> kMethods = {
+    HttpRequest::Method::GET, HttpRequest::Method::POST, HttpRequest::Method::PUT,
+    HttpRequest::Method::DELETE, HttpRequest::Method::HEAD, HttpRequest::Method::OPTIONS,
+    HttpRequest::Method::PATCH, HttpRequest::Method::TRACE, HttpRequest::Method::CONNECT
+};
+constexpr PerfectHashTable<9, 32> kMethodTable(kMethodNames, false);
+static_assert(kMethodTable.Valid(), "no collision-free seed for methods");
+
+constexpr std::array<std::string_view, 3> kVersionNames = {"HTTP/1.0", "HTTP/1.1", "HTTP/2.0"};
+constexpr std::array<HttpRequest::Version, 3> kVersions = {
+    HttpRequest::Version::HTTP_1_0, HttpRequest::Version::HTTP_1_1, HttpRequest::Version::HTTP_2_0
+};
+constexpr PerfectHashTable<3, 8> kVersionTable(kVersionNames, false);
+static_assert(kVersionTable.Valid(), "no collision-free seed for versions");
+
+} // namespace
+
 // 构造函数
-HttpRequest::HttpRequest() 
+HttpRequest::HttpRequest(std::pmr::memory_resource* resource)
     : method_(Method::UNKNOWN),
+      path_(resource),
       version_(Version::UNKNOWN),
+      query_string_(resource),
+      headers_(resource),
+      body_(resource),
+      body_streamed_(false),
+      query_params_(resource),
       query_parsed_(false),
       receive_time_(0),
       request_id_(0) {
 }
 
+HttpRequestPtr HttpRequest::Create(RequestArena* arena) {
+    HttpRequestPool& pool = HttpRequestPool::Instance();
+    if (!arena) {
+        return HttpRequestPtr(pool.Construct());
+    }
+    HttpRequest* request = pool.Construct(arena->Resource());
+    arena->Hold();
+    return HttpRequestPtr(request, HttpRequestDeleter{arena});
+}
+
+void HttpRequestDeleter::operator()(HttpRequest* request) const {
+    HttpRequestPool::Instance().Destroy(request);
+    if (arena) {
+        arena->Release();
+    }
+}
+
+HttpRequest::Method HttpRequest::ParseMethod(std::string_view method) {
+    size_t index = kMethodTable.Find(method);
+    return index == kMethodTable.kNotFound ? Method::UNKNOWN : kMethods[index];
+}
+
+HttpRequest::Version HttpRequest::ParseVersion(std::string_view version) {
+    size_t index = kVersionTable.Find(version);
+    return index == kVersionTable.kNotFound ? Version::UNKNOWN : kVersions[index];
+}
+
 // 请求行设置接口实现
 void HttpRequest::SetMethod(Method method) {
     method_ = method;
 }
 
-void HttpRequest::SetPath(const std::string& path) {
+void HttpRequest::SetPath(std::string_view path) {
     path_ = path;
     query_parsed_ = false; // 路径改变时需要重新解析查询参数
 }
@@ -56,51 +112,51 @@ void HttpRequest::SetVersion(Version version) {
     version_ = version;
 }
 
-void HttpRequest::SetQueryString(const std::string& query) {
+void HttpRequest::SetQueryString(std::string_view query) {
     query_string_ = query;
     query_parsed_ = false; // 设置新的查询字符串需要重新解析
 }
 
 // 头部字段管理实现
-void HttpRequest::AddHeader(const std::string& name, const std::string& value) {
-    headers_[name] = value;
-    headers_lowercase_[ToLower(name)] = value;
+void HttpRequest::AddHeader(std::string_view name, std::string_view value) {
+    headers_.Set(name, value);
 }
 
-void HttpRequest::SetHeaders(std::unordered_map<std::string, std::string> headers) {
+void HttpRequest::SetHeaders(HttpHeaders headers) {
     headers_ = std::move(headers);
-    headers_lowercase_.clear();
-    for (const auto& [name, value] : headers_) {
-        headers_lowercase_[ToLower(name)] = value;
-    }
 }
 
-bool HttpRequest::RemoveHeader(const std::string& name) {
-    auto it = headers_.find(name);
-    if (it != headers_.end()) {
-        headers_lowercase_.erase(ToLower(name));
-        headers_.erase(it);
-        return true;
-    }
-    return false;
+bool HttpRequest::RemoveHeader(std::string_view name) {
+    return headers_.Remove(name);
 }
 
 void HttpRequest::ClearHeaders() {
-    headers_.clear();
-    headers_lowercase_.clear();
+    headers_.Clear();
 }
 
 // 消息体管理实现
-void HttpRequest::SetBody(const std::string& body) {
-    body_ = body;
+void HttpRequest::SetBody(std::string_view body) {
+    body_.Assign(body);
 }
 
 void HttpRequest::AppendBody(const char* data, size_t length) {
-    body_.append(data, length);
+    body_.Append(data, length);
+}
+
+void HttpRequest::ReserveBody(size_t length) {
+    body_.Reserve(length);
+}
+
+void HttpRequest::SetBodyMemoryLimit(size_t limit) {
+    body_.SetMemoryLimit(limit);
 }
 
 void HttpRequest::ClearBody() {
-    body_.clear();
+    body_.Clear();
+}
+
+void HttpRequest::SetBodyStreamed(bool streamed) {
+    body_streamed_ = streamed;
 }
 
 // 查询参数管理实现
@@ -114,8 +170,8 @@ void HttpRequest::ParseQueryParameters() {
     query_parsed_ = true;
 }
 
-void HttpRequest::AddQueryParameter(const std::string& key, const std::string& value) {
-    query_params_[key] = value;
+void HttpRequest::AddQueryParameter(std::string_view key, std::string_view value) {
+    query_params_[std::pmr::string(key, query_params_.get_allocator())] = value;
 }
 
 // 元数据设置实现
@@ -141,7 +197,7 @@ const std::string& HttpRequest::GetMethodString() const {
     return it != METHOD_STRINGS.end() ? it->second : EMPTY_STRING;
 }
 
-const std::string& HttpRequest::GetPath() const {
+std::string_view HttpRequest::GetPath() const {
     return path_;
 }
 
@@ -154,36 +210,46 @@ const std::string& HttpRequest::GetVersionString() const {
     return it != VERSION_STRINGS.end() ? it->second : EMPTY_STRING;
 }
 
-const std::string& HttpRequest::GetQueryString() const {
+std::string_view HttpRequest::GetQueryString() const {
     return query_string_;
 }
 
 // 头部字段访问实现
-const std::string& HttpRequest::GetHeader(const std::string& name) const {
-    auto it = headers_lowercase_.find(ToLower(name));// 使用lowercase
-    //
-    return it != headers_lowercase_.end() ? it->second : EMPTY_STRING;
+std::string_view HttpRequest::GetHeader(std::string_view name) const {
+    return headers_.Get(name);
 }
 
-const std::unordered_map<std::string, std::string>& 
-HttpRequest::GetAllHeaders() const {
+const HttpHeaders& HttpRequest::GetAllHeaders() const {
     return headers_;
 }
 
-bool HttpRequest::HasHeader(const std::string& name) const {
-    return headers_lowercase_.find(ToLower(name)) != headers_lowercase_.end();
+bool HttpRequest::HasHeader(std::string_view name) const {
+    return headers_.Has(name);
+}
+
+std::string_view HttpRequest::GetHeader(HeaderId id) const {
+    return headers_.Get(id);
+}
+
+bool HttpRequest::HasHeader(HeaderId id) const {
+    return headers_.Has(id);
 }
 
 std::vector<std::string> HttpRequest::GetHeaderNames() const {
     std::vector<std::string> names;
+    names.reserve(headers_.size());
     for (const auto& [name, value] : headers_) {
-        names.push_back(name);
+        names.emplace_back(name);
     }
     return names;
 }
 
 // 消息体访问实现
-const std::string& HttpRequest::GetBody() const {
+std::string_view HttpRequest::GetBody() const {
+    return body_.GetMemoryPart();
+}
+
+const RequestBody& HttpRequest::GetBodySource() const {
     return body_;
 }
 
@@ -195,25 +261,32 @@ bool HttpRequest::IsBodyEmpty() const {
     return body_.empty();
 }
 
+bool HttpRequest::IsBodySpilled() const {
+    return body_.IsSpilled();
+}
+
+bool HttpRequest::IsBodyStreamed() const {
+    return body_streamed_;
+}
+
 // 查询参数访问实现
-const std::string& HttpRequest::GetQueryParameter(const std::string& key) const {
-    auto it = query_params_.find(key);
-    return it != query_params_.end() ? it->second : EMPTY_STRING;
+std::string_view HttpRequest::GetQueryParameter(std::string_view key) const {
+    auto it = query_params_.find(std::pmr::string(key, query_params_.get_allocator()));
+    return it != query_params_.end() ? std::string_view(it->second) : std::string_view();
 }
 
-const std::unordered_map<std::string, std::string>& 
-HttpRequest::GetAllQueryParameters() const {
+const HttpRequest::QueryMap& HttpRequest::GetAllQueryParameters() const {
     return query_params_;
 }
 
-bool HttpRequest::HasQueryParameter(const std::string& key) const {
-    return query_params_.find(key) != query_params_.end();
+bool HttpRequest::HasQueryParameter(std::string_view key) const {
+    return query_params_.find(std::pmr::string(key, query_params_.get_allocator())) != query_params_.end();
 }
 
 std::vector<std::string> HttpRequest::GetQueryParameterNames() const {
     std::vector<std::string> names;
     for (const auto& [key, value] : query_params_) {
-        names.push_back(key);
+        names.emplace_back(key);
     }
     return names;
 }
@@ -233,33 +306,29 @@ uint64_t HttpRequest::GetRequestId() const {
 
 // 内容类型辅助方法实现
 std::string HttpRequest::GetContentType() const {
-    std::string contentType = GetHeader("Content-Type");
-    size_t pos = contentType.find(';');
-    if (pos != std::string::npos) {
-        return contentType.substr(0, pos);
-    }
-    return contentType;
+    std::string_view contentType = GetHeader(HeaderId::CONTENT_TYPE);
+    return std::string(contentType.substr(0, contentType.find(';')));
 }
 
 std::string HttpRequest::GetCharset() const {
-    std::string contentType = GetHeader("Content-Type");
+    std::string_view contentType = GetHeader(HeaderId::CONTENT_TYPE);
     size_t pos = contentType.find("charset=");
-    if (pos != std::string::npos) {
+    if (pos != std::string_view::npos) {
         pos += 8; // "charset="长度
         size_t end = contentType.find(';', pos);
-        if (end == std::string::npos) {
+        if (end == std::string_view::npos) {
             end = contentType.length();
         }
-        return contentType.substr(pos, end - pos);
+        return std::string(contentType.substr(pos, end - pos));
     }
     return "utf-8"; // 默认字符集
 }
 
 size_t HttpRequest::GetContentLength() const {
-    auto contentLength = GetHeader("Content-Length");
+    std::string_view contentLength = GetHeader(HeaderId::CONTENT_LENGTH);
     if (!contentLength.empty()) {
         try {
-            return std::stoul(contentLength);
+            return std::stoul(std::string(contentLength));
         } catch (const std::exception&) {
             return 0;
         }
@@ -268,24 +337,27 @@ size_t HttpRequest::GetContentLength() const {
 }
 
 bool HttpRequest::IsKeepAlive() const {
-    if (version_ == Version::HTTP_1_1) {
-        std::string connection = GetHeader("Connection");
-        return connection != "close";
+    // Connection头是逗号分隔、大小写不敏感的token列表，如"Keep-Alive"、"keep-alive, Upgrade"
+    std::string_view connection = GetHeader(HeaderId::CONNECTION);
+    if (HasToken(connection, "close")) {
+        return false;
     }
-    std::string connection = GetHeader("Connection");
-    return connection == "keep-alive";
+    if (version_ == Version::HTTP_1_0) {
+        return HasToken(connection, "keep-alive");
+    }
+    return true;   // HTTP/1.1默认长连接
 }
 
 bool HttpRequest::IsChunked() const {
-    std::string encoding = GetHeader("Transfer-Encoding");
-    return encoding.find("chunked") != std::string::npos;
+    std::string_view encoding = GetHeader(HeaderId::TRANSFER_ENCODING);
+    return encoding.find("chunked") != std::string_view::npos;
 }
 
 // 路径处理辅助方法实现
 std::string HttpRequest::GetBasePath() const {
     size_t pos = path_.find_last_of('/');
     if (pos != std::string::npos) {
-        return path_.substr(0, pos + 1);
+        return std::string(std::string_view(path_).substr(0, pos + 1));
     }
     return "/";
 }
@@ -295,7 +367,7 @@ std::string HttpRequest::GetExtension() const {
     size_t slash_pos = path_.find_last_of('/');
     if (dot_pos != std::string::npos && 
         (slash_pos == std::string::npos || dot_pos > slash_pos)) {
-        return path_.substr(dot_pos + 1);
+        return std::string(std::string_view(path_).substr(dot_pos + 1));
     }
     return "";
 }
@@ -303,9 +375,9 @@ std::string HttpRequest::GetExtension() const {
 std::string HttpRequest::GetFilename() const {
     size_t slash_pos = path_.find_last_of('/');
     if (slash_pos != std::string::npos) {
-        return path_.substr(slash_pos + 1);
+        return std::string(std::string_view(path_).substr(slash_pos + 1));
     }
-    return path_;
+    return std::string(path_);
 }
 
 // 调试和序列化实现
@@ -323,7 +395,7 @@ std::string HttpRequest::ToString() const {
     
     ss << "\r\n";
     if (!body_.empty()) {
-        ss << body_;
+        ss << body_.ReadAll();
     }
     
     return ss.str();
@@ -356,29 +428,44 @@ bool HttpRequest::IsValid() const {
 }
 
 // 私有辅助方法实现
-std::string HttpRequest::ToLower(const std::string& str) const {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(),
-                  [](unsigned char c) { return std::tolower(c); });
-    return result;
+bool HttpRequest::HasToken(std::string_view list, const char* token) {
+    size_t token_len = std::char_traits<char>::length(token);
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string_view::npos) {
+            end = list.size();
+        }
+        size_t begin = pos;
+        while (begin < end && (list[begin] == ' ' || list[begin] == '\t')) ++begin;
+        size_t last = end;
+        while (last > begin && (list[last - 1] == ' ' || list[last - 1] == '\t')) --last;
+        if (last - begin == token_len &&
+            std::equal(list.begin() + begin, list.begin() + last, token,
+                       [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; })) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
 }
 
-void HttpRequest::ParseQueryString(const std::string& query) {
+void HttpRequest::ParseQueryString(std::string_view query) {
     size_t start = 0;
     while (start < query.length()) {
         size_t end = query.find('&', start);
-        if (end == std::string::npos) {
+        if (end == std::string_view::npos) {
             end = query.length();
         }
         
         size_t equal_pos = query.find('=', start);
-        if (equal_pos != std::string::npos && equal_pos < end) {
-            std::string key = query.substr(start, equal_pos - start);
-            std::string value = query.substr(equal_pos + 1, end - equal_pos - 1);
+        if (equal_pos != std::string_view::npos && equal_pos < end) {
+            std::string_view key = query.substr(start, equal_pos - start);
+            std::string_view value = query.substr(equal_pos + 1, end - equal_pos - 1);
             
             // URL解码（简化版）
             // 实际项目中应该实现完整的URL解码
-            query_params_[key] = value;
+            AddQueryParameter(key, value);
         }
         
         start = end + 1;
@@ -386,23 +473,11 @@ void HttpRequest::ParseQueryString(const std::string& query) {
 }
 
 bool HttpRequest::ValidateMethod(const std::string& method) const {
-    // 检查方法是否有效
-    for (const auto& [m, str] : METHOD_STRINGS) {
-        if (str == method) {
-            return true;
-        }
-    }
-    return false;
+    return ParseMethod(method) != Method::UNKNOWN;
 }
 
 bool HttpRequest::ValidateVersion(const std::string& version) const {
-    // 检查版本是否有效
-    for (const auto& [v, str] : VERSION_STRINGS) {
-        if (str == version) {
-            return true;
-        }
-    }
-    return false;
+    return ParseVersion(version) != Version::UNKNOWN;
 }
 
 // 实用函数实现
@@ -412,12 +487,7 @@ std::string MethodToString(HttpRequest::Method method) {
 }
 
 HttpRequest::Method StringToMethod(const std::string& str) {
-    for (const auto& [method, method_str] : HttpRequest::METHOD_STRINGS) {
-        if (method_str == str) {
-            return method;
-        }
-    }
-    return HttpRequest::Method::UNKNOWN;
+    return HttpRequest::ParseMethod(str);
 }
 
 std::string VersionToString(HttpRequest::Version version) {
@@ -426,12 +496,7 @@ std::string VersionToString(HttpRequest::Version version) {
 }
 
 HttpRequest::Version StringToVersion(const std::string& str) {
-    for (const auto& [version, version_str] : HttpRequest::VERSION_STRINGS) {
-        if (version_str == str) {
-            return version;
-        }
-    }
-    return HttpRequest::Version::UNKNOWN;
+    return HttpRequest::ParseVersion(str);
 }
 
 } // namespace ppsever
\ No newline at end of file
@@ -8,9 +8,26 @@
 #include <sstream>
 #include <algorithm>
 #include <utility>
+#include <string_view>
+#include <memory_resource>
+#include "http_headers.hpp"
+#include "memory_pool.hpp"
+#include "request_arena.hpp"
+#include "request_body.hpp"
 
 namespace ppserver {
 
+class HttpRequest;
+
+// 请求对象放回HttpRequestPool；数据在RequestArena中时只析构（随区一起归还），并通知区存活对象减少
+struct HttpRequestDeleter {
+    RequestArena* arena = nullptr;
+    void operator()(HttpRequest* request) const;
+};
+
+using HttpRequestPtr = std::unique_ptr<HttpRequest, HttpRequestDeleter>;
+using HttpRequestPool = MemoryPool<HttpRequest>;
+
 class HttpRequest {
 public:
     // HTTP方法枚举（支持RFC 7231定义的所有方法）
@@ -26,12 +43,21 @@ public:
     static const std::unordered_map<Method, std::string> METHOD_STRINGS;
     static const std::unordered_map<Version, std::string> VERSION_STRINGS;
 
+    // 方法/版本字符串到枚举（编译期完美哈希表，区分大小写），无法识别时返回UNKNOWN
+    static Method ParseMethod(std::string_view method);
+    static Version ParseVersion(std::string_view version);
+
     
     
-    // 构造函数与析构函数
-    HttpRequest();
+    using QueryMap = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
+
+    // 构造函数与析构函数；resource为路径、头部、正文、查询参数的内存来源
+    explicit HttpRequest(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~HttpRequest() = default;
 
+    // 创建请求对象：对象本身取自HttpRequestPool，给定arena时其数据分配在区内，否则在全局堆上
+    static HttpRequestPtr Create(RequestArena* arena = nullptr);
+
     // 禁止拷贝，允许移动
     HttpRequest(const HttpRequest&) = delete;
     HttpRequest& operator=(const HttpRequest&) = delete;
@@ -40,24 +66,29 @@ public:
 
     // 请求行设置接口
     void SetMethod(Method method);
-    void SetPath(const std::string& path);
+    void SetPath(std::string_view path);
     void SetVersion(Version version);
-    void SetQueryString(const std::string& query);
+    void SetQueryString(std::string_view query);
 
     // 头部字段管理
-    void AddHeader(const std::string& name, const std::string& value);
-    void SetHeaders(std::unordered_map<std::string, std::string> headers);
-    bool RemoveHeader(const std::string& name);
+    void AddHeader(std::string_view name, std::string_view value);
+    void SetHeaders(HttpHeaders headers);
+    bool RemoveHeader(std::string_view name);
     void ClearHeaders();
 
-    // 消息体管理
-    void SetBody(const std::string& body);
+    // 消息体管理（超出内存上限的部分写入临时文件，见RequestBody）
+    void SetBody(std::string_view body);
     void AppendBody(const char* data, size_t length);
+    // 已知正文长度时预留，避免单调内存区中逐次扩容留下废弃缓冲
+    void ReserveBody(size_t length);
+    void SetBodyMemoryLimit(size_t limit);
     void ClearBody();
+    // 正文已经以分段回调交给Handler，请求对象中不再保存
+    void SetBodyStreamed(bool streamed);
 
     // 查询参数管理（URL参数解析）
     void ParseQueryParameters();
-    void AddQueryParameter(const std::string& key, const std::string& value);
+    void AddQueryParameter(std::string_view key, std::string_view value);
 
     // 元数据设置
     void SetRemoteAddress(const std::string& address);
@@ -67,26 +98,32 @@ public:
     // 常量访问接口
     Method GetMethod() const;
     const std::string& GetMethodString() const;
-    const std::string& GetPath() const;
+    std::string_view GetPath() const;
     Version GetVersion() const;
     const std::string& GetVersionString() const;
-    const std::string& GetQueryString() const;
-
-    // 头部字段访问
-    const std::string& GetHeader(const std::string& name) const;
-    const std::unordered_map<std::string, std::string>& GetAllHeaders() const;
-    bool HasHeader(const std::string& name) const;
+    std::string_view GetQueryString() const;
+
+    // 头部字段访问（大小写不敏感，不存在时返回空视图；视图在请求对象存活且头部未修改期间有效）
+    std::string_view GetHeader(std::string_view name) const;
+    const HttpHeaders& GetAllHeaders() const;
+    bool HasHeader(std::string_view name) const;
+    // 常用头部按ID直接取，不做字符串哈希
+    std::string_view GetHeader(HeaderId id) const;
+    bool HasHeader(HeaderId id) const;
     std::vector<std::string> GetHeaderNames() const;
 
-    // 消息体访问
-    const std::string& GetBody() const;
+    // 消息体访问：GetBody只返回内存中的部分，正文溢出到临时文件时（IsBodySpilled）须经GetBodySource读取
+    std::string_view GetBody() const;
+    const RequestBody& GetBodySource() const;
     size_t GetBodySize() const;
     bool IsBodyEmpty() const;
+    bool IsBodySpilled() const;
+    bool IsBodyStreamed() const;
 
     // 查询参数访问
-    const std::string& GetQueryParameter(const std::string& key) const;
-    const std::unordered_map<std::string, std::string>& GetAllQueryParameters() const;
-    bool HasQueryParameter(const std::string& key) const;
+    std::string_view GetQueryParameter(std::string_view key) const;
+    const QueryMap& GetAllQueryParameters() const;
+    bool HasQueryParameter(std::string_view key) const;
     std::vector<std::string> GetQueryParameterNames() const;
 
     // 元数据访问
@@ -99,6 +136,8 @@ public:
     std::string GetCharset() const;
     size_t GetContentLength() const;
     bool IsKeepAlive() const;
+    // 逗号分隔、大小写不敏感的头部值（如Connection）中是否含有token（token须为小写）
+    static bool HasToken(std::string_view list, const char* token);
     bool IsChunked() const;
 
     // 路径处理辅助方法
@@ -117,19 +156,19 @@ public:
 private:
     // 请求行数据
     Method method_;
-    std::string path_;
+    std::pmr::string path_;
     Version version_;
-    std::string query_string_;
+    std::pmr::string query_string_;
 
-    // 头部字段（大小写不敏感，但保留原始大小写）
-    std::unordered_map<std::string, std::string> headers_;
-    std::unordered_map<std::string, std::string> headers_lowercase_; // 用于快速查找
+    // 头部字段（大小写不敏感，但保留原始大小写和到达顺序）
+    HttpHeaders headers_;
 
     // 消息体
-    std::string body_;
+    RequestBody body_;
+    bool body_streamed_;
 
     // 查询参数（URL参数）
-    std::unordered_map<std::string, std::string> query_params_;
+    QueryMap query_params_;
     bool query_parsed_;
 
     // 元数据
@@ -141,8 +180,7 @@ private:
     static const std::string EMPTY_STRING;
  
     // 辅助方法
-    std::string ToLower(const std::string& str) const;
-    void ParseQueryString(const std::string& query);
+    void ParseQueryString(std::string_view query);
     bool ValidateMethod(const std::string& method) const;
     bool ValidateVersion(const std::string& version) const;
 };
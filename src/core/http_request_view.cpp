@@ -0,0 +1,154 @@
+#include "http_request_view.hpp"
+
+#include <algorithm>
+
+namespace ppserver {
+
+std::string_view HttpRequestView::GetQueryString() const {
+    size_t question = target_.find('?');
+    if (question == std::string_view::npos) {
+        return std::string_view();
+    }
+    std::string_view query = target_.substr(question + 1);
+    return query.substr(0, query.find('#'));
+}
+
+std::string_view HttpRequestView::GetHeader(std::string_view name) const {
+    HeaderId id = LookupHeader(name);
+    if (id != HeaderId::UNKNOWN) {
+        return GetHeader(id);
+    }
+    if (UseBacking()) {
+        return backing_->GetHeader(name);
+    }
+    const Header* header = FindHeader(id, name);
+    return header ? header->value : std::string_view();
+}
+
+bool HttpRequestView::HasHeader(std::string_view name) const {
+    HeaderId id = LookupHeader(name);
+    if (id != HeaderId::UNKNOWN) {
+        return HasHeader(id);
+    }
+    if (UseBacking()) {
+        return backing_->HasHeader(name);
+    }
+    return FindHeader(id, name) != nullptr;
+}
+
+std::string_view HttpRequestView::GetHeader(HeaderId id) const {
+    if (UseBacking()) {
+        return backing_->GetHeader(id);
+    }
+    const Header* header = FindHeader(id, HeaderName(id));
+    return header ? header->value : std::string_view();
+}
+
+bool HttpRequestView::HasHeader(HeaderId id) const {
+    if (UseBacking()) {
+        return backing_->HasHeader(id);
+    }
+    return FindHeader(id, HeaderName(id)) != nullptr;
+}
+
+bool HttpRequestView::UseBacking() const {
+    return backing_ && backing_->GetAllHeaders().size() > header_count_;
+}
+
+const HttpRequestView::Header* HttpRequestView::FindHeader(HeaderId id, std::string_view name) const {
+    // 头部通常只有十几个，线性比较比建哈希表更快且不分配；常用头部只比较ID
+    if (id != HeaderId::UNKNOWN) {
+        for (size_t i = 0; i < header_count_; ++i) {
+            if (headers_[i].id == id) {
+                return &headers_[i];
+            }
+        }
+        return nullptr;
+    }
+    HeaderNameEqual equal;
+    for (size_t i = 0; i < header_count_; ++i) {
+        if (headers_[i].id == HeaderId::UNKNOWN && equal(headers_[i].name, name)) {
+            return &headers_[i];
+        }
+    }
+    return nullptr;
+}
+
+bool HttpRequestView::AddHeader(HeaderId id, std::string_view name, std::string_view value) {
+    if (header_count_ == kMaxHeaders) {
+        return false;
+    }
+    headers_[header_count_++] = Header{name, value, id};
+    return true;
+}
+
+bool HttpRequestView::IsKeepAlive() const {
+    std::string_view connection = GetHeader(HeaderId::CONNECTION);
+    if (HttpRequest::HasToken(connection, "close")) {
+        return false;
+    }
+    if (version_ == HttpRequest::Version::HTTP_1_0) {
+        return HttpRequest::HasToken(connection, "keep-alive");
+    }
+    return true;   // HTTP/1.1默认长连接
+}
+
+void HttpRequestView::Assign(const HttpRequest& request) {
+    Clear();
+    method_ = request.GetMethod();
+    version_ = request.GetVersion();
+    method_string_ = request.GetMethodString();
+    target_ = request.GetPath();
+    body_ = request.GetBody();
+    backing_ = &request;
+    for (const auto& [name, value] : request.GetAllHeaders()) {
+        if (!AddHeader(LookupHeader(name), name, value)) {
+            break;
+        }
+    }
+}
+
+HttpRequestPtr HttpRequestView::Copy() const {
+    HttpRequestPtr request = HttpRequest::Create();
+    request->SetMethod(method_);
+    request->SetVersion(version_);
+    request->SetPath(target_);
+    if (backing_) {
+        // 回退路径：头部可能超出内联数组，正文可能已溢出，都以来源请求为准
+        for (const auto& [name, value] : backing_->GetAllHeaders()) {
+            request->AddHeader(name, value);
+        }
+        const RequestBody& body = backing_->GetBodySource();
+        request->SetBodyMemoryLimit(body.GetMemoryLimit());
+        char buffer[16 * 1024];
+        size_t offset = 0;
+        while (offset < body.size()) {
+            size_t n = body.Read(offset, buffer, sizeof(buffer));
+            if (n == 0) {
+                break;
+            }
+            request->AppendBody(buffer, n);
+            offset += n;
+        }
+        request->SetBodyStreamed(backing_->IsBodyStreamed());
+    } else {
+        for (const Header& header : *this) {
+            request->AddHeader(header.name, header.value);
+        }
+        request->SetBodyMemoryLimit(std::max(body_.size(), RequestBody::kDefaultMemoryLimit));
+        request->SetBody(body_);
+    }
+    return request;
+}
+
+void HttpRequestView::Clear() {
+    method_ = HttpRequest::Method::UNKNOWN;
+    version_ = HttpRequest::Version::UNKNOWN;
+    method_string_ = std::string_view();
+    target_ = std::string_view();
+    body_ = std::string_view();
+    header_count_ = 0;
+    backing_ = nullptr;
+}
+
+} // namespace ppserver
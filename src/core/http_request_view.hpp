@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include "http_request.hpp"
+
+namespace ppserver {
+
+/**
+ * HttpRequestView - 零拷贝HTTP请求视图
+ * 负责：以string_view引用连接读缓冲区中的请求行、头部和正文，供Handler只读访问
+ * 设计特点：头部存放在定长内联数组中，解析和按名查找（大小写不敏感）都不分配内存；
+ *          常用头部在解析时记下HeaderId，按名查找先把名字哈希成ID再比较ID；
+ *          视图引用的缓冲区由Connection固定到请求处理完毕（下一次解析或读socket之前），
+ *          超出该范围需要保存的数据应自行拷贝
+ */
+class HttpRequestView {
+public:
+    static constexpr size_t kMaxHeaders = 64;   // 超出时解析器回退到拷贝模式
+
+    struct Header {
+        std::string_view name;
+        std::string_view value;
+        HeaderId id = HeaderId::UNKNOWN;
+    };
+
+    HttpRequest::Method GetMethod() const { return method_; }
+    HttpRequest::Version GetVersion() const { return version_; }
+    std::string_view GetMethodString() const { return method_string_; }
+    // 请求目标原文（含查询串），与HttpRequest::GetPath一致
+    std::string_view GetPath() const { return target_; }
+    std::string_view GetQueryString() const;
+    std::string_view GetBody() const { return body_; }
+    // 回退路径下的完整正文（可能已溢出到临时文件），原地解析的请求返回nullptr，正文即GetBody
+    const RequestBody* GetBodySource() const { return backing_ ? &backing_->GetBodySource() : nullptr; }
+
+    // 按名称查找（大小写不敏感），不存在时返回空视图
+    std::string_view GetHeader(std::string_view name) const;
+    bool HasHeader(std::string_view name) const;
+    std::string_view GetHeader(HeaderId id) const;
+    bool HasHeader(HeaderId id) const;
+    size_t GetHeaderCount() const { return header_count_; }
+    // 遍历内联数组中的头部（Assign回退路径下至多kMaxHeaders个，按名查找不受此限）
+    const Header* begin() const { return headers_.data(); }
+    const Header* end() const { return headers_.data() + header_count_; }
+
+    bool IsKeepAlive() const;
+
+    // 引用一个已拷贝解析的HttpRequest（回退路径），视图在request存活期间有效
+    void Assign(const HttpRequest& request);
+    // 拷贝出独立的HttpRequest（数据在全局堆上，不引用读缓冲区或RequestArena），
+    // 可交给其它线程处理并在任意线程释放；溢出到临时文件的正文按原内存上限重新溢出
+    HttpRequestPtr Copy() const;
+    void Clear();
+
+private:
+    friend class HttpParser;
+
+    bool AddHeader(HeaderId id, std::string_view name, std::string_view value);
+    const Header* FindHeader(HeaderId id, std::string_view name) const;
+    bool UseBacking() const;
+
+    HttpRequest::Method method_ = HttpRequest::Method::UNKNOWN;
+    HttpRequest::Version version_ = HttpRequest::Version::UNKNOWN;
+    std::string_view method_string_;
+    std::string_view target_;
+    std::string_view body_;
+    std::array<Header, kMaxHeaders> headers_;
+    size_t header_count_ = 0;
+    const HttpRequest* backing_ = nullptr;   // Assign的来源，头部超出内联容量时按名查找用
+};
+
+} // namespace ppserver
@@ -2,35 +2,110 @@
 
 namespace ppserver {
 
-HttpResponse::HttpResponse() 
-    : status_code_(HttpStatusCode::OK) {
+HttpResponse::HttpResponse(std::pmr::memory_resource* resource)
+    : status_code_(HttpStatusCode::OK),
+      headers_(resource),
+      body_(resource),
+      keep_alive_(true) {
 }
 
 HttpResponse::~HttpResponse() {
 }
 
+HttpResponsePtr HttpResponse::Create(std::pmr::memory_resource* resource) {
+    return HttpResponsePtr(HttpResponsePool::Instance().Construct(resource));
+}
+
+void HttpResponseDeleter::operator()(HttpResponse* response) const {
+    HttpResponsePool::Instance().Destroy(response);
+}
+
 void HttpResponse::SetStatusCode(HttpStatusCode code) {
     status_code_ = code;
 }
 
-void HttpResponse::SetHeader(const std::string& key, const std::string& value) {
-    headers_[key] = value;
+void HttpResponse::SetHeader(std::string_view key, std::string_view value) {
+    headers_[std::pmr::string(key, headers_.get_allocator())] = value;
 }
 
-void HttpResponse::SetBody(const std::string& body) {
+void HttpResponse::SetBody(std::string_view body) {
     body_ = body;
 }
 
+void HttpResponse::SetKeepAlive(bool keep_alive) {
+    keep_alive_ = keep_alive;
+}
+
 HttpResponse::HttpStatusCode HttpResponse::GetStatusCode() const {
     return status_code_;
 }
 
-const std::unordered_map<std::string, std::string>& HttpResponse::GetHeaders() const {
+const HttpResponse::HeaderMap& HttpResponse::GetHeaders() const {
     return headers_;
 }
 
-const std::string& HttpResponse::GetBody() const {
+std::string_view HttpResponse::GetBody() const {
     return body_;
 }
 
+bool HttpResponse::IsKeepAlive() const {
+    return keep_alive_;
+}
+
+std::string HttpResponse::Serialize() const {
+    std::string out;
+    out.reserve(128 + body_.size());
+    out += "HTTP/1.1 ";
+    out += std::to_string(static_cast<int>(status_code_));
+    out += ' ';
+    out += GetReasonPhrase(status_code_);
+    out += "\r\n";
+    for (const auto& [key, value] : headers_) {
+        out += key;
+        out += ": ";
+        out += value;
+        out += "\r\n";
+    }
+    out += "Content-Length: ";
+    out += std::to_string(body_.size());
+    out += keep_alive_ ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    out += body_;
+    return out;
+}
+
+const char* HttpResponse::GetReasonPhrase(HttpStatusCode code) {
+    switch (code) {
+        case HttpStatusCode::OK: return "OK";
+        case HttpStatusCode::BAD_REQUEST: return "Bad Request";
+        case HttpStatusCode::FORBIDDEN: return "Forbidden";
+        case HttpStatusCode::NOT_FOUND: return "Not Found";
+        case HttpStatusCode::METHOD_NOT_ALLOWED: return "Method Not Allowed";
+        case HttpStatusCode::PAYLOAD_TOO_LARGE: return "Payload Too Large";
+        case HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE: return "Request Header Fields Too Large";
+        case HttpStatusCode::INTERNAL_SERVER_ERROR: return "Internal Server Error";
+        case HttpStatusCode::SERVICE_UNAVAILABLE: return "Service Unavailable";
+    }
+    return "Unknown";
+}
+
+namespace {
+
+std::shared_ptr<const std::string> BuildServiceUnavailable(bool keep_alive) {
+    HttpResponse response;
+    response.SetStatusCode(HttpResponse::HttpStatusCode::SERVICE_UNAVAILABLE);
+    response.SetHeader("Content-Type", "text/plain; charset=utf-8");
+    response.SetHeader("Retry-After", "1");
+    response.SetBody("Service Unavailable");
+    response.SetKeepAlive(keep_alive);
+    return std::make_shared<const std::string>(response.Serialize());
+}
+
+} // namespace
+
+const std::shared_ptr<const std::string>& HttpResponse::ServiceUnavailable(bool keep_alive) {
+    static const std::shared_ptr<const std::string> keep_alive_response = BuildServiceUnavailable(true);
+    static const std::shared_ptr<const std::string> close_response = BuildServiceUnavailable(false);
+    return keep_alive ? keep_alive_response : close_response;
+}
+
 } // namespace ppsever
\ No newline at end of file
@@ -1,37 +1,73 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
-#include "connection.hpp"
-#include "connection_manager.hpp"
-#include "event_loop.hpp"
+#include "memory_pool.hpp"
 
 namespace ppserver {
 
+class HttpResponse;
+
+// 把响应对象放回HttpResponsePool
+struct HttpResponseDeleter {
+    void operator()(HttpResponse* response) const;
+};
+
+using HttpResponsePtr = std::unique_ptr<HttpResponse, HttpResponseDeleter>;
+using HttpResponsePool = MemoryPool<HttpResponse>;
+
 class HttpResponse {
 public:
     enum class HttpStatusCode {
         OK = 200,
+        BAD_REQUEST = 400,
+        FORBIDDEN = 403,
         NOT_FOUND = 404,
-        INTERNAL_SERVER_ERROR = 500
+        METHOD_NOT_ALLOWED = 405,
+        PAYLOAD_TOO_LARGE = 413,
+        REQUEST_HEADER_FIELDS_TOO_LARGE = 431,
+        INTERNAL_SERVER_ERROR = 500,
+        SERVICE_UNAVAILABLE = 503
     };
 
-    HttpResponse();
+    using HeaderMap = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
+
+    // resource为头部与正文的内存来源，如连接的RequestArena（默认全局堆）
+    explicit HttpResponse(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~HttpResponse();
 
+    // 在HttpResponsePool中创建，用于生存期超出当前作用域的响应（如跨线程交给loop发送）
+    static HttpResponsePtr Create(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
     void SetStatusCode(HttpStatusCode code);
-    void SetHeader(const std::string& key, const std::string& value);
-    void SetBody(const std::string& body);
+    void SetHeader(std::string_view key, std::string_view value);
+    void SetBody(std::string_view body);
+    // 是否保持连接，决定Connection头（默认保持）
+    void SetKeepAlive(bool keep_alive);
 
     HttpStatusCode GetStatusCode() const;
-    const std::unordered_map<std::string, std::string>& GetHeaders() const;
-    const std::string& GetBody() const;
+    const HeaderMap& GetHeaders() const;
+    std::string_view GetBody() const;
+    bool IsKeepAlive() const;
+
+    // 生成完整的HTTP/1.1响应报文（自动补Content-Length与Connection头）
+    std::string Serialize() const;
+
+    static const char* GetReasonPhrase(HttpStatusCode code);
+
+    // 过载时的503响应（带Retry-After），进程内只生成一次，各连接共享发送；
+    // 任务被ThreadPool拒绝时直接回复，不再为该请求分配或序列化任何东西
+    static const std::shared_ptr<const std::string>& ServiceUnavailable(bool keep_alive);
 
 private:
     HttpStatusCode status_code_;
-    std::unordered_map<std::string, std::string> headers_;
-    std::string body_;
+    HeaderMap headers_;
+    std::pmr::string body_;
+    bool keep_alive_;
 };
 
 } // namespace ppsever
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "http_scanner.hpp"
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PPSERVER_SCANNER_X86 1
+#endif
+
+namespace ppserver {
+
+namespace {
+
+// 字节分类：控制字符（含'\r'、HTAB）与DEL、冒号、'\r'
+constexpr uint8_t kCtl = 1;
+constexpr uint8_t kColon = 2;
+constexpr uint8_t kCr = 4;
+
+struct ByteClassTable {
+    uint8_t value[256];
+
+    constexpr ByteClassTable() : value() {
+        for (int c = 0; c < 0x20; ++c) {
+            value[c] = kCtl;
+        }
+        value[0x7f] = kCtl;
+        value[static_cast<unsigned char>(':')] = kColon;
+        value[static_cast<unsigned char>('\r')] = kCtl | kCr;
+    }
+};
+
+constexpr ByteClassTable kByteClass;
+
+template <uint8_t kMask>
+size_t FindScalar(const char* data, size_t len, size_t pos) {
+    for (; pos < len; ++pos) {
+        if (kByteClass.value[static_cast<unsigned char>(data[pos])] & kMask) {
+            return pos;
+        }
+    }
+    return len;
+}
+
+#ifdef PPSERVER_SCANNER_X86
+
+// PCMPESTRI的字节范围表：每两个字节是一个闭区间
+alignas(16) const char kCtlRanges[16] = "\x00\x1f\x7f\x7f";
+alignas(16) const char kCtlOrColonRanges[16] = "\x00\x1f\x7f\x7f::";
+alignas(16) const char kCrRanges[16] = "\r\r";
+
+template <uint8_t kMask>
+__attribute__((target("sse4.2")))
+size_t FindSse42(const char* data, size_t len, size_t pos) {
+    const char* table = (kMask == kCr) ? kCrRanges : (kMask & kColon) ? kCtlOrColonRanges : kCtlRanges;
+    const int table_len = (kMask == kCr) ? 2 : (kMask & kColon) ? 6 : 4;
+    const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+    while (pos + 16 <= len) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        int index = _mm_cmpestri(ranges, table_len, block, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index != 16) {
+            return pos + index;
+        }
+        pos += 16;
+    }
+    return FindScalar<kMask>(data, len, pos);
+}
+
+template <uint8_t kMask>
+__attribute__((target("avx2")))
+size_t FindAvx2(const char* data, size_t len, size_t pos) {
+    const __m256i ctl_max = _mm256_set1_epi8(0x1f);
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    while (pos + 32 <= len) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i hit;
+        if (kMask == kCr) {
+            hit = _mm256_cmpeq_epi8(block, cr);
+        } else {
+            // 无符号 x <= 0x1f 等价于 min(x, 0x1f) == x
+            hit = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(block, ctl_max), block),
+                                  _mm256_cmpeq_epi8(block, del));
+            if (kMask & kColon) {
+                hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(block, colon));
+            }
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+        pos += 32;
+    }
+    return FindSse42<kMask>(data, len, pos);   // 不足32字节的尾部
+}
+
+#endif
+
+using FindFn = size_t (*)(const char*, size_t, size_t);
+
+struct Finders {
+    FindFn ctl;            // 控制字符/DEL
+    FindFn ctl_or_colon;   // 控制字符/DEL/冒号
+    FindFn cr;             // '\r'
+};
+
+const Finders kScalarFinders = {FindScalar<kCtl>, FindScalar<kCtl | kColon>, FindScalar<kCr>};
+#ifdef PPSERVER_SCANNER_X86
+const Finders kSse42Finders = {FindSse42<kCtl>, FindSse42<kCtl | kColon>, FindSse42<kCr>};
+const Finders kAvx2Finders = {FindAvx2<kCtl>, FindAvx2<kCtl | kColon>, FindAvx2<kCr>};
+#endif
+
+const Finders* FindersFor(HttpScanner::Level level) {
+#ifdef PPSERVER_SCANNER_X86
+    switch (level) {
+        case HttpScanner::Level::AVX2: return &kAvx2Finders;
+        case HttpScanner::Level::SSE42: return &kSse42Finders;
+        case HttpScanner::Level::SCALAR: break;
+    }
+#else
+    (void)level;
+#endif
+    return &kScalarFinders;
+}
+
+// 常量初始化为空，首次使用时检测CPU，避免依赖其它编译单元的静态初始化顺序
+std::atomic<const Finders*> g_finders{nullptr};
+std::atomic<HttpScanner::Level> g_level{HttpScanner::Level::SCALAR};
+
+inline const Finders& Current() {
+    const Finders* finders = g_finders.load(std::memory_order_relaxed);
+    if (!finders) {
+        HttpScanner::SetLevel(HttpScanner::DetectLevel());
+        finders = g_finders.load(std::memory_order_relaxed);
+    }
+    return *finders;
+}
+
+} // namespace
+
+HttpScanner::Line HttpScanner::ScanLine(const char* data, size_t len, size_t start) {
+    const Finders& finders = Current();
+    Line line;
+    size_t pos = start;
+    while (true) {
+        pos = (line.colon == npos) ? finders.ctl_or_colon(data, len, pos) : finders.ctl(data, len, pos);
+        if (pos >= len) {
+            return line;   // 行尚未结束
+        }
+        char c = data[pos];
+        if (c == ':') {
+            line.colon = pos++;
+            continue;
+        }
+        if (c == '\t') {
+            ++pos;
+            continue;
+        }
+        if (c == '\r') {
+            if (pos + 1 >= len) {
+                return line;   // 等待'\n'
+            }
+            line.end = pos;
+            line.invalid = (data[pos + 1] != '\n');
+            return line;
+        }
+        line.end = pos;
+        line.invalid = true;
+        return line;
+    }
+}
+
+size_t HttpScanner::FindLineEnd(const char* data, size_t len, size_t start) {
+    const Finders& finders = Current();
+    size_t pos = start;
+    while (true) {
+        pos = finders.cr(data, len, pos);
+        if (pos + 1 >= len) {
+            return npos;
+        }
+        if (data[pos + 1] == '\n') {
+            return pos;
+        }
+        ++pos;
+    }
+}
+
+size_t HttpScanner::FindHeaderEnd(const char* data, size_t len, size_t start) {
+    const Finders& finders = Current();
+    size_t pos = start;
+    while (true) {
+        pos = finders.cr(data, len, pos);
+        if (pos + 3 >= len) {
+            return npos;
+        }
+        if (data[pos + 1] == '\n' && data[pos + 2] == '\r' && data[pos + 3] == '\n') {
+            return pos;
+        }
+        ++pos;
+    }
+}
+
+HttpScanner::Level HttpScanner::DetectLevel() {
+#ifdef PPSERVER_SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Level::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return Level::SSE42;
+    }
+#endif
+    return Level::SCALAR;
+}
+
+HttpScanner::Level HttpScanner::GetLevel() {
+    Current();
+    return g_level.load(std::memory_order_relaxed);
+}
+
+void HttpScanner::SetLevel(Level level) {
+    if (static_cast<int>(level) > static_cast<int>(DetectLevel())) {
+        level = DetectLevel();
+    }
+    g_level.store(level, std::memory_order_relaxed);
+    g_finders.store(FindersFor(level), std::memory_order_relaxed);
+}
+
+const char* HttpScanner::LevelName(Level level) {
+    switch (level) {
+        case Level::AVX2: return "avx2";
+        case Level::SSE42: return "sse4.2";
+        case Level::SCALAR: return "scalar";
+    }
+    return "unknown";
+}
+
+} // namespace ppserver
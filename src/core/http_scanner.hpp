@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ppserver {
+
+/**
+ * HttpScanner - HTTP报文定界符扫描
+ * 负责：在请求头中查找行尾、冒号和非法控制字符，供HttpParser切分请求行与头部
+ * 设计特点：x86上按CPU能力在运行时选择AVX2（每次32字节）、SSE4.2（PCMPESTRI按字节范围，
+ *          每次16字节）或逐字节查表实现，结果完全一致；SIMD加载不越过len，尾部走标量路径。
+ *          非x86平台只有标量实现
+ */
+class HttpScanner {
+public:
+    enum class Level {
+        SCALAR,
+        SSE42,
+        AVX2
+    };
+
+    static constexpr size_t npos = std::string::npos;
+
+    // 一行的扫描结果
+    struct Line {
+        size_t end = npos;     // 行尾'\r'的位置，数据不完整时为npos
+        size_t colon = npos;   // 第一个':'的位置
+        bool invalid = false;  // 行内出现除HTAB外的控制字符、DEL或孤立的'\r'
+    };
+
+    // 从start开始扫描一行：一次遍历同时得到行尾、第一个冒号和非法字符。
+    // 出现非法字符时立即返回（invalid=true）；行尾'\r'后的'\n'尚未到达时视为数据不完整
+    static Line ScanLine(const char* data, size_t len, size_t start);
+
+    // 查找"\r\n"，返回'\r'的位置
+    static size_t FindLineEnd(const char* data, size_t len, size_t start);
+
+    // 查找头部结束标记"\r\n\r\n"，返回第一个'\r'的位置
+    static size_t FindHeaderEnd(const char* data, size_t len, size_t start);
+
+    // 当前使用的实现；SetLevel用于压测对比，超出CPU能力的级别会被降级
+    static Level GetLevel();
+    static void SetLevel(Level level);
+    static Level DetectLevel();
+    static const char* LevelName(Level level);
+};
+
+} // namespace ppserver
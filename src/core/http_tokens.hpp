@@ -0,0 +1,303 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ppserver {
+
+/**
+ * PerfectHashTable - 编译期生成的最小碰撞哈希表
+ * 负责：把一组固定的字符串（HTTP方法、版本、常用头部名）映射到下标
+ * 设计特点：构造函数为constexpr，在编译期逐个尝试种子直到所有关键字落在不同槽位，
+ *          查找只需一次哈希、一次取槽和一次比较，不分配内存；
+ *          fold_case为true时大小写不敏感（哈希时忽略0x20位，比较时按ASCII转小写）
+ */
+template <size_t N, size_t kSlots>
+class PerfectHashTable {
+    static_assert(N < 0xff, "slot index is stored in uint8_t");
+    static_assert((kSlots & (kSlots - 1)) == 0 && kSlots >= N, "slot count must be a power of two");
+
+public:
+    static constexpr size_t kNotFound = N;
+
+    constexpr PerfectHashTable(const std::array<std::string_view, N>& keys, bool fold_case)
+        : keys_(keys), slots_(), seed_(0), fold_case_(fold_case) {
+        for (uint32_t attempt = 1; attempt < 100000 && seed_ == 0; ++attempt) {
+            uint32_t seed = attempt * 0x9e3779b9u;
+            if (TrySeed(seed)) {
+                seed_ = seed;
+            }
+        }
+    }
+
+    // 返回关键字下标，不存在时返回kNotFound
+    constexpr size_t Find(std::string_view key) const {
+        size_t index = slots_[Hash(key, seed_, fold_case_) & (kSlots - 1)];
+        if (index < N && Equals(keys_[index], key)) {
+            return index;
+        }
+        return kNotFound;
+    }
+
+    constexpr std::string_view Key(size_t index) const { return keys_[index]; }
+    constexpr bool Valid() const { return seed_ != 0; }
+
+    // 每次取8字节做一次乘法混合，头部名通常只需1~3轮
+    static constexpr uint32_t Hash(std::string_view key, uint32_t seed, bool fold_case) {
+        const uint64_t fold = fold_case ? 0x2020202020202020ull : 0;
+        uint64_t h = ((seed | 1ull) * 0xff51afd7ed558ccdull) ^ key.size();
+        size_t i = 0;
+        while (i < key.size()) {
+            uint64_t word = 0;
+            size_t n = key.size() - i < 8 ? key.size() - i : 8;
+            if (n == 8 && !__builtin_is_constant_evaluated()) {
+                __builtin_memcpy(&word, key.data() + i, 8);   // 运行期整字加载（小端）
+            } else {
+                for (size_t j = 0; j < n; ++j) {
+                    word |= static_cast<uint64_t>(static_cast<uint8_t>(key[i + j])) << (j * 8);
+                }
+            }
+            h = (h ^ (word | fold)) * 0x9e3779b97f4a7c15ull;
+            h ^= h >> 29;
+            i += n;
+        }
+        // 末尾再混合一次，让只在高位字节不同的关键字（如"HTTP/1.0"与"HTTP/1.1"）也分散到低位
+        h *= 0xc4ceb9fe1a85ec53ull;
+        return static_cast<uint32_t>(h >> 32);
+    }
+
+private:
+    constexpr bool TrySeed(uint32_t seed) {
+        for (size_t i = 0; i < kSlots; ++i) {
+            slots_[i] = 0xff;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            size_t slot = Hash(keys_[i], seed, fold_case_) & (kSlots - 1);
+            if (slots_[slot] != 0xff) {
+                return false;
+            }
+            slots_[slot] = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+
+    constexpr bool Equals(std::string_view expected, std::string_view key) const {
+        if (expected.size() != key.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < key.size(); ++i) {
+            char a = expected[i];
+            char b = key[i];
+            if (fold_case_) {
+                a = (a >= 'A' && a <= 'Z') ? static_cast<char>(a + 32) : a;
+                b = (b >= 'A' && b <= 'Z') ? static_cast<char>(b + 32) : b;
+            }
+            if (a != b) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::array<std::string_view, N> keys_;
+    std::array<uint8_t, kSlots> slots_;
+    uint32_t seed_;
+    bool fold_case_;
+};
+
+// 常用HTTP头部字段ID（请求与响应中最常见的字段），其余字段为UNKNOWN
+enum class HeaderId : uint8_t {
+    ACCEPT,
+    ACCEPT_CHARSET,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    ACCEPT_RANGES,
+    ACCESS_CONTROL_REQUEST_HEADERS,
+    ACCESS_CONTROL_REQUEST_METHOD,
+    AGE,
+    ALLOW,
+    AUTHORIZATION,
+    CACHE_CONTROL,
+    CONNECTION,
+    CONTENT_DISPOSITION,
+    CONTENT_ENCODING,
+    CONTENT_LANGUAGE,
+    CONTENT_LENGTH,
+    CONTENT_LOCATION,
+    CONTENT_RANGE,
+    CONTENT_TYPE,
+    COOKIE,
+    DATE,
+    DNT,
+    EARLY_DATA,
+    ETAG,
+    EXPECT,
+    EXPIRES,
+    FORWARDED,
+    FROM,
+    HOST,
+    IF_MATCH,
+    IF_MODIFIED_SINCE,
+    IF_NONE_MATCH,
+    IF_RANGE,
+    IF_UNMODIFIED_SINCE,
+    KEEP_ALIVE,
+    LAST_MODIFIED,
+    LINK,
+    LOCATION,
+    MAX_FORWARDS,
+    ORIGIN,
+    PRAGMA,
+    PRIORITY,
+    PROXY_AUTHORIZATION,
+    PROXY_CONNECTION,
+    RANGE,
+    REFERER,
+    SEC_CH_UA,
+    SEC_CH_UA_MOBILE,
+    SEC_CH_UA_PLATFORM,
+    SEC_FETCH_DEST,
+    SEC_FETCH_MODE,
+    SEC_FETCH_SITE,
+    SEC_FETCH_USER,
+    SEC_WEBSOCKET_KEY,
+    SEC_WEBSOCKET_PROTOCOL,
+    SEC_WEBSOCKET_VERSION,
+    SERVER,
+    SET_COOKIE,
+    TE,
+    TRAILER,
+    TRANSFER_ENCODING,
+    UPGRADE,
+    UPGRADE_INSECURE_REQUESTS,
+    USER_AGENT,
+    VARY,
+    VIA,
+    X_FORWARDED_FOR,
+    X_FORWARDED_HOST,
+    X_FORWARDED_PROTO,
+    X_REAL_IP,
+    X_REQUEST_ID,
+    X_REQUESTED_WITH,
+    UNKNOWN
+};
+
+constexpr size_t kKnownHeaderCount = static_cast<size_t>(HeaderId::UNKNOWN);
+
+// 与HeaderId顺序一致的规范写法
+inline constexpr std::array<std::string_view, kKnownHeaderCount> kHeaderNames = {
+    "Accept",
+    "Accept-Charset",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Accept-Ranges",
+    "Access-Control-Request-Headers",
+    "Access-Control-Request-Method",
+    "Age",
+    "Allow",
+    "Authorization",
+    "Cache-Control",
+    "Connection",
+    "Content-Disposition",
+    "Content-Encoding",
+    "Content-Language",
+    "Content-Length",
+    "Content-Location",
+    "Content-Range",
+    "Content-Type",
+    "Cookie",
+    "Date",
+    "DNT",
+    "Early-Data",
+    "ETag",
+    "Expect",
+    "Expires",
+    "Forwarded",
+    "From",
+    "Host",
+    "If-Match",
+    "If-Modified-Since",
+    "If-None-Match",
+    "If-Range",
+    "If-Unmodified-Since",
+    "Keep-Alive",
+    "Last-Modified",
+    "Link",
+    "Location",
+    "Max-Forwards",
+    "Origin",
+    "Pragma",
+    "Priority",
+    "Proxy-Authorization",
+    "Proxy-Connection",
+    "Range",
+    "Referer",
+    "Sec-CH-UA",
+    "Sec-CH-UA-Mobile",
+    "Sec-CH-UA-Platform",
+    "Sec-Fetch-Dest",
+    "Sec-Fetch-Mode",
+    "Sec-Fetch-Site",
+    "Sec-Fetch-User",
+    "Sec-WebSocket-Key",
+    "Sec-WebSocket-Protocol",
+    "Sec-WebSocket-Version",
+    "Server",
+    "Set-Cookie",
+    "TE",
+    "Trailer",
+    "Transfer-Encoding",
+    "Upgrade",
+    "Upgrade-Insecure-Requests",
+    "User-Agent",
+    "Vary",
+    "Via",
+    "X-Forwarded-For",
+    "X-Forwarded-Host",
+    "X-Forwarded-Proto",
+    "X-Real-IP",
+    "X-Request-Id",
+    "X-Requested-With",
+};
+
+inline constexpr PerfectHashTable<kKnownHeaderCount, 512> kHeaderTable(kHeaderNames, true);
+static_assert(kHeaderTable.Valid(), "no collision-free seed for header names");
+
+// 头部名（大小写不敏感）到ID；参数为字面量时可在编译期求值
+constexpr HeaderId LookupHeader(std::string_view name) {
+    return static_cast<HeaderId>(kHeaderTable.Find(name));
+}
+
+constexpr std::string_view HeaderName(HeaderId id) {
+    return id == HeaderId::UNKNOWN ? std::string_view() : kHeaderNames[static_cast<size_t>(id)];
+}
+
+static_assert(LookupHeader("content-length") == HeaderId::CONTENT_LENGTH);
+static_assert(LookupHeader("X-Unknown-Header") == HeaderId::UNKNOWN);
+
+// 大小写不敏感的头部名哈希与比较，供以头部名为键的unordered_map使用（查找时无需转小写）
+struct HeaderNameHash {
+    size_t operator()(std::string_view name) const {
+        return kHeaderTable.Hash(name, 0x811c9dc5u, true);
+    }
+};
+
+struct HeaderNameEqual {
+    bool operator()(std::string_view a, std::string_view b) const {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            char x = (a[i] >= 'A' && a[i] <= 'Z') ? static_cast<char>(a[i] + 32) : a[i];
+            char y = (b[i] >= 'A' && b[i] <= 'Z') ? static_cast<char>(b[i] + 32) : b[i];
+            if (x != y) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace ppserver
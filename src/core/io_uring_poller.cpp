@@ -0,0 +1,320 @@
+#include "io_uring_poller.hpp"
+#include <stdexcept>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#ifdef PPSERVER_WITH_IO_URING
+
+#include <csignal>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+namespace ppserver {
+
+namespace {
+
+int SysIoUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysIoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                    unsigned flags, void* arg, size_t arg_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                                    flags, arg, arg_size));
+}
+
+template <typename T>
+T* RingPointer(void* ring, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+} // namespace
+
+IoUringPoller::IoUringPoller(unsigned entries)
+    : ring_fd_(-1),
+      features_(0),
+      sq_ring_(MAP_FAILED),
+      sq_ring_size_(0),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_mask_(0),
+      sq_entries_(0),
+      sq_array_(nullptr),
+      sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)),
+      sqes_size_(0),
+      sq_local_tail_(0),
+      cq_ring_(MAP_FAILED),
+      cq_ring_size_(0),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_mask_(0),
+      cqes_(nullptr) {
+
+    // CQ放大到4倍：每个fd都挂着multishot poll，一批就绪可能远多于SQ深度
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = entries * 4;
+    ring_fd_ = SysIoUringSetup(entries, &params);
+    if (ring_fd_ < 0 && errno == EINVAL) {
+        // 5.19之前的内核不支持COOP_TASKRUN
+        params = io_uring_params{};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        ring_fd_ = SysIoUringSetup(entries, &params);
+    }
+    if (ring_fd_ < 0) {
+        throw std::runtime_error("io_uring_setup failed: " + std::string(strerror(errno)));
+    }
+
+    features_ = params.features;
+    if (!(features_ & IORING_FEAT_SINGLE_MMAP) || !(features_ & IORING_FEAT_EXT_ARG)) {
+        close(ring_fd_);
+        throw std::runtime_error("io_uring: kernel lacks SINGLE_MMAP/EXT_ARG support");
+    }
+
+    // SQ与CQ环共用一次映射
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    size_t ring_size = std::max(sq_ring_size_, cq_ring_size_);
+    sq_ring_ = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        int saved_errno = errno;
+        close(ring_fd_);
+        throw std::runtime_error("io_uring ring mmap failed: " + std::string(strerror(saved_errno)));
+    }
+    sq_ring_size_ = cq_ring_size_ = ring_size;
+    cq_ring_ = sq_ring_;
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        int saved_errno = errno;
+        munmap(sq_ring_, ring_size);
+        close(ring_fd_);
+        throw std::runtime_error("io_uring sqe mmap failed: " + std::string(strerror(saved_errno)));
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    sq_head_ = RingPointer<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = RingPointer<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = *RingPointer<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_entries_ = *RingPointer<unsigned>(sq_ring_, params.sq_off.ring_entries);
+    sq_array_ = RingPointer<unsigned>(sq_ring_, params.sq_off.array);
+    sq_local_tail_ = *sq_tail_;
+    // SQ数组固定为恒等映射：第i个槽位总是指向第i个SQE
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        sq_array_[i] = i;
+    }
+
+    cq_head_ = RingPointer<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = RingPointer<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = *RingPointer<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = RingPointer<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+}
+
+IoUringPoller::~IoUringPoller() {
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);   // 关闭ring会取消所有挂起的poll
+}
+
+int IoUringPoller::Control(int op, int fd, const epoll_event* event) {
+    if (fd < 0) {
+        errno = EBADF;
+        return -1;
+    }
+    if (static_cast<size_t>(fd) >= fds_.size()) {
+        fds_.resize(std::max<size_t>(static_cast<size_t>(fd) + 1, fds_.size() * 2));
+    }
+    FdState& state = fds_[fd];
+
+    switch (op) {
+    case EPOLL_CTL_ADD:
+        if (state.registered) {
+            errno = EEXIST;
+            return -1;
+        }
+        state.data = event->data.u64;
+        state.events = event->events;
+        state.registered = true;
+        ArmPoll(fd, state);
+        return 0;
+
+    case EPOLL_CTL_MOD:
+        if (!state.registered) {
+            errno = ENOENT;
+            return -1;
+        }
+        // 撤掉旧poll再按新事件挂一个；与epoll_ctl(MOD)一样，新poll会立即检查一次就绪状态
+        RemovePoll(fd, state);
+        state.data = event->data.u64;
+        state.events = event->events;
+        ArmPoll(fd, state);
+        return 0;
+
+    case EPOLL_CTL_DEL:
+        if (!state.registered) {
+            errno = ENOENT;
+            return -1;
+        }
+        RemovePoll(fd, state);
+        state.registered = false;
+        ++state.seq;  // 已在CQ中的旧事件随之失效
+        return 0;
+
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+int IoUringPoller::Wait(epoll_event* events, int max_events, int timeout_ms) {
+    // CQ中已有事件时不进内核；顺带把本轮产生的注册请求提交掉
+    int count = Reap(events, max_events);
+    if (count > 0) {
+        if (sq_local_tail_ != *sq_head_) {
+            Enter(0, timeout_ms, false);
+        }
+        return count;
+    }
+
+    // 提交与等待合并为一次系统调用
+    if (Enter(timeout_ms == 0 ? 0 : 1, timeout_ms, true) < 0 &&
+        errno != ETIME && errno != EBUSY) {
+        return -1;
+    }
+    return Reap(events, max_events);
+}
+
+io_uring_sqe* IoUringPoller::GetSqe() {
+    if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        // SQ已满（单轮注册了大量fd），先提交一批
+        Enter(0, 0, false);
+        if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            throw std::runtime_error("io_uring submission queue overflow: " +
+                                     std::string(strerror(errno)));
+        }
+    }
+    io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ++sq_local_tail_;
+    return sqe;
+}
+
+void IoUringPoller::ArmPoll(int fd, FdState& state) {
+    ++state.seq;
+    io_uring_sqe* sqe = GetSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = state.events;    // 保留EPOLLET，语义与epoll边缘触发一致
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = (static_cast<uint64_t>(state.seq) << 32) | static_cast<uint32_t>(fd);
+}
+
+void IoUringPoller::RemovePoll(int fd, const FdState& state) {
+    io_uring_sqe* sqe = GetSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (static_cast<uint64_t>(state.seq) << 32) | static_cast<uint32_t>(fd);
+    sqe->user_data = kInternalUserData;
+}
+
+int IoUringPoller::Enter(unsigned min_complete, int timeout_ms, bool wait) {
+    // 发布本地填写的SQE，内核通过acquire读取tail
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+
+    unsigned flags = 0;
+    io_uring_getevents_arg arg{};
+    __kernel_timespec ts{};
+    if (wait) {
+        // 即使min_complete为0也带GETEVENTS：COOP_TASKRUN下要靠进内核来产出完成事件
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        arg.sigmask_sz = _NSIG / 8;
+        if (timeout_ms >= 0 && min_complete > 0) {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+        }
+    } else if (to_submit == 0) {
+        return 0;
+    }
+    return SysIoUringEnter(ring_fd_, to_submit, min_complete, flags,
+                           wait ? &arg : nullptr, wait ? sizeof(arg) : 0);
+}
+
+int IoUringPoller::Reap(epoll_event* events, int max_events) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    int count = 0;
+
+    while (head != tail && count < max_events) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        ++head;
+        if (cqe.user_data == kInternalUserData) {
+            continue;   // POLL_REMOVE的结果，ENOENT说明poll已自行结束，无需处理
+        }
+
+        uint32_t fd = static_cast<uint32_t>(cqe.user_data);
+        uint32_t seq = static_cast<uint32_t>(cqe.user_data >> 32);
+        if (fd >= fds_.size()) {
+            continue;
+        }
+        FdState& state = fds_[fd];
+        if (!state.registered || state.seq != seq) {
+            continue;   // 已DEL/MOD的旧poll残留事件
+        }
+
+        bool more = cqe.flags & IORING_CQE_F_MORE;
+        if (cqe.res < 0) {
+            // ECANCELED等：multishot被内核终止（如CQ溢出），重新挂载即可；其它错误交给回调处理
+            if (cqe.res == -ECANCELED || cqe.res == -ENOMEM) {
+                ArmPoll(static_cast<int>(fd), state);
+                continue;
+            }
+            events[count].events = EPOLLERR;
+        } else {
+            events[count].events = static_cast<uint32_t>(cqe.res);
+            if (!more) {
+                ArmPoll(static_cast<int>(fd), state);
+            }
+        }
+        events[count].data.u64 = state.data;
+        ++count;
+    }
+
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return count;
+}
+
+} // namespace ppserver
+
+#else // !PPSERVER_WITH_IO_URING
+
+namespace ppserver {
+
+IoUringPoller::IoUringPoller(unsigned) {
+    throw std::runtime_error("io_uring backend not compiled in (PPSERVER_WITH_IO_URING=OFF)");
+}
+
+IoUringPoller::~IoUringPoller() = default;
+
+int IoUringPoller::Control(int, int, const epoll_event*) {
+    errno = ENOSYS;
+    return -1;
+}
+
+int IoUringPoller::Wait(epoll_event*, int, int) {
+    errno = ENOSYS;
+    return -1;
+}
+
+} // namespace ppserver
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <sys/epoll.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace ppserver {
+
+/**
+ * IoUringPoller - 基于io_uring的就绪事件多路复用器
+ * 负责：以epoll_ctl/epoll_wait相同的语义提供fd就绪通知，供EventLoop替换epoll
+ * 设计特点：每个fd挂一个multishot POLL_ADD，就绪一次产生一个CQE，无需重复提交；
+ *          ADD/MOD/DEL只写入SQ不进内核，与下一次等待合并为一次io_uring_enter提交，
+ *          省掉epoll模式下每次切换EPOLLOUT的epoll_ctl系统调用；
+ *          CQE直接在用户态共享内存中收割，转换成epoll_event交给原有分发逻辑
+ * 范围：只做就绪通知，accept/readv/sendmsg仍由WebServer与Connection自行发起；
+ *      没有使用multishot accept、带provided buffer的multishot recv和批量send——
+ *      它们交付的是fd与数据而不是就绪事件，需要把连接读写改成完成模型
+ * 依赖：内核5.13+（multishot poll、EXT_ARG超时），直接使用系统调用，不依赖liburing
+ * 线程安全：非线程安全，只能在所属EventLoop线程内调用
+ */
+class IoUringPoller {
+public:
+    // 创建失败（内核不支持或io_uring被禁用）时抛出std::runtime_error
+    explicit IoUringPoller(unsigned entries = 256);
+    ~IoUringPoller();
+
+    IoUringPoller(const IoUringPoller&) = delete;
+    IoUringPoller& operator=(const IoUringPoller&) = delete;
+
+    // 与epoll_ctl语义一致（op为EPOLL_CTL_ADD/MOD/DEL），请求延迟到下一次Wait时提交
+    int Control(int op, int fd, const epoll_event* event);
+
+    // 与epoll_wait语义一致：提交挂起的请求并等待至多timeout_ms毫秒（-1为无限）
+    int Wait(epoll_event* events, int max_events, int timeout_ms);
+
+private:
+    // fd的注册状态：seq随每次重新挂载poll递增，用于丢弃旧poll残留的CQE
+    struct FdState {
+        uint64_t data = 0;       // 调用方的epoll_event.data
+        uint32_t events = 0;
+        uint32_t seq = 0;
+        bool registered = false;
+    };
+
+    static constexpr uint64_t kInternalUserData = ~uint64_t(0);  // POLL_REMOVE等内部请求的CQE
+
+    io_uring_sqe* GetSqe();
+    void ArmPoll(int fd, FdState& state);
+    void RemovePoll(int fd, const FdState& state);
+    // 发布SQE并进入内核；wait为false时只提交
+    int Enter(unsigned min_complete, int timeout_ms, bool wait);
+    int Reap(epoll_event* events, int max_events);
+
+    int ring_fd_;
+    unsigned features_;
+
+    // SQ环
+    void* sq_ring_;
+    size_t sq_ring_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned* sq_array_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned sq_local_tail_;     // 本地尾部：tail与head之差即待提交的SQE数
+
+    // CQ环（FEAT_SINGLE_MMAP时与SQ共享同一映射）
+    void* cq_ring_;
+    size_t cq_ring_size_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+
+    std::vector<FdState> fds_;   // 下标即fd
+};
+
+} // namespace ppserver
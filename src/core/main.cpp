@@ -5,6 +5,7 @@
 #include <sstream>
 #include "web_server.hpp"
 #include "event_loop.hpp"
+#include "thread_pool.hpp"
 #include "connection_manager.hpp"
 #include "connection.hpp"
 #include "http_request.hpp"
@@ -12,29 +13,153 @@
 
 using namespace ppserver;
 
-int main() {
+// 去除首尾空白
+static std::string Trim(const std::string& str) {
+    size_t begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+// 加载config/init.conf中[server]段的配置，文件不存在时使用默认值
+static bool LoadServerConfig(const std::string& path, WebServer::Config& config,
+                             ThreadPool::Config_thread_pool& pool_config) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    std::string section;
+    while (std::getline(file, line)) {
+        line = Trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            section = line.substr(1, line.size() - 2);
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (section != "server" || eq == std::string::npos) {
+            continue;
+        }
+
+        std::string key = Trim(line.substr(0, eq));
+        std::string value = Trim(line.substr(eq + 1));
+        try {
+            if (key == "ip") {
+                config.host = value;
+            } else if (key == "port") {
+                config.port = static_cast<uint16_t>(std::stoul(value));
+            } else if (key == "max_connections") {
+                config.max_connections = std::stoul(value);
+            } else if (key == "timeout_seconds") {
+                config.timeout_seconds = std::stoi(value);
+            } else if (key == "keep_alive_timeout_seconds") {
+                config.keep_alive_timeout_seconds = std::stoi(value);
+            } else if (key == "thread_num") {
+                pool_config.core_threads = std::stoul(value);
+            } else if (key == "max_threads") {
+                pool_config.max_threads = std::stoul(value);
+            } else if (key == "max_tasks") {
+                pool_config.max_tasks = std::stoul(value);
+            } else if (key == "reject_policy") {
+                if (value == "reject") {
+                    pool_config.reject_policy = ThreadPool::RejectPolicy::REJECT;
+                } else if (value == "caller_runs") {
+                    pool_config.reject_policy = ThreadPool::RejectPolicy::CALLER_RUNS;
+                } else if (value == "drop_oldest") {
+                    pool_config.reject_policy = ThreadPool::RejectPolicy::DROP_OLDEST;
+                } else {
+                    pool_config.reject_policy = ThreadPool::RejectPolicy::BLOCK;
+                }
+            } else if (key == "block_timeout_ms") {
+                pool_config.block_timeout = std::chrono::milliseconds(std::stoul(value));
+            } else if (key == "keep_alive_seconds") {
+                pool_config.keep_alive_time = std::chrono::seconds(std::stoul(value));
+            } else if (key == "grow_threshold_ms") {
+                pool_config.grow_threshold = std::chrono::milliseconds(std::stoul(value));
+            } else if (key == "loop_threads") {
+                config.loop_threads = std::stoul(value);
+            } else if (key == "reactor_mode") {
+                if (value == "reuseport") {
+                    config.reactor_mode = WebServer::ReactorMode::REUSEPORT;
+                } else if (value == "acceptor") {
+                    config.reactor_mode = WebServer::ReactorMode::ACCEPTOR;
+                } else {
+                    config.reactor_mode = WebServer::ReactorMode::SINGLE;
+                }
+            } else if (key == "document_root") {
+                config.document_root = value;
+            } else if (key == "io_backend") {
+                config.io_backend = (value == "io_uring") ? EventLoop::Backend::IO_URING
+                                                          : EventLoop::Backend::EPOLL;
+            } else if (key == "zero_copy_parser") {
+                config.zero_copy_parser = (value != "false" && value != "0");
+            } else if (key == "pool_connections") {
+                config.pool_connections = (value != "false" && value != "0");
+            } else if (key == "connection_pool_size") {
+                config.connection_pool_size = std::stoul(value);
+            } else if (key == "body_memory_limit") {
+                config.body_memory_limit = std::stoul(value);
+            } else if (key == "max_body_size") {
+                config.max_body_size = std::stoull(value);
+            } else if (key == "body_spill_directory") {
+                config.body_spill_directory = value;
+            } else if (key == "handler_mode") {
+                if (value == "async") {
+                    config.handler_mode = WebServer::HandlerMode::ASYNC;
+                } else if (value == "adaptive") {
+                    config.handler_mode = WebServer::HandlerMode::ADAPTIVE;
+                } else {
+                    config.handler_mode = WebServer::HandlerMode::INLINE;
+                }
+            } else if (key == "inline_threshold_us") {
+                config.inline_threshold_us = std::stoul(value);
+            } else if (key == "max_tracked_routes") {
+                config.max_tracked_routes = std::stoul(value);
+            } else if (key == "load_balance") {
+                config.load_balance = (value == "least_connections")
+                                          ? WebServer::LoadBalance::LEAST_CONNECTIONS
+                                          : WebServer::LoadBalance::ROUND_ROBIN;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid config value: " << key << " = " << value << std::endl;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
     try {
-        // 创建事件循环
-        EventLoop event_loop;
-        
         // 创建连接管理器
         ConnectionManager conn_manager; 
         
-        // 创建线程池
-        ThreadPool thread_pool({4, 16, 1000, std::chrono::seconds(60)});
-        
         // 配置服务器
         WebServer::Config config;
         config.host = "127.0.0.1";
         config.port = 8222;
         config.max_connections = 1000;
         config.backlog = 1024;
+
+        ThreadPool::Config_thread_pool pool_config{4, 16, 1000, std::chrono::seconds(60)};
+        std::string config_path = argc > 1 ? argv[1] : "config/init.conf";
+        if (LoadServerConfig(config_path, config, pool_config)) {
+            std::cout << "Loaded config from " << config_path << std::endl;
+        }
+
+        // 创建事件循环（后端由配置决定，需在加载配置之后构造）
+        EventLoop event_loop(config.io_backend);
+
+        // 创建线程池
+        ThreadPool thread_pool(pool_config);
         
         // 启动服务器
         std::cout << "Starting HTTP server on " << config.host << ":" << config.port << std::endl;
         std::cout << "访问地址:  http://127.0.0.1:" <<config.port<<std::endl;
-        bool server_started = false;
-
          uint16_t original_port = config.port;
         bool port_found = false;
         if (conn_manager.IsPortAvailable(config.host, config.port)) {
@@ -67,6 +192,11 @@ int main() {
         
         // 设置信号处理
         server->SetSignalHandlers();
+
+        if (!server->Start()) {
+            std::cerr << "❌ 服务器启动失败" << std::endl;
+            return 1;
+        }
         
         // 服务器启动成功后再输出最终的访问地址
         std::cout << "✅ HTTP server successfully started on " << config.host << ":" << config.port << std::endl;
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ppserver {
+
+/**
+ * MemoryPool - 定长对象池
+ * 负责：为同一类型的对象（HttpRequest、HttpResponse）提供固定大小的内存槽，
+ *      避免每个请求都经过全局堆的new/delete
+ * 设计特点：每个线程持有自己的空闲链表，分配和释放只操作本线程链表，不加锁；
+ *          线程链表为空时从全局仓库一次取kBatchSize个，超过kMaxCached时归还一批，
+ *          只有这两种批量搬运才加锁；仓库不足时按chunk_size个槽整块向系统申请，
+ *          槽内存只在池销毁（且各线程缓存都已释放）后才归还系统。
+ *          对象可以在一个线程分配、另一个线程释放，槽进入释放线程的缓存。
+ *          池必须比从它分配的对象活得更久；进程级共享池见Instance()
+ */
+template <typename T>
+class MemoryPool {
+public:
+    static constexpr size_t kBatchSize = 32;                // 线程缓存与仓库之间一次搬运的槽数
+    static constexpr size_t kMaxCached = kBatchSize * 2;    // 线程缓存上限
+
+    struct Statistics {
+        size_t capacity = 0;        // 已向系统申请的槽总数
+        size_t free = 0;            // 空闲槽（仓库+各线程缓存）
+        size_t used = 0;            // 正在使用的对象数
+        size_t high_water = 0;      // 已分发给线程的槽数峰值（按批次计，不小于实际使用峰值）
+        uint64_t refills = 0;       // 线程缓存从仓库取批次的次数
+        uint64_t flushes = 0;       // 线程缓存向仓库归还批次的次数
+    };
+
+    explicit MemoryPool(size_t chunk_size = 1024)
+        : depot_(std::make_shared<Depot>(std::max(chunk_size, kBatchSize))) {
+    }
+
+    ~MemoryPool() {
+        // 其它线程的缓存仍引用仓库，由它们在下次访问或线程退出时释放
+        depot_->closed.store(true, std::memory_order_release);
+    }
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    // 进程级共享池，永不销毁（线程退出时的析构顺序不受影响）
+    static MemoryPool& Instance() {
+        static MemoryPool* pool = new MemoryPool();
+        return *pool;
+    }
+
+    // 分配/释放对象内存
+    template <typename... Args>
+    T* Construct(Args&&... args) {
+        void* memory = Allocate();
+        try {
+            return new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Deallocate(memory);
+            throw;
+        }
+    }
+
+    void Destroy(T* ptr) {
+        if (ptr) {
+            ptr->~T();
+            Deallocate(ptr);
+        }
+    }
+
+    // 未构造的槽，供需要自行placement new的调用方使用
+    void* Allocate() {
+        ThreadCache* cache = LocalCache();
+        if (!cache) {
+            return depot_->TakeOne();
+        }
+        if (!cache->head) {
+            depot_->Refill(*cache);
+        }
+        Slot* slot = cache->head;
+        cache->head = slot->next;
+        cache->count.store(cache->count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    void Deallocate(void* memory) {
+        Slot* slot = static_cast<Slot*>(memory);
+        ThreadCache* cache = LocalCache();
+        if (!cache) {
+            depot_->PutOne(slot);
+            return;
+        }
+        slot->next = cache->head;
+        cache->head = slot;
+        size_t count = cache->count.load(std::memory_order_relaxed) + 1;
+        cache->count.store(count, std::memory_order_relaxed);
+        if (count > kMaxCached) {
+            depot_->Flush(*cache, kBatchSize);
+        }
+    }
+
+    // 批量预分配，使槽总数至少为num_objects（提升性能）
+    void Preallocate(size_t num_objects) {
+        std::lock_guard<std::mutex> lock(depot_->mutex);
+        if (depot_->capacity < num_objects) {
+            depot_->Grow(num_objects - depot_->capacity);
+        }
+    }
+
+    // 统计信息
+    size_t GetFreeCount() const { return GetStatistics().free; }
+    size_t GetUsedCount() const { return GetStatistics().used; }
+    size_t GetHighWaterMark() const { return GetStatistics().high_water; }
+
+    Statistics GetStatistics() const {
+        std::lock_guard<std::mutex> lock(depot_->mutex);
+        size_t cached = 0;
+        for (const ThreadCache* cache : depot_->caches) {
+            cached += cache->count.load(std::memory_order_relaxed);
+        }
+        Statistics stats;
+        stats.capacity = depot_->capacity;
+        stats.free = depot_->free_count + cached;
+        stats.used = depot_->handed_out - cached;
+        stats.high_water = depot_->high_water;
+        stats.refills = depot_->refills;
+        stats.flushes = depot_->flushes;
+        return stats;
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Depot;
+
+    // 单个线程对单个池的空闲链表
+    struct ThreadCache {
+        explicit ThreadCache(std::shared_ptr<Depot> depot) : depot(std::move(depot)) {}
+        ~ThreadCache() { depot->Unregister(*this); }
+
+        std::shared_ptr<Depot> depot;
+        Slot* head = nullptr;
+        std::atomic<size_t> count{0};   // 只由所属线程写，统计时其它线程读
+    };
+
+    // 全局仓库：槽内存的所有者，池与各线程缓存共同持有
+    struct Depot {
+        explicit Depot(size_t chunk_size) : chunk_size(chunk_size) {}
+
+        // 以下调用时已持有mutex
+        void Grow(size_t slots) {
+            chunks.emplace_back(new Slot[slots]);
+            Slot* chunk = chunks.back().get();
+            for (size_t i = 0; i < slots; ++i) {
+                chunk[i].next = (i + 1 < slots) ? &chunk[i + 1] : free_list;
+            }
+            free_list = chunk;
+            free_count += slots;
+            capacity += slots;
+        }
+
+        void Give(size_t slots) {
+            handed_out += slots;
+            high_water = std::max(high_water, handed_out);
+        }
+
+        void Refill(ThreadCache& cache) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (free_count < kBatchSize) {
+                Grow(chunk_size);
+            }
+            Slot* first = free_list;
+            Slot* last = first;
+            for (size_t i = 1; i < kBatchSize; ++i) {
+                last = last->next;
+            }
+            free_list = last->next;
+            free_count -= kBatchSize;
+            last->next = cache.head;
+            cache.head = first;
+            cache.count.store(cache.count.load(std::memory_order_relaxed) + kBatchSize,
+                              std::memory_order_relaxed);
+            Give(kBatchSize);
+            ++refills;
+        }
+
+        void Flush(ThreadCache& cache, size_t slots) {
+            // 在锁外切下要归还的一段
+            Slot* first = cache.head;
+            Slot* last = first;
+            for (size_t i = 1; i < slots; ++i) {
+                last = last->next;
+            }
+            cache.head = last->next;
+            cache.count.store(cache.count.load(std::memory_order_relaxed) - slots,
+                              std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex);
+            last->next = free_list;
+            free_list = first;
+            free_count += slots;
+            handed_out -= slots;
+            ++flushes;
+        }
+
+        void Register(ThreadCache& cache) {
+            std::lock_guard<std::mutex> lock(mutex);
+            caches.push_back(&cache);
+        }
+
+        // 线程退出或池已销毁：缓存中的槽全部还给仓库
+        void Unregister(ThreadCache& cache) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t slots = cache.count.load(std::memory_order_relaxed);
+            while (cache.head) {
+                Slot* slot = cache.head;
+                cache.head = slot->next;
+                slot->next = free_list;
+                free_list = slot;
+            }
+            free_count += slots;
+            handed_out -= slots;
+            auto it = std::find(caches.begin(), caches.end(), &cache);
+            if (it != caches.end()) {
+                caches.erase(it);
+            }
+        }
+
+        // 线程局部存储已销毁后的慢路径
+        Slot* TakeOne() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!free_list) {
+                Grow(chunk_size);
+            }
+            Slot* slot = free_list;
+            free_list = slot->next;
+            --free_count;
+            Give(1);
+            return slot;
+        }
+
+        void PutOne(Slot* slot) {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot->next = free_list;
+            free_list = slot;
+            ++free_count;
+            --handed_out;
+        }
+
+        mutable std::mutex mutex;
+        Slot* free_list = nullptr;
+        size_t free_count = 0;
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        size_t chunk_size;
+        size_t capacity = 0;
+        size_t handed_out = 0;                  // 已分发给线程（含线程缓存中）的槽数
+        size_t high_water = 0;
+        uint64_t refills = 0;
+        uint64_t flushes = 0;
+        std::vector<const ThreadCache*> caches; // 已注册的线程缓存（统计用）
+        std::atomic<bool> closed{false};
+    };
+
+    // 本线程持有的各个池的缓存，线程退出时逐个归还
+    struct LocalCaches {
+        ~LocalCaches() { t_local_destroyed = true; }
+
+        std::vector<std::unique_ptr<ThreadCache>> caches;
+        ThreadCache* last = nullptr;            // 最近使用的缓存，通常只有一个池
+    };
+
+    // 线程退出阶段（其它线程局部对象析构时）可能返回nullptr，此时直接访问仓库
+    ThreadCache* LocalCache() {
+        if (t_local_destroyed) {
+            return nullptr;
+        }
+        LocalCaches& local = t_local_caches;
+        Depot* depot = depot_.get();
+        if (local.last && local.last->depot.get() == depot) {
+            return local.last;
+        }
+        local.last = nullptr;
+        for (auto it = local.caches.begin(); it != local.caches.end();) {
+            if ((*it)->depot.get() == depot) {
+                local.last = it->get();
+                return local.last;
+            }
+            if ((*it)->depot->closed.load(std::memory_order_acquire)) {
+                it = local.caches.erase(it);    // 池已销毁，释放对仓库的引用
+            } else {
+                ++it;
+            }
+        }
+        local.caches.push_back(std::make_unique<ThreadCache>(depot_));
+        local.last = local.caches.back().get();
+        depot->Register(*local.last);
+        return local.last;
+    }
+
+    static inline thread_local LocalCaches t_local_caches;
+    static inline thread_local bool t_local_destroyed = false;
+
+    std::shared_ptr<Depot> depot_;
+};
+
+} // namespace ppserver
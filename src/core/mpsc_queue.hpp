@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+
+namespace ppserver {
+
+/**
+ * MpscQueue - 无锁多生产者单消费者侵入式队列（Vyukov算法）
+ * 负责：跨线程向EventLoop投递任务
+ * 设计特点：Push只有一次exchange和一次store，无CAS重试；节点由调用方分配，
+ *          队列只串联节点的next指针。Node需包含成员 std::atomic<Node*> next
+ * 注意：生产者exchange之后、链接next之前的瞬间，Pop可能返回nullptr，
+ *      消费者需稍后重试（EventLoop用待处理计数保证不会因此睡眠）
+ */
+template <typename Node>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {
+        stub_.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // 任意线程调用
+    void Push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 仅消费者线程调用，队列为空（或生产者尚未完成链接）时返回nullptr
+    Node* Pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return nullptr;  // 有生产者正在入队
+        }
+        // tail是最后一个节点：放回stub，让tail可以被取出
+        Push(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+private:
+    alignas(64) std::atomic<Node*> head_;   // 生产者端
+    alignas(64) Node* tail_;                // 消费者端
+    Node stub_;
+};
+
+} // namespace ppserver
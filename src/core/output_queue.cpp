@@ -0,0 +1,167 @@
+#include "output_queue.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+
+namespace ppserver {
+
+FileHandle::~FileHandle() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+const char* OutputQueue::Segment::Data() const {
+    const std::string& str = (type == SegmentType::OWNED) ? owned : *shared;
+    return str.data() + offset;
+}
+
+OutputQueue::OutputQueue()
+    : total_bytes_(0),
+      memory_bytes_(0) {
+}
+
+void OutputQueue::Append(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    // 小块数据追加到末尾的自有段，避免每个小响应各占一个iovec
+    if (!segments_.empty() && len <= kCoalesceLimit) {
+        Segment& last = segments_.back();
+        if (last.type == SegmentType::OWNED && last.owned.size() + len <= kCoalesceLimit * 4) {
+            last.owned.append(data, len);
+            last.remaining += len;
+            total_bytes_ += len;
+            memory_bytes_ += len;
+            return;
+        }
+    }
+    Append(std::string(data, len));
+}
+
+void OutputQueue::Append(std::string data) {
+    if (data.empty()) {
+        return;
+    }
+    if (!segments_.empty() && data.size() <= kCoalesceLimit &&
+        segments_.back().type == SegmentType::OWNED) {
+        Append(data.data(), data.size());
+        return;
+    }
+    Segment segment;
+    segment.type = SegmentType::OWNED;
+    segment.remaining = data.size();
+    segment.owned = std::move(data);
+    total_bytes_ += segment.remaining;
+    memory_bytes_ += segment.remaining;
+    segments_.push_back(std::move(segment));
+}
+
+void OutputQueue::Append(std::shared_ptr<const std::string> data) {
+    if (!data || data->empty()) {
+        return;
+    }
+    Segment segment;
+    segment.type = SegmentType::SHARED;
+    segment.remaining = data->size();
+    segment.shared = std::move(data);
+    total_bytes_ += segment.remaining;
+    memory_bytes_ += segment.remaining;
+    segments_.push_back(std::move(segment));
+}
+
+void OutputQueue::AppendFile(std::shared_ptr<const FileHandle> file, off_t offset, size_t length) {
+    if (!file || length == 0) {
+        return;
+    }
+    Segment segment;
+    segment.type = SegmentType::FILE;
+    segment.file = std::move(file);
+    segment.offset = static_cast<size_t>(offset);
+    segment.remaining = length;
+    total_bytes_ += length;
+    segments_.push_back(std::move(segment));
+}
+
+ssize_t OutputQueue::Flush(int fd, uint64_t* calls) {
+    size_t written = 0;
+    while (!segments_.empty()) {
+        bool is_file = segments_.front().type == SegmentType::FILE;
+        ssize_t n = is_file ? WriteFile(fd) : WriteMemory(fd);
+        if (calls) {
+            ++*calls;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            break;   // 文件被截断等异常情况，避免死循环
+        }
+        Consume(static_cast<size_t>(n));
+        written += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(written);
+}
+
+ssize_t OutputQueue::WriteMemory(int fd) {
+    // 收集队首连续的内存段，遇到文件段为止
+    iovec iov[IOV_MAX];
+    int count = 0;
+    for (const Segment& segment : segments_) {
+        if (segment.type == SegmentType::FILE || count == IOV_MAX) {
+            break;
+        }
+        iov[count].iov_base = const_cast<char*>(segment.Data());
+        iov[count].iov_len = segment.remaining;
+        ++count;
+    }
+
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    // MSG_NOSIGNAL：对端已关闭时返回EPIPE而不是触发SIGPIPE
+    return sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+ssize_t OutputQueue::WriteFile(int fd) {
+    Segment& segment = segments_.front();
+    off_t offset = static_cast<off_t>(segment.offset);
+    // 单次sendfile上限约2GB，大文件分多次发送
+    size_t chunk = std::min<size_t>(segment.remaining, 0x7ffff000);
+    return sendfile(fd, segment.file->Fd(), &offset, chunk);
+}
+
+void OutputQueue::Consume(size_t n) {
+    total_bytes_ -= n;
+    while (n > 0) {
+        Segment& segment = segments_.front();
+        size_t step = std::min(n, segment.remaining);
+        segment.offset += step;
+        segment.remaining -= step;
+        if (segment.type != SegmentType::FILE) {
+            memory_bytes_ -= step;
+        }
+        n -= step;
+        if (segment.remaining == 0) {
+            segments_.pop_front();
+        }
+    }
+}
+
+void OutputQueue::Clear() {
+    segments_.clear();
+    total_bytes_ = 0;
+    memory_bytes_ = 0;
+}
+
+} // namespace ppserver
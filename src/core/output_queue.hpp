@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+namespace ppserver {
+
+/**
+ * FileHandle - 共享的只读文件描述符
+ * 负责：在多个待发送的文件段之间共享同一个打开的文件，最后一个引用释放时关闭
+ */
+class FileHandle {
+public:
+    explicit FileHandle(int fd) : fd_(fd) {}
+    ~FileHandle();
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    int Fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+/**
+ * OutputQueue - 连接输出队列
+ * 负责：按顺序缓存待发送的数据段，并尽量少次系统调用地写入socket
+ * 设计特点：段可以是自有字符串、共享只读缓冲（多个连接发送同一份数据无需拷贝）、
+ *          文件区间（sendfile零拷贝）；连续的内存段用sendmsg一次聚合写出，
+ *          每次至多IOV_MAX段；部分写入只移动段内偏移，不搬移数据
+ * 线程安全：非线程安全，只在连接所属loop线程内访问
+ */
+class OutputQueue {
+public:
+    OutputQueue();
+
+    void Append(const char* data, size_t len);
+    void Append(std::string data);
+    void Append(std::shared_ptr<const std::string> data);
+    void AppendFile(std::shared_ptr<const FileHandle> file, off_t offset, size_t length);
+
+    // 写到socket直到队列为空或EAGAIN；返回写出的字节数，出错返回-1（errno保留）
+    // calls累加本次使用的系统调用次数
+    ssize_t Flush(int fd, uint64_t* calls = nullptr);
+
+    bool Empty() const { return segments_.empty(); }
+    size_t Size() const { return total_bytes_; }             // 待发送的总字节数
+    size_t BufferedBytes() const { return memory_bytes_; }   // 其中占用内存的字节数（不含文件段）
+
+    void Clear();
+
+private:
+    // 小块自有数据合并进上一段的阈值，减少iovec数量
+    static constexpr size_t kCoalesceLimit = 4096;
+
+    enum class SegmentType : uint8_t { OWNED, SHARED, FILE };
+
+    struct Segment {
+        SegmentType type;
+        std::string owned;
+        std::shared_ptr<const std::string> shared;
+        std::shared_ptr<const FileHandle> file;
+        size_t offset = 0;      // 内存段：已发送字节数；文件段：下一次发送的文件偏移
+        size_t remaining = 0;   // 尚未发送的字节数
+
+        const char* Data() const;
+    };
+
+    ssize_t WriteMemory(int fd);
+    ssize_t WriteFile(int fd);
+    void Consume(size_t n);
+
+    std::deque<Segment> segments_;
+    size_t total_bytes_;
+    size_t memory_bytes_;
+};
+
+} // namespace ppserver
@@ -0,0 +1,109 @@
+#include "request_arena.hpp"
+#include <new>
+#include <vector>
+
+namespace ppserver {
+
+namespace {
+
+// 每个loop线程一个空闲块链；块在哪个线程归还就进哪个线程的池
+struct BlockPool {
+    std::vector<void*> blocks;
+
+    ~BlockPool();
+};
+
+thread_local BlockPool t_block_pool;
+thread_local bool t_block_pool_destroyed = false;   // 线程退出时池可能先于连接析构
+
+BlockPool::~BlockPool() {
+    t_block_pool_destroyed = true;
+    for (void* block : blocks) {
+        ::operator delete(block);
+    }
+}
+
+} // namespace
+
+RequestArena::RequestArena()
+    : block_(nullptr),
+      live_objects_(0),
+      reset_pending_(false) {
+}
+
+RequestArena::~RequestArena() {
+    resource_.reset();
+    if (block_) {
+        ReleaseBlock(block_);
+    }
+}
+
+std::pmr::memory_resource* RequestArena::Resource() {
+    if (!resource_) {
+        block_ = AcquireBlock();
+        // 块用完后向全局堆申请后续缓冲（按几何级数增长），Reset时统一释放
+        resource_.emplace(block_, kBlockSize, std::pmr::new_delete_resource());
+    }
+    return &*resource_;
+}
+
+void RequestArena::Release() {
+    if (--live_objects_ == 0 && reset_pending_) {
+        ReleaseAll();
+    }
+}
+
+bool RequestArena::Reset() {
+    if (!resource_) {
+        return true;
+    }
+    if (live_objects_ > 0) {
+        // 如流水线上后一个请求已开始解析，等它随对象一起释放
+        if (!reset_pending_) {
+            reset_pending_ = true;
+            ++stats_.deferred_resets;
+        }
+        return false;
+    }
+    ReleaseAll();
+    return true;
+}
+
+void RequestArena::ReleaseAll() {
+    reset_pending_ = false;
+    if (!resource_) {
+        return;
+    }
+    resource_.reset();
+    ReleaseBlock(block_);
+    block_ = nullptr;
+    ++stats_.resets;
+}
+
+void* RequestArena::AcquireBlock() {
+    if (t_block_pool_destroyed) {
+        return ::operator new(kBlockSize);
+    }
+    std::vector<void*>& blocks = t_block_pool.blocks;
+    if (!blocks.empty()) {
+        void* block = blocks.back();
+        blocks.pop_back();
+        return block;
+    }
+    return ::operator new(kBlockSize);
+}
+
+void RequestArena::ReleaseBlock(void* block) {
+    if (t_block_pool_destroyed) {
+        ::operator delete(block);
+        return;
+    }
+    std::vector<void*>& blocks = t_block_pool.blocks;
+    if (blocks.size() < kMaxPooledBlocks) {
+        blocks.push_back(block);
+        return;
+    }
+    ::operator delete(block);
+}
+
+} // namespace ppserver
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+
+namespace ppserver {
+
+/**
+ * RequestArena - 单个连接上在途请求的单调内存区
+ * 负责：为HttpRequest（对象本身、路径、头部、正文、查询参数）和出错响应提供内存，
+ *      响应发送完毕、没有存活的请求对象时一步整体归还
+ * 设计特点：底层是std::pmr::monotonic_buffer_resource，分配只移动指针，释放为空操作；
+ *          初始内存块取自所在线程的块池（首次分配时才取，空闲连接不占用），
+ *          超出块大小的部分向全局堆申请，Reset时一起释放；
+ *          通过Hold/Release统计仍引用区内内存的对象数，不为0时Reset推迟到最后一个对象释放时。
+ *          只在连接所属loop线程内使用，非线程安全
+ */
+class RequestArena {
+public:
+    static constexpr size_t kBlockSize = 16 * 1024;      // 池化块大小，覆盖常见请求及浅流水线
+    static constexpr size_t kMaxPooledBlocks = 256;      // 每个线程最多缓存的空闲块数
+
+    struct Statistics {
+        uint64_t resets = 0;           // 实际归还次数
+        uint64_t deferred_resets = 0;  // 因仍有存活对象而推迟的次数
+    };
+
+    RequestArena();
+    ~RequestArena();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    // 首次调用时从块池取块并建立单调资源
+    std::pmr::memory_resource* Resource();
+
+    // 区内对象的生命周期计数（HttpRequestPtr的删除器调用Release）
+    void Hold() { ++live_objects_; }
+    void Release();
+    size_t LiveObjects() const { return live_objects_; }
+
+    // 释放全部内存并把块还给块池；仍有存活对象时推迟，返回是否已立即归还
+    bool Reset();
+    bool InUse() const { return resource_.has_value(); }
+
+    // 栈上使用区内内存的临时对象（如出错响应）的计数守卫，应先于这些对象构造
+    class Lease {
+    public:
+        explicit Lease(RequestArena& arena) : arena_(arena) { arena_.Hold(); }
+        ~Lease() { arena_.Release(); }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+    private:
+        RequestArena& arena_;
+    };
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+private:
+    static void* AcquireBlock();
+    static void ReleaseBlock(void* block);
+
+    void ReleaseAll();
+
+    void* block_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    size_t live_objects_;
+    bool reset_pending_;
+    Statistics stats_;
+};
+
+} // namespace ppserver
@@ -0,0 +1,168 @@
+#include "request_body.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ppserver {
+
+namespace {
+
+std::string& SpillDirectory() {
+    static std::string directory = "/tmp";
+    return directory;
+}
+
+} // namespace
+
+RequestBody::RequestBody(std::pmr::memory_resource* resource)
+    : memory_(resource),
+      memory_limit_(kDefaultMemoryLimit),
+      fd_(-1),
+      file_size_(0) {
+}
+
+RequestBody::~RequestBody() {
+    CloseFile();
+}
+
+RequestBody::RequestBody(RequestBody&& other) noexcept
+    : memory_(std::move(other.memory_)),
+      memory_limit_(other.memory_limit_),
+      fd_(other.fd_),
+      file_size_(other.file_size_) {
+    other.fd_ = -1;
+    other.file_size_ = 0;
+}
+
+RequestBody& RequestBody::operator=(RequestBody&& other) noexcept {
+    if (this != &other) {
+        CloseFile();
+        memory_ = std::move(other.memory_);
+        memory_limit_ = other.memory_limit_;
+        fd_ = other.fd_;
+        file_size_ = other.file_size_;
+        other.fd_ = -1;
+        other.file_size_ = 0;
+    }
+    return *this;
+}
+
+void RequestBody::SetSpillDirectory(const std::string& directory) {
+    SpillDirectory() = directory.empty() ? "/tmp" : directory;
+}
+
+const std::string& RequestBody::GetSpillDirectory() {
+    return SpillDirectory();
+}
+
+void RequestBody::Reserve(size_t length) {
+    memory_.reserve(std::min(length, memory_limit_));
+}
+
+void RequestBody::Append(const char* data, size_t length) {
+    if (fd_ < 0) {
+        size_t room = memory_limit_ > memory_.size() ? memory_limit_ - memory_.size() : 0;
+        if (length <= room) {
+            memory_.append(data, length);
+            return;
+        }
+        // 内存部分填满，剩余写入临时文件
+        memory_.append(data, room);
+        data += room;
+        length -= room;
+        Spill();
+    }
+    WriteFile(data, length);
+}
+
+void RequestBody::Assign(std::string_view data) {
+    Clear();
+    Append(data.data(), data.size());
+}
+
+void RequestBody::Clear() {
+    memory_.clear();
+    CloseFile();
+}
+
+size_t RequestBody::Read(size_t offset, char* buffer, size_t length) const {
+    size_t copied = 0;
+    if (offset < memory_.size()) {
+        copied = std::min(length, memory_.size() - offset);
+        std::memcpy(buffer, memory_.data() + offset, copied);
+    }
+    if (copied == length || fd_ < 0) {
+        return copied;
+    }
+    size_t file_offset = offset + copied - memory_.size();
+    while (copied < length && file_offset < file_size_) {
+        ssize_t n = ::pread(fd_, buffer + copied, std::min(length - copied, file_size_ - file_offset),
+                            static_cast<off_t>(file_offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to read request body: " + std::string(strerror(errno)));
+        }
+        if (n == 0) {
+            break;
+        }
+        copied += static_cast<size_t>(n);
+        file_offset += static_cast<size_t>(n);
+    }
+    return copied;
+}
+
+std::string RequestBody::ReadAll() const {
+    std::string body(size(), '\0');
+    body.resize(Read(0, body.data(), body.size()));
+    return body;
+}
+
+void RequestBody::Spill() {
+    const std::string& directory = SpillDirectory();
+#ifdef O_TMPFILE
+    // 匿名临时文件：不出现在目录中，fd关闭即回收
+    fd_ = ::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+#endif
+    if (fd_ < 0) {
+        // 文件系统不支持O_TMPFILE时退回mkstemp + unlink
+        std::string path = directory + "/ppserver-body-XXXXXX";
+        fd_ = ::mkostemp(path.data(), O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to create request body file in " + directory + ": " +
+                                     std::string(strerror(errno)));
+        }
+        ::unlink(path.c_str());
+    }
+    file_size_ = 0;
+}
+
+void RequestBody::WriteFile(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd_, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to write request body: " + std::string(strerror(errno)));
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+        file_size_ += static_cast<size_t>(n);
+    }
+}
+
+void RequestBody::CloseFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    file_size_ = 0;
+}
+
+} // namespace ppserver
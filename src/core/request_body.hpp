@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace ppserver {
+
+// 正文分段回调：chunk为本次到达的正文数据（只在回调期间有效），last为true时正文结束（chunk可能为空）。
+// 返回false表示消费方处理不过来：本段已被接受，连接暂停读取，直到调用Connection::ResumeReading
+using BodyChunkCallback = std::function<bool(std::string_view chunk, bool last)>;
+
+/**
+ * RequestBody - 请求正文
+ * 负责：保存请求正文，前memory_limit字节放在内存中，超出部分写入临时文件
+ * 设计特点：内存部分使用构造时给定的memory_resource（如连接的RequestArena）；
+ *          临时文件在溢出时才创建，创建后立即unlink（优先O_TMPFILE），
+ *          只通过fd访问，进程退出或Clear/析构时由内核回收；
+ *          大上传占用的内存因此不超过memory_limit
+ */
+class RequestBody {
+public:
+    static constexpr size_t kDefaultMemoryLimit = 64 * 1024;
+
+    explicit RequestBody(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~RequestBody();
+
+    RequestBody(const RequestBody&) = delete;
+    RequestBody& operator=(const RequestBody&) = delete;
+    RequestBody(RequestBody&& other) noexcept;
+    RequestBody& operator=(RequestBody&& other) noexcept;
+
+    // 溢出临时文件所在目录，进程级设置（启动时、服务线程开始前设置）
+    static void SetSpillDirectory(const std::string& directory);
+    static const std::string& GetSpillDirectory();
+
+    // 内存部分上限，须在写入数据之前设置
+    void SetMemoryLimit(size_t limit) { memory_limit_ = limit; }
+    size_t GetMemoryLimit() const { return memory_limit_; }
+    // 预留内存部分（不超过memory_limit）
+    void Reserve(size_t length);
+
+    // 追加数据，写临时文件失败时抛出std::runtime_error
+    void Append(const char* data, size_t length);
+    void Assign(std::string_view data);
+    void Clear();
+
+    size_t size() const { return memory_.size() + file_size_; }
+    bool empty() const { return size() == 0; }
+    bool IsSpilled() const { return fd_ >= 0; }
+
+    // 内存中的部分；未溢出时即完整正文
+    std::string_view GetMemoryPart() const { return memory_; }
+    // 溢出文件的fd与长度（文件内容从正文的GetMemoryPart().size()偏移处开始），未溢出时为-1/0
+    int GetSpillFd() const { return fd_; }
+    size_t GetSpillSize() const { return file_size_; }
+
+    // 从正文offset处读取至多length字节，返回实际读取的字节数；读文件失败时抛出std::runtime_error
+    size_t Read(size_t offset, char* buffer, size_t length) const;
+    // 读出完整正文（溢出时会把文件内容读回内存，只适合已知不大的正文）
+    std::string ReadAll() const;
+
+private:
+    void Spill();
+    void WriteFile(const char* data, size_t length);
+    void CloseFile();
+
+    std::pmr::string memory_;
+    size_t memory_limit_;
+    int fd_;
+    size_t file_size_;
+};
+
+} // namespace ppserver
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+
+namespace ppserver {
+
+class HttpRequestView;
+class HttpResponse;
+
+// 业务处理函数：填写response并返回true；返回false时回复静态文件/默认页面。
+// 处理函数抛出的异常记录日志后回复500
+using RequestHandler = std::function<bool(const HttpRequestView& request, HttpResponse& response)>;
+
+// 业务处理函数的执行位置
+enum class HandlerMode {
+    INLINE,     // 在连接所属的loop线程内执行（处理函数须足够快，否则阻塞该loop上的所有连接）
+    ASYNC,      // 在ThreadPool中执行，响应交回loop发送；同一连接的流水线请求依次处理
+    ADAPTIVE    // 按路由测量耗时（见RouteCostTracker），p99低于阈值的在loop线程内执行，其余同ASYNC
+};
+
+} // namespace ppserver
@@ -0,0 +1,164 @@
+#include "route_cost_tracker.hpp"
+
+#include <algorithm>
+
+namespace ppserver {
+
+RouteCostTracker::RouteCostTracker(const Config& config)
+    : config_(config),
+      threshold_ns_(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(config.inline_threshold).count())),
+      overflow_(HttpRequest::Method::UNKNOWN, "*") {
+}
+
+RouteCostTracker::Route& RouteCostTracker::Find(HttpRequest::Method method, std::string_view path) {
+    // 查找只在loop线程内进行，与同线程的插入不会并发，不加锁；string_view作键，不分配内存
+    auto it = routes_.find(path);
+    if (it != routes_.end()) {
+        for (const auto& route : it->second) {
+            if (route->method_ == method) {
+                return *route;
+            }
+        }
+    }
+    if (route_count_ >= config_.max_routes) {
+        return overflow_;
+    }
+
+    std::unique_ptr<Route> route(new Route(method, std::string(path)));
+    Route& result = *route;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (it == routes_.end()) {
+        it = routes_.emplace(std::string_view(result.path_), std::vector<std::unique_ptr<Route>>()).first;
+    }
+    it->second.push_back(std::move(route));
+    ++route_count_;
+    return result;
+}
+
+void RouteCostTracker::Record(Route& route, std::chrono::nanoseconds elapsed, bool ran_inline) {
+    (ran_inline ? inline_requests_ : offloaded_requests_).fetch_add(1, std::memory_order_relaxed);
+    route.samples_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t ns = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+    ++route.buckets_[BucketIndex(ns)];
+    if (++route.window_samples_ >= kDecayWindow) {
+        // 衰减：各桶减半，较早的样本权重逐窗口降低
+        uint32_t total = 0;
+        for (uint32_t& count : route.buckets_) {
+            count >>= 1;
+            total += count;
+        }
+        route.window_samples_ = total;
+    }
+    if (++route.since_evaluate_ >= kEvaluateInterval) {
+        route.since_evaluate_ = 0;
+        Evaluate(route);
+    }
+}
+
+void RouteCostTracker::Evaluate(Route& route) {
+    uint64_t p99 = EstimateP99(route);
+    route.p99_ns_.store(p99, std::memory_order_relaxed);
+    bool fast = p99 <= threshold_ns_;
+
+    if (route.IsInline()) {
+        if (!fast) {
+            // 变慢立即交给线程池，不再阻塞loop
+            route.inline_.store(false, std::memory_order_relaxed);
+            route.switches_.fetch_add(1, std::memory_order_relaxed);
+            inline_routes_.fetch_sub(1, std::memory_order_relaxed);
+            switches_to_offload_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (!fast) {
+        route.fast_evaluations_ = 0;
+        return;
+    }
+    if (++route.fast_evaluations_ >= kStableEvaluations) {
+        route.fast_evaluations_ = 0;
+        route.inline_.store(true, std::memory_order_relaxed);
+        route.switches_.fetch_add(1, std::memory_order_relaxed);
+        inline_routes_.fetch_add(1, std::memory_order_relaxed);
+        switches_to_inline_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint64_t RouteCostTracker::EstimateP99(const Route& route) {
+    // 从最慢的桶往下累计，覆盖最慢的1%样本的那个桶的上界即p99估计
+    uint64_t tail = (static_cast<uint64_t>(route.window_samples_) + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = kBuckets; i-- > 0;) {
+        seen += route.buckets_[i];
+        if (seen >= tail && seen > 0) {
+            return BucketUpperBound(i);
+        }
+    }
+    return 0;
+}
+
+size_t RouteCostTracker::BucketIndex(uint64_t ns) {
+    if (ns < kSubBuckets) {
+        return static_cast<size_t>(ns);
+    }
+    // 最高位所在的2的幂区间再按其后两位细分
+    size_t msb = 63 - static_cast<size_t>(__builtin_clzll(ns));
+    size_t index = (msb - 1) * kSubBuckets + static_cast<size_t>((ns >> (msb - 2)) & (kSubBuckets - 1));
+    return std::min(index, kBuckets - 1);
+}
+
+uint64_t RouteCostTracker::BucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index + 1;
+    }
+    size_t msb = index / kSubBuckets + 1;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub + 1) << (msb - 2);
+}
+
+RouteCostTracker::RouteStatistics RouteCostTracker::Snapshot(const Route& route) {
+    RouteStatistics stats;
+    stats.method = route.method_;
+    stats.path = route.path_;
+    stats.inline_mode = route.IsInline();
+    stats.p99_ns = route.p99_ns_.load(std::memory_order_relaxed);
+    stats.samples = route.samples_.load(std::memory_order_relaxed);
+    stats.switches = route.switches_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+RouteCostTracker::Statistics RouteCostTracker::GetStatistics() const {
+    Statistics stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.routes = route_count_;
+    }
+    if (overflow_.samples_.load(std::memory_order_relaxed) > 0) {
+        ++stats.routes;
+    }
+    stats.inline_routes = std::min(inline_routes_.load(std::memory_order_relaxed), stats.routes);
+    stats.offloaded_routes = stats.routes - stats.inline_routes;
+    stats.switches_to_inline = switches_to_inline_.load(std::memory_order_relaxed);
+    stats.switches_to_offload = switches_to_offload_.load(std::memory_order_relaxed);
+    stats.inline_requests = inline_requests_.load(std::memory_order_relaxed);
+    stats.offloaded_requests = offloaded_requests_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::vector<RouteCostTracker::RouteStatistics> RouteCostTracker::GetRouteStatistics() const {
+    std::vector<RouteStatistics> result;
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(route_count_ + 1);
+    for (const auto& [path, methods] : routes_) {
+        for (const auto& route : methods) {
+            result.push_back(Snapshot(*route));
+        }
+    }
+    if (overflow_.samples_.load(std::memory_order_relaxed) > 0) {
+        result.push_back(Snapshot(overflow_));
+    }
+    return result;
+}
+
+} // namespace ppserver
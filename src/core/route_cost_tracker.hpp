@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "http_request.hpp"
+
+namespace ppserver {
+
+/**
+ * RouteCostTracker - 按路由统计业务处理函数的耗时并决定其执行位置
+ * 负责：HandlerMode::ADAPTIVE下为每个（方法，路径）维护耗时的衰减直方图，估计p99，
+ *      p99低于阈值的路由在loop线程内执行，其余交给ThreadPool
+ * 设计特点：每个IO线程一个实例（同StaticFileHandler），查找、记录与分类都只在所属loop线程内进行，不加锁；
+ *          交给线程池的请求在工作线程内计时，响应交回loop时再记录。
+ *          直方图按纳秒对数分桶（每个2的幂再分kSubBuckets份），窗口内样本达到kDecayWindow时各桶减半，
+ *          估计值主要反映最近的样本；每kEvaluateInterval个样本重新估计一次p99：
+ *          超过阈值立即改为交给线程池（保护loop），低于阈值须连续kStableEvaluations次才改回loop线程内执行。
+ *          新路由先交给线程池，攒够样本后再分类；路由数达到max_routes后新出现的路径共用一个溢出条目。
+ *          统计计数为原子变量，可在其它线程读取（近似值）
+ */
+class RouteCostTracker {
+public:
+    static constexpr size_t kSubBuckets = 4;
+    static constexpr size_t kBuckets = 160;             // 覆盖到约2^40纳秒，更慢的样本计入最后一个桶
+    static constexpr uint32_t kDecayWindow = 256;
+    static constexpr uint32_t kEvaluateInterval = 32;
+    static constexpr uint32_t kStableEvaluations = 2;
+
+    struct Config {
+        std::chrono::microseconds inline_threshold{100};   // p99低于该值的路由在loop线程内执行
+        size_t max_routes = 1024;                          // 单独统计的路由数上限
+    };
+
+    // 一个（方法，路径）的耗时直方图与当前分类
+    class Route {
+    public:
+        bool IsInline() const { return inline_.load(std::memory_order_relaxed); }
+
+    private:
+        friend class RouteCostTracker;
+
+        Route(HttpRequest::Method method, std::string path) : method_(method), path_(std::move(path)) {}
+
+        HttpRequest::Method method_;
+        std::string path_;
+        std::array<uint32_t, kBuckets> buckets_{};
+        uint32_t window_samples_ = 0;       // 窗口内（衰减后）的样本数
+        uint32_t since_evaluate_ = 0;       // 上次估计p99之后的样本数
+        uint32_t fast_evaluations_ = 0;     // 交给线程池期间连续低于阈值的估计次数
+        std::atomic<bool> inline_{false};
+        std::atomic<uint64_t> p99_ns_{0};
+        std::atomic<uint64_t> samples_{0};
+        std::atomic<uint64_t> switches_{0};
+    };
+
+    struct RouteStatistics {
+        HttpRequest::Method method = HttpRequest::Method::UNKNOWN;
+        std::string path;                   // 溢出条目为"*"
+        bool inline_mode = false;           // 当前在loop线程内执行
+        uint64_t p99_ns = 0;                // 最近一次估计的p99（桶上界）
+        uint64_t samples = 0;               // 累计样本数
+        uint64_t switches = 0;              // 分类切换次数
+    };
+
+    struct Statistics {
+        size_t routes = 0;                  // 已统计的路由数（溢出条目有样本时计入）
+        size_t inline_routes = 0;           // 当前在loop线程内执行的路由数
+        size_t offloaded_routes = 0;        // 当前交给线程池的路由数
+        uint64_t switches_to_inline = 0;    // 改为loop线程内执行的次数
+        uint64_t switches_to_offload = 0;   // 改为交给线程池的次数
+        uint64_t inline_requests = 0;       // 在loop线程内执行的请求数
+        uint64_t offloaded_requests = 0;    // 交给线程池执行的请求数
+    };
+
+    explicit RouteCostTracker(const Config& config);
+
+    RouteCostTracker(const RouteCostTracker&) = delete;
+    RouteCostTracker& operator=(const RouteCostTracker&) = delete;
+
+    // 查找或创建路由条目（loop线程），条目在tracker销毁前一直有效；path不含查询串
+    Route& Find(HttpRequest::Method method, std::string_view path);
+    // 记录一次处理函数的耗时（loop线程），必要时重新分类
+    void Record(Route& route, std::chrono::nanoseconds elapsed, bool ran_inline);
+
+    Statistics GetStatistics() const;
+    std::vector<RouteStatistics> GetRouteStatistics() const;
+
+    static size_t BucketIndex(uint64_t ns);
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    void Evaluate(Route& route);
+    static uint64_t EstimateP99(const Route& route);
+    static RouteStatistics Snapshot(const Route& route);
+
+    Config config_;
+    uint64_t threshold_ns_;
+    // 键引用Route::path_；只有loop线程修改，修改与跨线程快照都持有mutex_
+    std::unordered_map<std::string_view, std::vector<std::unique_ptr<Route>>> routes_;
+    size_t route_count_ = 0;
+    Route overflow_;
+    mutable std::mutex mutex_;
+
+    std::atomic<size_t> inline_routes_{0};
+    std::atomic<uint64_t> switches_to_inline_{0};
+    std::atomic<uint64_t> switches_to_offload_{0};
+    std::atomic<uint64_t> inline_requests_{0};
+    std::atomic<uint64_t> offloaded_requests_{0};
+};
+
+} // namespace ppserver
@@ -0,0 +1,288 @@
+#include "router.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include "http_request_view.hpp"
+#include "http_response.hpp"
+
+namespace ppserver {
+
+// 树节点：prefix为从父节点到本节点的静态边；参数节点的边为一整段路径，不存prefix
+struct Router::Node {
+    std::string prefix;
+    std::string indices;                            // 各静态子节点prefix的首字符，与children一一对应
+    std::vector<std::unique_ptr<Node>> children;    // 静态子节点
+    std::unique_ptr<Node> param;                    // :name子节点
+    std::unique_ptr<Node> wildcard;                 // *name子节点（叶子）
+    std::string name;                               // 参数节点的参数名
+    const Route* route = nullptr;                   // 在本节点结束的路由
+};
+
+std::string_view RouteParams::Get(std::string_view name) const {
+    for (size_t i = 0; i < count_; ++i) {
+        if (params_[i].name == name) {
+            return params_[i].value;
+        }
+    }
+    return std::string_view();
+}
+
+void RouteParams::Rebase(std::string_view from, std::string_view to) {
+    for (size_t i = 0; i < count_; ++i) {
+        std::string_view& value = params_[i].value;
+        if (value.data() >= from.data() && value.data() + value.size() <= from.data() + from.size()) {
+            value = to.substr(static_cast<size_t>(value.data() - from.data()), value.size());
+        }
+    }
+}
+
+Router::Router() = default;
+Router::~Router() = default;
+
+void Router::Add(HttpRequest::Method method, std::string_view pattern, Handler handler) {
+    if (method == HttpRequest::Method::UNKNOWN) {
+        throw std::runtime_error("Route method is unknown: " + std::string(pattern));
+    }
+    if (pattern.empty() || pattern.front() != '/') {
+        throw std::runtime_error("Route pattern must start with '/': " + std::string(pattern));
+    }
+    if (!handler) {
+        throw std::runtime_error("Route handler is empty: " + std::string(pattern));
+    }
+
+    auto route = std::make_unique<Route>(Route{method, std::string(pattern), std::move(handler)});
+    // 先解析并检查整个模式、再确认与已有路由不冲突，之后才修改树：抛出异常时树保持不变
+    std::vector<Segment> segments = ParsePattern(route->pattern);
+    std::unique_ptr<Node>& root = trees_[static_cast<size_t>(method)];
+    if (root) {
+        CheckConflicts(*root, segments, route->pattern);
+    } else {
+        root = std::make_unique<Node>();
+    }
+
+    Node* node = root.get();
+    for (const Segment& segment : segments) {
+        switch (segment.kind) {
+            case Segment::Kind::STATIC:
+                node = InsertStatic(node, segment.text);
+                break;
+            case Segment::Kind::PARAM:
+                if (!node->param) {
+                    node->param = std::make_unique<Node>();
+                    node->param->name = std::string(segment.text);
+                }
+                node = node->param.get();
+                break;
+            case Segment::Kind::WILDCARD:
+                node->wildcard = std::make_unique<Node>();
+                node->wildcard->name = std::string(segment.text);
+                node = node->wildcard.get();
+                break;
+        }
+    }
+    node->route = route.get();
+    routes_.push_back(std::move(route));
+}
+
+std::vector<Router::Segment> Router::ParsePattern(const std::string& pattern) {
+    std::vector<Segment> segments;
+    std::string_view rest = pattern;
+    size_t params = 0;
+    while (!rest.empty()) {
+        size_t special = rest.find_first_of(":*");
+        if (special != 0) {
+            size_t length = std::min(special, rest.size());
+            segments.push_back(Segment{Segment::Kind::STATIC, rest.substr(0, length)});
+            rest.remove_prefix(length);
+            continue;
+        }
+
+        // 参数只能占据以/分隔的整段
+        size_t offset = pattern.size() - rest.size();
+        if (pattern[offset - 1] != '/') {
+            throw std::runtime_error("Route parameter must follow '/': " + pattern);
+        }
+        size_t end = rest.find('/');
+        std::string_view name = rest.substr(1, end == std::string_view::npos ? end : end - 1);
+        if (name.empty() || name.find_first_of(":*") != std::string_view::npos) {
+            throw std::runtime_error("Route parameter name is invalid: " + pattern);
+        }
+        if (++params > RouteParams::kMaxParams) {
+            throw std::runtime_error("Route has too many parameters: " + pattern);
+        }
+
+        if (rest.front() == ':') {
+            segments.push_back(Segment{Segment::Kind::PARAM, name});
+            rest.remove_prefix(std::min(end, rest.size()));
+        } else {
+            if (end != std::string_view::npos) {
+                throw std::runtime_error("Route wildcard must be the last segment: " + pattern);
+            }
+            segments.push_back(Segment{Segment::Kind::WILDCARD, name});
+            rest = std::string_view();
+        }
+    }
+    return segments;
+}
+
+void Router::CheckConflicts(const Node& root, const std::vector<Segment>& segments, const std::string& pattern) {
+    // 沿已有节点只读地走一遍；走到需要新建节点处即不会再冲突
+    const Node* node = &root;
+    for (const Segment& segment : segments) {
+        switch (segment.kind) {
+            case Segment::Kind::STATIC:
+                node = FindStatic(*node, segment.text);
+                break;
+            case Segment::Kind::PARAM:
+                if (node->param && node->param->name != segment.text) {
+                    throw std::runtime_error("Route parameter :" + std::string(segment.text) + " conflicts with :" +
+                                             node->param->name + ": " + pattern);
+                }
+                node = node->param.get();
+                break;
+            case Segment::Kind::WILDCARD:
+                if (node->wildcard) {
+                    throw std::runtime_error("Route wildcard conflicts with an existing route: " + pattern);
+                }
+                return;
+        }
+        if (!node) {
+            return;
+        }
+    }
+    if (node->route) {
+        throw std::runtime_error("Route is already registered: " + pattern);
+    }
+}
+
+const Router::Node* Router::FindStatic(const Node& node, std::string_view text) {
+    const Node* current = &node;
+    while (!text.empty()) {
+        size_t index = current->indices.find(text.front());
+        if (index == std::string::npos) {
+            return nullptr;
+        }
+        const Node& child = *current->children[index];
+        // 在边的中间结束或分叉：插入时会拆出新节点
+        if (text.compare(0, child.prefix.size(), child.prefix) != 0) {
+            return nullptr;
+        }
+        current = &child;
+        text.remove_prefix(child.prefix.size());
+    }
+    return current;
+}
+
+Router::Node* Router::InsertStatic(Node* node, std::string_view text) {
+    while (!text.empty()) {
+        size_t index = node->indices.find(text.front());
+        if (index == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix = std::string(text);
+            node->indices.push_back(text.front());
+            node->children.push_back(std::move(child));
+            return node->children.back().get();
+        }
+
+        Node* child = node->children[index].get();
+        size_t common = 0;
+        size_t limit = std::min(text.size(), child->prefix.size());
+        while (common < limit && text[common] == child->prefix[common]) {
+            ++common;
+        }
+        if (common < child->prefix.size()) {
+            // 边在中间分叉：拆出公共前缀作为新节点，原子节点挂在其下
+            auto split = std::make_unique<Node>();
+            split->prefix = child->prefix.substr(0, common);
+            child->prefix.erase(0, common);
+            split->indices.push_back(child->prefix.front());
+            split->children.push_back(std::move(node->children[index]));
+            node->children[index] = std::move(split);
+            child = node->children[index].get();
+        }
+        node = child;
+        text.remove_prefix(common);
+    }
+    return node;
+}
+
+void Router::Use(Middleware middleware) {
+    if (middleware) {
+        middlewares_.push_back(std::move(middleware));
+    }
+}
+
+const Router::Route* Router::Match(HttpRequest::Method method, std::string_view path,
+                                   RouteParams& params) const {
+    params.Clear();
+    if (method == HttpRequest::Method::UNKNOWN) {
+        return nullptr;
+    }
+    const Node* root = trees_[static_cast<size_t>(method)].get();
+    return root ? MatchNode(*root, path, params) : nullptr;
+}
+
+const Router::Route* Router::MatchNode(const Node& node, std::string_view path, RouteParams& params) {
+    if (path.empty()) {
+        if (node.route) {
+            return node.route;
+        }
+        if (node.wildcard) {
+            params.Push(node.wildcard->name, path);
+            return node.wildcard->route;
+        }
+        return nullptr;
+    }
+
+    // 静态片段优先；失败时回溯到参数与通配
+    size_t index = node.indices.find(path.front());
+    if (index != std::string::npos) {
+        const Node& child = *node.children[index];
+        if (path.compare(0, child.prefix.size(), child.prefix) == 0) {
+            if (const Route* route = MatchNode(child, path.substr(child.prefix.size()), params)) {
+                return route;
+            }
+        }
+    }
+    if (node.param) {
+        std::string_view segment = path.substr(0, path.find('/'));
+        if (!segment.empty()) {
+            params.Push(node.param->name, segment);
+            if (const Route* route = MatchNode(*node.param, path.substr(segment.size()), params)) {
+                return route;
+            }
+            params.Pop();
+        }
+    }
+    if (node.wildcard) {
+        params.Push(node.wildcard->name, path);
+        return node.wildcard->route;
+    }
+    return nullptr;
+}
+
+bool Router::Dispatch(const HttpRequestView& request, HttpResponse& response) const {
+    RouteParams params;
+    const Route* route = Match(request.GetMethod(), PathOf(request.GetPath()), params);
+    return Dispatch(request, route, params, response);
+}
+
+bool Router::Dispatch(const HttpRequestView& request, const Route* route, const RouteParams& params,
+                      HttpResponse& response) const {
+    for (const Middleware& middleware : middlewares_) {
+        if (!middleware(request, response)) {
+            return true;
+        }
+    }
+    if (!route) {
+        return false;
+    }
+    route->handler(request, params, response);
+    return true;
+}
+
+std::string_view Router::PathOf(std::string_view target) {
+    return target.substr(0, target.find_first_of("?#"));
+}
+
+} // namespace ppserver
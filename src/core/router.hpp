@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "http_request.hpp"
+
+namespace ppserver {
+
+class HttpRequestView;
+class HttpResponse;
+
+/**
+ * RouteParams - 一次路由匹配捕获的参数
+ * 负责：按名取出路径中:param与*wildcard对应的部分
+ * 设计特点：定长内联数组，名字引用Router保存的参数名，值引用请求路径，匹配时不分配内存；
+ *          值只在请求（视图）有效期间有效，值为原始路径片段（不做百分号解码）
+ */
+class RouteParams {
+public:
+    static constexpr size_t kMaxParams = 16;    // 单个路由模式中的参数个数上限
+
+    struct Param {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // 按名查找，不存在时返回空视图
+    std::string_view Get(std::string_view name) const;
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const Param* begin() const { return params_.data(); }
+    const Param* end() const { return params_.data() + count_; }
+
+    // 请求被拷贝后继续使用匹配结果：引用from中片段的值改为引用to中相同位置（to与from内容相同）
+    void Rebase(std::string_view from, std::string_view to);
+
+private:
+    friend class Router;
+
+    void Push(std::string_view name, std::string_view value) { params_[count_++] = Param{name, value}; }
+    void Pop() { --count_; }
+    void Clear() { count_ = 0; }
+
+    std::array<Param, kMaxParams> params_;
+    size_t count_ = 0;
+};
+
+/**
+ * Router - 按方法与路径分发请求的压缩前缀树（radix tree）路由器
+ * 负责：注册路由与中间件，为请求找到处理函数并捕获路径参数
+ * 设计特点：每个方法一棵树，静态片段按公共前缀压缩成边，子节点按首字符索引；
+ *          路由模式中以/分隔的整段可以是:name（匹配一段非空路径）或末尾的*name（匹配剩余全部路径，可为空）；
+ *          匹配优先级为静态片段 > :param > *wildcard，优先级高的分支失败时回溯；
+ *          匹配只在树上移动指针并把参数写入RouteParams的内联数组，不分配内存。
+ *          路由须在服务开始前注册完毕，之后只读，可被各IO线程与工作线程并发匹配
+ */
+class Router {
+public:
+    // 路由处理函数：填写response（状态码默认200）
+    using Handler = std::function<void(const HttpRequestView& request, const RouteParams& params,
+                                       HttpResponse& response)>;
+    // 中间件：按注册顺序在路由处理函数之前执行，返回false时停止处理并回复其填写的response
+    using Middleware = std::function<bool(const HttpRequestView& request, HttpResponse& response)>;
+
+    // 一条已注册的路由
+    struct Route {
+        HttpRequest::Method method;
+        std::string pattern;        // 注册时的路由模式
+        Handler handler;
+    };
+
+    Router();
+    ~Router();
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    // 注册路由；模式不以/开头、参数名为空、*不在末尾或与已有路由冲突时抛出std::runtime_error
+    void Add(HttpRequest::Method method, std::string_view pattern, Handler handler);
+    void Use(Middleware middleware);
+
+    // 查找与方法和路径（不含查询串）匹配的路由，未找到返回nullptr；params在返回前被覆盖
+    const Route* Match(HttpRequest::Method method, std::string_view path, RouteParams& params) const;
+
+    // 依次执行中间件，再执行与请求匹配的路由处理函数。
+    // 中间件拦截或路由处理完毕返回true；没有匹配的路由返回false（由调用方回退到静态文件/默认页面）
+    bool Dispatch(const HttpRequestView& request, HttpResponse& response) const;
+    // 同上，但使用调用方已由Match得到的结果（route为nullptr表示没有匹配的路由），不再重复匹配
+    bool Dispatch(const HttpRequestView& request, const Route* route, const RouteParams& params,
+                  HttpResponse& response) const;
+
+    bool Empty() const { return routes_.empty() && middlewares_.empty(); }
+    size_t GetRouteCount() const { return routes_.size(); }
+
+    // 去掉请求目标中的查询串与片段
+    static std::string_view PathOf(std::string_view target);
+
+private:
+    struct Node;
+
+    // 路由模式按静态片段、:param与*wildcard切分后的一段，text引用模式字符串（参数为参数名）
+    struct Segment {
+        enum class Kind { STATIC, PARAM, WILDCARD };
+        Kind kind;
+        std::string_view text;
+    };
+
+    static constexpr size_t kMethodCount = static_cast<size_t>(HttpRequest::Method::UNKNOWN);
+
+    // 切分并检查模式的语法，不合法时抛出std::runtime_error
+    static std::vector<Segment> ParsePattern(const std::string& pattern);
+    // 与树中已有路由冲突时抛出std::runtime_error，不修改树
+    static void CheckConflicts(const Node& root, const std::vector<Segment>& segments, const std::string& pattern);
+    // 不插入地查找静态片段结束处的已有节点，需要新建或拆分节点时返回nullptr
+    static const Node* FindStatic(const Node& node, std::string_view text);
+    static Node* InsertStatic(Node* node, std::string_view text);
+    static const Route* MatchNode(const Node& node, std::string_view path, RouteParams& params);
+
+    std::array<std::unique_ptr<Node>, kMethodCount> trees_;
+    std::vector<std::unique_ptr<Route>> routes_;
+    std::vector<Middleware> middlewares_;
+};
+
+} // namespace ppserver
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ppserver {
+
+/**
+ * SmallTask - 只可移动的void()可调用对象
+ * 负责：ThreadPool中任务的类型擦除存储，替代std::function
+ * 设计特点：不超过kInlineSize字节、对齐不超过max_align_t且移动不抛异常的可调用对象
+ *          直接放在对象内部的缓冲区中，构造与移动都不分配堆内存；更大的才在堆上分配。
+ *          只要求可调用对象可移动（可捕获std::packaged_task、unique_ptr等），
+ *          每种可调用类型对应一张静态操作表，对象本身只多存一个指针
+ */
+class SmallTask {
+public:
+    static constexpr size_t kInlineSize = 64;
+
+    // 可调用类型F是否放在内部缓冲区（不分配堆内存）
+    template <typename F>
+    static constexpr bool IsInline() {
+        return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    SmallTask() noexcept : ops_(nullptr) {}
+
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same<Fn, SmallTask>::value &&
+                                          std::is_invocable<Fn&>::value>>
+    SmallTask(F&& f) : ops_(&OpsFor<Fn>::kOps) {
+        if constexpr (IsInline<Fn>()) {
+            new (storage_) Fn(std::forward<F>(f));
+        } else {
+            *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(f));
+        }
+    }
+
+    SmallTask(SmallTask&& other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    SmallTask& operator=(SmallTask&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            ops_ = other.ops_;
+            if (ops_) {
+                ops_->move(storage_, other.storage_);
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    SmallTask(const SmallTask&) = delete;
+    SmallTask& operator=(const SmallTask&) = delete;
+
+    ~SmallTask() { Reset(); }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void Reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;    // 移动到dst并销毁src中的对象
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn, bool = IsInline<Fn>()>
+    struct OpsFor {
+        static void Invoke(void* storage) { (*static_cast<Fn*>(storage))(); }
+        static void Move(void* dst, void* src) noexcept {
+            Fn* from = static_cast<Fn*>(src);
+            new (dst) Fn(std::move(*from));
+            from->~Fn();
+        }
+        static void Destroy(void* storage) noexcept { static_cast<Fn*>(storage)->~Fn(); }
+        static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+    };
+
+    // 堆上存储：缓冲区中只放指针，移动即转移指针
+    template <typename Fn>
+    struct OpsFor<Fn, false> {
+        static Fn*& Pointer(void* storage) { return *static_cast<Fn**>(storage); }
+        static void Invoke(void* storage) { (*Pointer(storage))(); }
+        static void Move(void* dst, void* src) noexcept {
+            *static_cast<Fn**>(dst) = Pointer(src);
+        }
+        static void Destroy(void* storage) noexcept { delete Pointer(storage); }
+        static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_;
+};
+
+} // namespace ppserver
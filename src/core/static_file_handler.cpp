@@ -0,0 +1,283 @@
+#include "static_file_handler.hpp"
+#include "connection.hpp"
+#include "http_request.hpp"
+#include "http_request_view.hpp"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ppserver {
+
+namespace {
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string FormatHttpDate(time_t time) {
+    tm gmt{};
+    gmtime_r(&time, &gmt);
+    char buffer[64];
+    size_t len = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+    return std::string(buffer, len);
+}
+
+} // namespace
+
+StaticFileHandler::StaticFileHandler(Config config)
+    : config_(std::move(config)) {
+    // 去掉根目录末尾的'/'，拼接时统一加
+    while (config_.document_root.size() > 1 && config_.document_root.back() == '/') {
+        config_.document_root.pop_back();
+    }
+}
+
+void StaticFileHandler::Serve(Connection& conn, const HttpRequest& request) {
+    HttpRequestView view;
+    view.Assign(request);
+    Serve(conn, view);
+}
+
+void StaticFileHandler::Serve(Connection& conn, const HttpRequestView& request) {
+    bool keep_alive = request.IsKeepAlive();
+    HttpRequest::Method method = request.GetMethod();
+    if (method != HttpRequest::Method::GET && method != HttpRequest::Method::HEAD) {
+        SendError(conn, HttpResponse::HttpStatusCode::METHOD_NOT_ALLOWED, keep_alive);
+        return;
+    }
+
+    std::string relative;
+    if (!ResolvePath(request.GetPath(), relative)) {
+        SendError(conn, HttpResponse::HttpStatusCode::FORBIDDEN, keep_alive);
+        return;
+    }
+
+    const CachedFile* entry = Lookup(relative);
+    if (!entry) {
+        ++stats_.not_found;
+        SendError(conn, HttpResponse::HttpStatusCode::NOT_FOUND, keep_alive);
+        return;
+    }
+
+    // 响应头是共享缓冲，正文是文件区间：两者都不拷贝
+    conn.WriteData(keep_alive ? entry->header : entry->close_header);
+    if (method == HttpRequest::Method::GET) {
+        conn.WriteFile(entry->file, 0, entry->size);
+    }
+}
+
+bool StaticFileHandler::ResolvePath(std::string_view target, std::string& relative) const {
+    // 去掉查询串和片段
+    std::string_view raw = target.substr(0, target.find_first_of("?#"));
+    if (raw.empty() || raw[0] != '/') {
+        return false;
+    }
+
+    // 百分号解码
+    std::string decoded;
+    decoded.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] == '%') {
+            if (i + 2 >= raw.size()) {
+                return false;
+            }
+            int high = HexValue(raw[i + 1]);
+            int low = HexValue(raw[i + 2]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            char c = static_cast<char>(high * 16 + low);
+            if (c == '\0') {
+                return false;
+            }
+            decoded.push_back(c);
+            i += 2;
+        } else {
+            decoded.push_back(raw[i]);
+        }
+    }
+
+    // 按段检查：拒绝".."，折叠"."和多余的'/'
+    relative.clear();
+    size_t pos = 0;
+    while (pos < decoded.size()) {
+        size_t next = decoded.find('/', pos);
+        if (next == std::string::npos) {
+            next = decoded.size();
+        }
+        std::string segment = decoded.substr(pos, next - pos);
+        pos = next + 1;
+        if (segment.empty() || segment == ".") {
+            continue;
+        }
+        if (segment == "..") {
+            return false;
+        }
+        relative += '/';
+        relative += segment;
+    }
+    if (relative.empty() || decoded.back() == '/') {
+        relative += '/';   // 目录请求
+    }
+    return true;
+}
+
+const StaticFileHandler::CachedFile* StaticFileHandler::Lookup(const std::string& relative) {
+    uint64_t now = NowMs();
+    auto it = cache_.find(relative);
+    if (it != cache_.end() && now - it->second.validated_at < config_.revalidate_ms) {
+        ++stats_.hits;
+        return &it->second;
+    }
+
+    // 未缓存或已到校验时间：重新stat
+    std::string path = config_.document_root + relative;
+    struct stat st {};
+    bool found = stat(path.c_str(), &st) == 0;
+    if (found && S_ISDIR(st.st_mode)) {
+        path += (path.back() == '/' ? "" : "/") + config_.index_file;
+        found = stat(path.c_str(), &st) == 0;
+    }
+    if (!found || !S_ISREG(st.st_mode)) {
+        if (it != cache_.end()) {
+            cache_.erase(it);  // 文件已删除，缓存失效（在途的发送仍持有旧fd）
+        }
+        return nullptr;
+    }
+
+    if (it != cache_.end()) {
+        CachedFile& entry = it->second;
+        if (entry.device == st.st_dev && entry.inode == st.st_ino &&
+            entry.size == static_cast<size_t>(st.st_size) &&
+            entry.mtime == st.st_mtim.tv_sec && entry.mtime_nsec == st.st_mtim.tv_nsec) {
+            ++stats_.revalidations;
+            entry.validated_at = now;
+            return &entry;
+        }
+        // 文件被替换或修改：重新打开
+        if (!OpenFile(path, entry)) {
+            cache_.erase(it);
+            return nullptr;
+        }
+        entry.validated_at = now;
+        return &entry;
+    }
+
+    CachedFile entry;
+    if (!OpenFile(path, entry)) {
+        return nullptr;
+    }
+    entry.validated_at = now;
+    if (cache_.size() >= config_.max_cached_files) {
+        EvictOne();
+    }
+    return &cache_.emplace(relative, std::move(entry)).first->second;
+}
+
+bool StaticFileHandler::OpenFile(const std::string& path, CachedFile& entry) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    // 以打开后的fstat为准，避免stat与open之间文件被替换
+    struct stat opened {};
+    if (fstat(fd, &opened) < 0 || !S_ISREG(opened.st_mode)) {
+        close(fd);
+        return false;
+    }
+    ++stats_.opens;
+
+    entry.file = std::make_shared<const FileHandle>(fd);
+    entry.size = static_cast<size_t>(opened.st_size);
+    entry.device = opened.st_dev;
+    entry.inode = opened.st_ino;
+    entry.mtime = opened.st_mtim.tv_sec;
+    entry.mtime_nsec = opened.st_mtim.tv_nsec;
+
+    std::string header =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: " + std::string(GetMimeType(path)) + "\r\n"
+        "Content-Length: " + std::to_string(entry.size) + "\r\n"
+        "Last-Modified: " + FormatHttpDate(entry.mtime) + "\r\n";
+    entry.header = std::make_shared<const std::string>(header + "Connection: keep-alive\r\n\r\n");
+    entry.close_header = std::make_shared<const std::string>(header + "Connection: close\r\n\r\n");
+    return true;
+}
+
+void StaticFileHandler::EvictOne() {
+    // 淘汰最久未校验的一项；只在缓存满时扫描
+    auto oldest = cache_.begin();
+    for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+        if (it->second.validated_at < oldest->second.validated_at) {
+            oldest = it;
+        }
+    }
+    if (oldest != cache_.end()) {
+        cache_.erase(oldest);
+    }
+}
+
+void StaticFileHandler::SendError(Connection& conn, HttpResponse::HttpStatusCode status, bool keep_alive) {
+    RequestArena::Lease lease(conn.GetRequestArena());
+    HttpResponse response(conn.GetRequestArena().Resource());
+    response.SetStatusCode(status);
+    response.SetHeader("Content-Type", "text/html; charset=utf-8");
+    response.SetBody("<h1>" + std::to_string(static_cast<int>(status)) + " " +
+                     HttpResponse::GetReasonPhrase(status) + "</h1>");
+    response.SetKeepAlive(keep_alive);
+    conn.WriteData(response.Serialize());
+}
+
+StaticFileHandler::Statistics StaticFileHandler::GetStatistics() const {
+    Statistics stats = stats_;
+    stats.cached_files = cache_.size();
+    return stats;
+}
+
+const char* StaticFileHandler::GetMimeType(const std::string& path) {
+    static const std::unordered_map<std::string, const char*> mime_types = {
+        {"html", "text/html; charset=utf-8"},
+        {"htm", "text/html; charset=utf-8"},
+        {"css", "text/css; charset=utf-8"},
+        {"js", "application/javascript; charset=utf-8"},
+        {"json", "application/json"},
+        {"txt", "text/plain; charset=utf-8"},
+        {"xml", "application/xml"},
+        {"svg", "image/svg+xml"},
+        {"png", "image/png"},
+        {"jpg", "image/jpeg"},
+        {"jpeg", "image/jpeg"},
+        {"gif", "image/gif"},
+        {"webp", "image/webp"},
+        {"ico", "image/x-icon"},
+        {"woff", "font/woff"},
+        {"woff2", "font/woff2"},
+        {"wasm", "application/wasm"},
+        {"pdf", "application/pdf"},
+        {"mp4", "video/mp4"},
+    };
+
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "application/octet-stream";
+    }
+    std::string ext = path.substr(dot + 1);
+    for (char& c : ext) {
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    auto it = mime_types.find(ext);
+    return it != mime_types.end() ? it->second : "application/octet-stream";
+}
+
+uint64_t StaticFileHandler::NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace ppserver
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <sys/types.h>
+#include "output_queue.hpp"
+#include "http_response.hpp"
+
+namespace ppserver {
+
+class Connection;
+class HttpRequest;
+class HttpRequestView;
+
+/**
+ * StaticFileHandler - 静态文件处理器
+ * 负责：把请求路径映射到document_root下的文件，以sendfile经连接输出队列发送
+ * 设计特点：缓存打开的fd、stat结果和预先生成的响应头（共享只读缓冲），
+ *          命中时不打开文件、不拼接字符串，文件内容不经过用户态；
+ *          缓存项超过revalidate_ms后重新stat，inode/大小/修改时间变化则重新打开，
+ *          文件删除则失效。每个EventLoop一个实例，无需加锁
+ */
+class StaticFileHandler {
+public:
+    struct Config {
+        std::string document_root;              // 文件根目录
+        std::string index_file = "index.html";  // 目录请求的默认文件
+        size_t max_cached_files = 1024;         // 缓存的文件（fd）数上限
+        uint64_t revalidate_ms = 1000;          // 缓存项重新stat校验的间隔
+    };
+
+    // 缓存统计
+    struct Statistics {
+        uint64_t hits = 0;          // 未过期直接命中
+        uint64_t revalidations = 0; // 过期后stat校验仍有效
+        uint64_t opens = 0;         // 打开（含失效后重新打开）文件次数
+        uint64_t not_found = 0;
+        size_t cached_files = 0;
+    };
+
+    explicit StaticFileHandler(Config config);
+
+    StaticFileHandler(const StaticFileHandler&) = delete;
+    StaticFileHandler& operator=(const StaticFileHandler&) = delete;
+
+    // 处理一个请求并把响应写入连接（200/403/404/405）
+    void Serve(Connection& conn, const HttpRequestView& request);
+    void Serve(Connection& conn, const HttpRequest& request);
+
+    Statistics GetStatistics() const;
+
+    static const char* GetMimeType(const std::string& path);
+
+private:
+    struct CachedFile {
+        std::shared_ptr<const FileHandle> file;
+        std::shared_ptr<const std::string> header;        // 完整的200响应头（keep-alive）
+        std::shared_ptr<const std::string> close_header;  // 同上，Connection: close
+        size_t size = 0;
+        dev_t device = 0;
+        ino_t inode = 0;
+        time_t mtime = 0;
+        long mtime_nsec = 0;
+        uint64_t validated_at = 0;                  // 上次stat校验时间(ms)
+    };
+
+    // 把URL路径解码并校验为document_root下的相对路径，非法时返回false
+    bool ResolvePath(std::string_view target, std::string& relative) const;
+    const CachedFile* Lookup(const std::string& relative);
+    bool OpenFile(const std::string& path, CachedFile& entry);
+    void EvictOne();
+    void SendError(Connection& conn, HttpResponse::HttpStatusCode status, bool keep_alive);
+    static uint64_t NowMs();
+
+    Config config_;
+    std::unordered_map<std::string, CachedFile> cache_;
+    Statistics stats_;
+};
+
+} // namespace ppserver
@@ -1,18 +1,26 @@
 #include "thread_pool.hpp"
+#include <algorithm>
 #include <iostream>
 
 namespace ppserver {
 
+thread_local ThreadPool::Worker* ThreadPool::t_worker_ = nullptr;
 
+ThreadPool::ThreadPool(const Config_thread_pool& config )
+    : config_(config),
+      core_threads_(std::min(std::max<size_t>(config.core_threads, 1), kMaxThreads)),
+      max_threads_(std::min(std::max(config.max_threads, core_threads_.load()), kMaxThreads)),
+      slots_(std::make_unique<std::atomic<Worker*>[]>(kMaxThreads)),
+      shutdown_(false) {
 
+    workers_.reserve(max_threads_.load());
 
-ThreadPool::ThreadPool(const Config_thread_pool& config ) 
-    : config_(config), 
-      shutdown_(false) {
-    
     // 创建核心线程数
-    for (size_t i = 0; i < config_.core_threads; ++i) {
-        CreateThread();
+    for (size_t i = 0; i < core_threads_.load(); ++i) {
+        if (!CreateThread()) {
+            Shutdown(true);
+            throw std::runtime_error("Failed to create thread pool worker");
+        }
     }
 }
 
@@ -21,72 +29,484 @@ ThreadPool::~ThreadPool() {
 }
 
 bool ThreadPool::CreateThread() {
+    std::lock_guard<std::mutex> lock(resize_mutex_);
+    if (shutdown_.load(std::memory_order_acquire) ||
+        live_threads_.load(std::memory_order_relaxed) >= max_threads_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    // 优先复用线程已退出的槽位（其本地队列必为空）
+    Worker* worker = nullptr;
+    for (auto& candidate : workers_) {
+        if (!candidate->running.load(std::memory_order_acquire)) {
+            worker = candidate.get();
+            break;
+        }
+    }
+    if (!worker) {
+        if (workers_.size() >= kMaxThreads) {
+            return false;
+        }
+        workers_.push_back(std::make_unique<Worker>());
+        worker = workers_.back().get();
+        worker->pool = this;
+        worker->rng = 0x9E3779B97F4A7C15ULL * workers_.size();
+        slots_[workers_.size() - 1].store(worker, std::memory_order_release);
+        slot_count_.store(workers_.size(), std::memory_order_release);
+    }
+    if (worker->thread.joinable()) {
+        worker->thread.join();      // 上一个线程已走到WorkerLoop末尾，join不会等待
+    }
+
+    worker->running.store(true, std::memory_order_release);
+    size_t live = live_threads_.fetch_add(1, std::memory_order_relaxed) + 1;
     try {
-        threads_.emplace_back([this]() {
-            while (true) {
-                Task task;
-                
-                {
-                    std::unique_lock<std::mutex> lock(queue_mutex_);
-                    condition_.wait(lock, [this] { 
-                        return shutdown_ || !tasks_.empty(); 
-                    });
-                    
-                    if (shutdown_ && tasks_.empty()) {
-                        return;
-                    }
-                    
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                }
-                
-                task();
+        worker->thread = std::thread([this, worker]() { WorkerLoop(*worker); });
+    } catch (...) {
+        worker->running.store(false, std::memory_order_release);
+        live_threads_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    threads_started_.fetch_add(1, std::memory_order_relaxed);
+    if (live > peak_threads_.load(std::memory_order_relaxed)) {
+        peak_threads_.store(live, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ThreadPool::WorkerLoop(Worker& self) {
+    t_worker_ = &self;
+    while (true) {
+        TaskNode* task = FindTask(self);
+        // 取不到任务时先自旋，短暂的空档不进入内核
+        for (int round = 0; !task && round < kSpinRounds; ++round) {
+            std::this_thread::yield();
+            task = FindTask(self);
+        }
+        if (task) {
+            MaybeGrow(task->enqueued);
+            RunTask(self, task);
+            continue;
+        }
+        if (!Park(self)) {
+            break;
+        }
+        // 被唤醒：积压的任务不止一个时接力唤醒下一个休眠者
+        if (pending_.load(std::memory_order_relaxed) > 1) {
+            WakeOne();
+        }
+    }
+    t_worker_ = nullptr;
+    self.running.store(false, std::memory_order_release);
+}
+
+void ThreadPool::MaybeGrow(std::chrono::steady_clock::time_point enqueued) {
+    // 有空闲线程或已到上限时不扩容；先查两个原子量，避免每个任务都读时钟
+    if (sleepers_.load(std::memory_order_relaxed) > 0 ||
+        live_threads_.load(std::memory_order_relaxed) >= max_threads_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() - enqueued < config_.grow_threshold) {
+        return;
+    }
+    // 同一时刻只有一个线程在扩容，其余照常执行任务
+    if (growing_.exchange(true, std::memory_order_acquire)) {
+        return;
+    }
+    CreateThread();
+    growing_.store(false, std::memory_order_release);
+}
+
+bool ThreadPool::TryRetire(bool idle_timeout) {
+    size_t limit = idle_timeout ? core_threads_.load(std::memory_order_relaxed)
+                                : max_threads_.load(std::memory_order_relaxed);
+    size_t live = live_threads_.load(std::memory_order_relaxed);
+    do {
+        if (live <= limit) {
+            return false;
+        }
+    } while (!live_threads_.compare_exchange_weak(live, live - 1, std::memory_order_relaxed));
+    threads_retired_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ThreadPool::Schedule(Task& task, bool no_wait) {
+    if (!TryAcquireSlot()) {
+        if (no_wait && (config_.reject_policy == RejectPolicy::BLOCK ||
+                        config_.reject_policy == RejectPolicy::CALLER_RUNS)) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        switch (config_.reject_policy) {
+        case RejectPolicy::BLOCK:
+            // 工作线程等待空位可能与其它工作线程互相等待，改为就地执行
+            if (t_worker_ && t_worker_->pool == this) {
+                caller_runs_.fetch_add(1, std::memory_order_relaxed);
+                RunInline(task);
+                return true;
+            }
+            if (!WaitForSlot()) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            break;
+        case RejectPolicy::REJECT:
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        case RejectPolicy::CALLER_RUNS:
+            caller_runs_.fetch_add(1, std::memory_order_relaxed);
+            RunInline(task);
+            return true;
+        case RejectPolicy::DROP_OLDEST:
+            // 丢弃的任务让出的名额直接给新任务
+            if (!DropOldest()) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return false;
             }
-        });
-        
+            break;
+        }
+    }
+    Enqueue(std::move(task));
+    return true;
+}
+
+void ThreadPool::Enqueue(Task&& task) {
+    auto now = std::chrono::steady_clock::now();
+    TaskNode* node = node_pool_.Construct(std::move(task), now);
+    auto oldest = now;
+
+    // pending_已在入队前计数：取任务方看到pending_>0时任务可能尚未可见，最多多自旋一轮
+    Worker* worker = t_worker_;
+    if (worker && worker->pool == this) {
+        worker->deque.Push(node);
+        worker->local_pushes.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (inject_tail_) {
+            inject_tail_->next = node;
+        } else {
+            inject_head_ = node;
+        }
+        inject_tail_ = node;
+        oldest = inject_head_->enqueued;
+        injected_size_.fetch_add(1, std::memory_order_relaxed);
+        injected_total_.fetch_add(1, std::memory_order_relaxed);
+    }
+    WakeOne();
+    // 工作线程全部卡在慢任务上时没有线程来取任务，由提交方根据注入队列最早任务的等待时间扩容
+    if (oldest != now) {
+        MaybeGrow(oldest);
+    }
+}
+
+bool ThreadPool::TryAcquireSlot() {
+    if (config_.max_tasks == 0) {
+        pending_.fetch_add(1, std::memory_order_seq_cst);
         return true;
-    } catch (...) {
+    }
+    size_t pending = pending_.load(std::memory_order_relaxed);
+    do {
+        if (pending >= config_.max_tasks) {
+            return false;
+        }
+    } while (!pending_.compare_exchange_weak(pending, pending + 1, std::memory_order_seq_cst,
+                                             std::memory_order_relaxed));
+    return true;
+}
+
+bool ThreadPool::WaitForSlot() {
+    std::unique_lock<std::mutex> lock(space_mutex_);
+    // 先登记再检查：与ReleaseSlot的"先减pending_再读blocked_submitters_"配对
+    blocked_submitters_.fetch_add(1, std::memory_order_seq_cst);
+    bool acquired = false;
+    space_condition_.wait_for(lock, config_.block_timeout, [this, &acquired] {
+        acquired = TryAcquireSlot();
+        return acquired || shutdown_.load(std::memory_order_acquire);
+    });
+    blocked_submitters_.fetch_sub(1, std::memory_order_relaxed);
+    return acquired;
+}
+
+void ThreadPool::ReleaseSlot() {
+    pending_.fetch_sub(1, std::memory_order_seq_cst);
+    if (blocked_submitters_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(space_mutex_);
+        space_condition_.notify_one();
+    }
+}
+
+bool ThreadPool::DropOldest() {
+    TaskNode* victim = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (inject_head_) {
+            victim = inject_head_;
+            inject_head_ = victim->next;
+            if (!inject_head_) {
+                inject_tail_ = nullptr;
+            }
+            injected_size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    // 注入队列为空时从工作线程队列的顶端（最早压入的一端）取
+    size_t num_workers = slot_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; !victim && i < num_workers; ++i) {
+        Worker* worker = slots_[i].load(std::memory_order_acquire);
+        if (worker) {
+            worker->deque.Steal(victim);
+        }
+    }
+    if (!victim) {
         return false;
     }
+    node_pool_.Destroy(victim);
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
-void ThreadPool::Shutdown(bool wait_for_completion) {
+ThreadPool::TaskNode* ThreadPool::FindTask(Worker& self) {
+    TaskNode* task = nullptr;
+    if (self.deque.Pop(task)) {
+        ReleaseSlot();
+        return task;
+    }
+    if (pending_.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    task = PopInjected(self);
+    if (!task) {
+        task = StealFrom(self);
+    }
+    return task;
+}
+
+ThreadPool::TaskNode* ThreadPool::PopInjected(Worker& self) {
+    if (injected_size_.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    TaskNode* batch[kInjectBatch];
+    size_t count = 0;
     {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (shutdown_) {
-            return;
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        // 多个线程同时空闲时平分积压，避免一个线程把注入队列整批搬走
+        size_t queued = injected_size_.load(std::memory_order_relaxed);
+        size_t workers = std::max<size_t>(live_threads_.load(std::memory_order_relaxed), 1);
+        size_t take = std::min({queued, queued / workers + 1, kInjectBatch});
+        for (; count < take; ++count) {
+            batch[count] = inject_head_;
+            inject_head_ = inject_head_->next;
+        }
+        if (!inject_head_) {
+            inject_tail_ = nullptr;
         }
-        shutdown_ = true;
+        injected_size_.fetch_sub(count, std::memory_order_relaxed);
     }
-    
-    condition_.notify_all();
-    
-    if (wait_for_completion) {
-        for (std::thread& worker : threads_) {
-            if (worker.joinable()) {
-                worker.join();
+    if (count == 0) {
+        return nullptr;
+    }
+    // 第一个立即执行，其余进入本地队列（仍计在pending_中，可被其它线程窃取）
+    for (size_t i = count; i-- > 1;) {
+        batch[i]->next = nullptr;
+        self.deque.Push(batch[i]);
+    }
+    ReleaseSlot();
+    return batch[0];
+}
+
+ThreadPool::TaskNode* ThreadPool::StealFrom(Worker& self) {
+    size_t num_workers = slot_count_.load(std::memory_order_acquire);
+    if (num_workers < 2) {
+        return nullptr;
+    }
+    // xorshift随机起点，避免所有空闲线程盯住同一个受害者
+    self.rng ^= self.rng << 13;
+    self.rng ^= self.rng >> 7;
+    self.rng ^= self.rng << 17;
+    size_t start = static_cast<size_t>(self.rng % num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        Worker* victim = slots_[(start + i) % num_workers].load(std::memory_order_acquire);
+        if (!victim || victim == &self) {
+            continue;
+        }
+        TaskNode* task = nullptr;
+        if (victim->deque.Steal(task)) {
+            ReleaseSlot();
+            self.stolen.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+bool ThreadPool::Park(Worker& self) {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    // 先登记再检查：与Schedule的"先计数pending_再读sleepers_"配对，两边至少有一方看到对方
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    bool retired = false;
+    while (pending_.load(std::memory_order_seq_cst) == 0 &&
+           !shutdown_.load(std::memory_order_acquire)) {
+        // 缩小max_threads后多出的线程立即退出
+        if (TryRetire(false)) {
+            retired = true;
+            break;
+        }
+        self.parks.fetch_add(1, std::memory_order_relaxed);
+        if (live_threads_.load(std::memory_order_relaxed) <= core_threads_.load(std::memory_order_relaxed)) {
+            condition_.wait(lock);
+        } else if (condition_.wait_for(lock, config_.keep_alive_time) == std::cv_status::timeout &&
+                   pending_.load(std::memory_order_seq_cst) == 0 && TryRetire(true)) {
+            retired = true;     // 超出core的线程空闲满keep_alive_time
+            break;
+        }
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    if (retired) {
+        return false;
+    }
+    // 关闭后仍把已入队的任务执行完再退出
+    return pending_.load(std::memory_order_relaxed) > 0 || !shutdown_.load(std::memory_order_acquire);
+}
+
+void ThreadPool::WakeOne() {
+    // 线程全忙或在自旋时不加锁
+    if (sleepers_.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    condition_.notify_one();//唤醒一个停放的线程，而不是惊动全部
+}
+
+void ThreadPool::RunTask(Worker& self, TaskNode* node) {
+    ExecuteTask(node);
+    self.completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::ExecuteTask(TaskNode* node) {
+    RunInline(node->task);
+    node_pool_.Destroy(node);
+}
+
+void ThreadPool::RunInline(Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        std::cerr << "ThreadPool task threw: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "ThreadPool task threw an unknown exception" << std::endl;
+    }
+}
+
+void ThreadPool::Shutdown(bool wait_for_completion) {
+    if (!shutdown_.exchange(true)) {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            condition_.notify_all();
+        }
+        std::lock_guard<std::mutex> lock(space_mutex_);
+        space_condition_.notify_all();
+    }
+
+    if (!wait_for_completion) {
+        return;
+    }
+    // 关闭后CreateThread不再启动线程，workers_不再变化，可以在锁外join
+    // （扩容中的工作线程可能正等待resize_mutex_）
+    { std::lock_guard<std::mutex> lock(resize_mutex_); }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable() && worker->thread.get_id() != std::this_thread::get_id()) {
+            worker->thread.join();
+        }
+    }
+    // 与关闭并发的Submit可能在工作线程退出后才入队，由调用线程执行完
+    while (true) {
+        TaskNode* node = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            if (!inject_head_) {
+                break;
+            }
+            node = inject_head_;
+            inject_head_ = node->next;
+            if (!inject_head_) {
+                inject_tail_ = nullptr;
             }
+            injected_size_.fetch_sub(1, std::memory_order_relaxed);
         }
+        ReleaseSlot();
+        ExecuteTask(node);
     }
 }
 
 size_t ThreadPool::GetPendingTaskCount() const {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    return tasks_.size();
+    return pending_.load(std::memory_order_relaxed);
 }
 
 size_t ThreadPool::GetActiveThreadCount() const {
-    return threads_.size();
+    return live_threads_.load(std::memory_order_relaxed);
 }
 
-// bool ThreadPool::SetCoreThreadSize(size_t num) {
-//     // 简化实现，实际项目中需要更复杂的线程管理逻辑
-//     return true;
-// }
+ThreadPool::Statistics ThreadPool::GetStatistics() const {
+    Statistics stats;
+    stats.pending = pending_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.caller_runs = caller_runs_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.injected = injected_total_.load(std::memory_order_relaxed);
+    size_t num_workers = slot_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < num_workers; ++i) {
+        const Worker* worker = slots_[i].load(std::memory_order_acquire);
+        if (!worker) {
+            continue;
+        }
+        stats.completed += worker->completed.load(std::memory_order_relaxed);
+        stats.local_pushes += worker->local_pushes.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+        stats.parks += worker->parks.load(std::memory_order_relaxed);
+    }
+    stats.queued = stats.injected + stats.local_pushes;
+    stats.threads = live_threads_.load(std::memory_order_relaxed);
+    stats.peak_threads = peak_threads_.load(std::memory_order_relaxed);
+    stats.threads_started = threads_started_.load(std::memory_order_relaxed);
+    stats.threads_retired = threads_retired_.load(std::memory_order_relaxed);
+    return stats;
+}
 
-// bool ThreadPool::SetMaxThreadSize(size_t num) {
-//     // 简化实现，实际项目中需要更复杂的线程管理逻辑
-//     return true;
-// }
+bool ThreadPool::SetCoreThreadSize(size_t num) {
+    {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        if (num == 0 || num > max_threads_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        core_threads_.store(num, std::memory_order_relaxed);
+    }
+    while (live_threads_.load(std::memory_order_relaxed) < num && CreateThread()) {
+    }
+    // 无限期停放的线程重新判断是否应按keep_alive_time退出
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    condition_.notify_all();
+    return true;
+}
+
+bool ThreadPool::SetMaxThreadSize(size_t num) {
+    {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        if (num < core_threads_.load(std::memory_order_relaxed) || num > kMaxThreads) {
+            return false;
+        }
+        max_threads_.store(num, std::memory_order_relaxed);
+    }
+    // 多出的空闲线程被唤醒后退出，忙碌的线程在下次空闲时退出
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    condition_.notify_all();
+    return true;
+}
+
+size_t ThreadPool::GetCoreThreadSize() const {
+    return core_threads_.load(std::memory_order_relaxed);
+}
+
+size_t ThreadPool::GetMaxThreadSize() const {
+    return max_threads_.load(std::memory_order_relaxed);
+}
 
-} // namespace ppsever
\ No newline at end of file
+} // namespace ppsever
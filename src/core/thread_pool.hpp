@@ -1,89 +1,280 @@
 #pragma once
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
-#include <functional>
+#include <cstdint>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <stdexcept>
 #include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
+#include "memory_pool.hpp"
+#include "small_task.hpp"
+#include "work_stealing_deque.hpp"
 // #include "connection_manager.hpp"
 
 namespace ppserver {
+
+// 任务队列已满且按拒绝策略未能入队时抛出（TryPost以返回false代替）
+class TaskRejectedError : public std::runtime_error {
+public:
+    TaskRejectedError() : std::runtime_error("ThreadPool task queue is full") {}
+};
+
+/**
+ * ThreadPool - 工作窃取线程池
+ * 负责：执行业务任务（Post不关心结果，Submit返回future）
+ * 设计特点：每个工作线程一个Chase-Lev双端队列，工作线程内提交的任务压入自己的队列（LIFO执行），
+ *          外部线程提交的任务进入全局注入队列；
+ *          空闲线程依次尝试：本地队列 -> 注入队列 -> 随机起点窃取其它线程队列，
+ *          都取不到时先自旋kSpinRounds轮，再登记为休眠者并在条件变量上停放；
+ *          提交方只在有休眠者时才加锁唤醒一个，线程全忙时提交不经过任何锁（注入队列除外）；
+ *          任务存为SmallTask，连同队列链接指针放在池化的TaskNode中，
+ *          捕获不超过SmallTask::kInlineSize字节的Post稳态下不分配堆内存；
+ *          排队任务数不超过max_tasks，满时按reject_policy处理（阻塞/拒绝/调用方执行/丢弃最旧）；
+ *          线程数在core_threads与max_threads之间伸缩：没有空闲线程且任务排队超过grow_threshold时
+ *          增加一个线程，超出core_threads的线程空闲keep_alive_time后退出。
+ *          工作线程槽位（含本地队列）按需创建、池销毁前不释放，线程退出后槽位留给下一个线程复用，
+ *          窃取方因此可以无锁遍历槽位
+ */
 class ThreadPool {
 public:
-    using Task = std::function<void()>;//uring引入std::function
-    
+    using Task = SmallTask;  // 只可移动，小捕获不分配堆内存
+
+    // 任务队列满时的处理策略
+    enum class RejectPolicy {
+        BLOCK,          // 等待空位，超过block_timeout仍无空位则拒绝（工作线程内提交不等待，改为就地执行）
+        REJECT,         // 立即拒绝：Post/Submit抛出TaskRejectedError，TryPost返回false
+        CALLER_RUNS,    // 在提交线程上直接执行，自然减慢提交方
+        DROP_OLDEST     // 丢弃最早排队的任务（其future得到broken_promise），新任务入队
+    };
+
     // 配置结构
     struct Config_thread_pool {
         size_t core_threads = 4;      // 核心线程数
         size_t max_threads = 16;      // 最大线程数
-        size_t max_tasks = 1000;      // 任务队列容量
+        size_t max_tasks = 1000;      // 任务队列容量（0表示不限）
         std::chrono::seconds keep_alive_time{60}; // 空闲线程存活时间
         //std::chrono::seconds是std::chrono::duration的子类，用于表示一段时间，比如1秒、1分、1天等。
+        RejectPolicy reject_policy = RejectPolicy::BLOCK;   // 队列满时的处理策略
+        std::chrono::milliseconds block_timeout{1000};      // BLOCK策略的最长等待时间
+        std::chrono::milliseconds grow_threshold{10};       // 任务排队超过该时间且无空闲线程时扩容
+    };
+
+    // 调度统计（各计数为近似值，运行中读取）
+    struct Statistics {
+        size_t pending = 0;           // 当前排队的任务数
+        uint64_t queued = 0;          // 累计入队的任务数
+        uint64_t completed = 0;       // 工作线程已执行完的任务数
+        uint64_t rejected = 0;        // 队列满被拒绝的任务数（含BLOCK等待超时）
+        uint64_t caller_runs = 0;     // 队列满时在提交线程上执行的任务数
+        uint64_t dropped = 0;         // DROP_OLDEST策略丢弃的任务数
+        uint64_t local_pushes = 0;    // 工作线程内提交、进入本地队列的任务数
+        uint64_t injected = 0;        // 外部提交、进入注入队列的任务数
+        uint64_t stolen = 0;          // 从其它线程队列窃取的任务数
+        uint64_t parks = 0;           // 工作线程停放次数
+        size_t threads = 0;           // 当前线程数
+        size_t peak_threads = 0;      // 线程数峰值
+        uint64_t threads_started = 0; // 累计启动的线程数（含核心线程）
+        uint64_t threads_retired = 0; // 因空闲超时或缩容退出的线程数
     };
 
+    static constexpr int kSpinRounds = 64;      // 停放前的自旋轮数
+    static constexpr size_t kMaxThreads = 256;  // max_threads的上限（工作线程槽位数）
 
-    
-    
     explicit ThreadPool(const Config_thread_pool& config );
     ~ThreadPool();
-    
-    // 提交任务，返回future获取结果
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交任务，不关心结果；任务抛出的异常记录日志后丢弃。
+    // 队列满且按策略被拒绝时抛出TaskRejectedError
+    template<typename F>
+    void Post(F&& f);
+
+    // 同Post，但关闭后或被拒绝时返回false而不抛异常（过载时用于快速回复503）
+    template<typename F>
+    bool TryPost(F&& f);
+
+    // 同TryPost，但队列满时从不等待也不在调用方执行：BLOCK与CALLER_RUNS策略立即返回false，
+    // DROP_OLDEST照常丢弃最旧任务。供IO线程提交，过载时不阻塞事件循环
+    template<typename F>
+    bool TryPostNoWait(F&& f);
+
+    // 提交任务，返回future获取结果（future共享状态需一次堆分配）；被拒绝时抛出TaskRejectedError
     template<typename F, typename... Args>
-    auto Submit(F&& f, Args&&... args) 
-        -> std::future<typename std::result_of<F(Args...)>::type>;
-    
-    // 动态调整线程数
+    auto Submit(F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>;
+
+    // 动态调整线程数：core不能为0或超过max，max不能小于core或超过kMaxThreads，否则返回false。
+    // 扩大core立即补足线程；缩小core后多出的线程空闲keep_alive_time后退出；缩小max后多出的线程空闲时立即退出
     bool SetCoreThreadSize(size_t num);
     bool SetMaxThreadSize(size_t num);
-    
+    size_t GetCoreThreadSize() const;
+    size_t GetMaxThreadSize() const;
+
     // 状态查询
     size_t GetPendingTaskCount() const;
     size_t GetActiveThreadCount() const;
-    
+    Statistics GetStatistics() const;
+
     // 优雅关闭
     void Shutdown(bool wait_for_completion = true);
 
 private:
+    // 队列中的任务：Task与注入队列的链接指针，从node_pool_分配
+    struct TaskNode {
+        TaskNode(Task&& task, std::chrono::steady_clock::time_point enqueued)
+            : task(std::move(task)), enqueued(enqueued) {}
+
+        Task task;
+        std::chrono::steady_clock::time_point enqueued;     // 入队时间，用于判断是否扩容
+        TaskNode* next = nullptr;
+    };
+
+    // 工作线程：本地队列与统计计数（计数只由本线程写）
+    struct Worker {
+        ThreadPool* pool = nullptr;
+        WorkStealingDeque<TaskNode*> deque;
+        std::thread thread;
+        std::atomic<bool> running{false};   // 线程已启动且未退出（由resize_mutex_保护写入）
+        uint64_t rng = 0;
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> local_pushes{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> parks{0};
+    };
+
+    // 在空闲槽位上启动一个线程，线程数已达max_threads时返回false
     bool CreateThread();
+    void WorkerLoop(Worker& self);
+    // 取到任务后检查其排队时间，必要时扩容
+    void MaybeGrow(std::chrono::steady_clock::time_point enqueued);
+    // 空闲线程能否退出（线程数超过max，或超过core且已空闲keep_alive_time），能则计数减一
+    bool TryRetire(bool idle_timeout);
+    // 按队列上限与拒绝策略提交：入队或就地执行返回true，被拒绝返回false（task未被移走）；
+    // no_wait时BLOCK与CALLER_RUNS策略改为直接拒绝
+    bool Schedule(Task& task, bool no_wait = false);
+    // 入队：本池工作线程内压入本地队列，否则进入注入队列；调用前已占得队列名额
+    void Enqueue(Task&& task);
+    bool TryAcquireSlot();
+    bool WaitForSlot();
+    void ReleaseSlot();
+    bool DropOldest();
+    TaskNode* FindTask(Worker& self);
+    TaskNode* PopInjected(Worker& self);
+    TaskNode* StealFrom(Worker& self);
+    bool Park(Worker& self);
+    void WakeOne();
+    void RunTask(Worker& self, TaskNode* node);
+    void ExecuteTask(TaskNode* node);
+    static void RunInline(Task& task);
+
+    static constexpr size_t kInjectBatch = 16;  // 从注入队列一次取走的任务数上限，多余的放入本地队列供窃取
+
+    static thread_local Worker* t_worker_;      // 当前线程所属的工作线程（非工作线程为nullptr）
 
     // 数据成员
     Config_thread_pool config_;
-    std::vector<std::thread> threads_;
-    std::queue<Task> tasks_;
-    
-    mutable std::mutex queue_mutex_;
+    std::atomic<size_t> core_threads_;
+    std::atomic<size_t> max_threads_;
+    MemoryPool<TaskNode> node_pool_;
+
+    // 工作线程槽位：slots_[0, slot_count_)中非空的为已创建的Worker，创建后不再释放
+    std::unique_ptr<std::atomic<Worker*>[]> slots_;
+    std::atomic<size_t> slot_count_{0};
+    std::vector<std::unique_ptr<Worker>> workers_;  // 槽位上Worker的所有者（resize_mutex_保护）
+    std::mutex resize_mutex_;
+    std::atomic<size_t> live_threads_{0};
+    std::atomic<size_t> peak_threads_{0};
+    std::atomic<uint64_t> threads_started_{0};
+    std::atomic<uint64_t> threads_retired_{0};
+    std::atomic<bool> growing_{false};
+
+    // 全局注入队列（TaskNode::next串成的FIFO链表）
+    mutable std::mutex inject_mutex_;
+    TaskNode* inject_head_ = nullptr;
+    TaskNode* inject_tail_ = nullptr;
+    std::atomic<size_t> injected_size_{0};
+    std::atomic<uint64_t> injected_total_{0};
+
+    std::atomic<size_t> pending_{0};    // 已入队尚未被取走的任务数
+
+    // BLOCK策略下等待空位的提交方
+    std::mutex space_mutex_;
+    std::condition_variable space_condition_;
+    std::atomic<size_t> blocked_submitters_{0};
+
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> caller_runs_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // 停放
+    std::mutex park_mutex_;
     std::condition_variable condition_;
-    bool shutdown_;
+    std::atomic<size_t> sleepers_{0};
+
+    std::atomic<bool> shutdown_;
 };
 
 // 模板方法的实现必须放在头文件中
+template<typename F>
+void ThreadPool::Post(F&& f) {
+    // 防止在关闭后提交新任务
+    if (shutdown_.load(std::memory_order_acquire)) {
+        throw std::runtime_error("ThreadPool is shutdown");
+    }
+    Task task(std::forward<F>(f));
+    if (!Schedule(task)) {
+        throw TaskRejectedError();
+    }
+}
+
+template<typename F>
+bool ThreadPool::TryPost(F&& f) {
+    if (shutdown_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Task task(std::forward<F>(f));
+    return Schedule(task);
+}
+
+template<typename F>
+bool ThreadPool::TryPostNoWait(F&& f) {
+    if (shutdown_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Task task(std::forward<F>(f));
+    return Schedule(task, true);
+}
+
 template<typename F, typename... Args>
-auto ThreadPool::Submit(F&& f, Args&&... args) 
-    -> std::future<typename std::result_of<F(Args...)>::type> {
-    
-    using return_type = typename std::result_of<F(Args...)>::type;//uring声明
-    
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-    );
-    
-    std::future<return_type> res = task->get_future();
-    
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        
-        // 防止在关闭后提交新任务
-        if (shutdown_) {
-            throw std::runtime_error("ThreadPool is shutdown");
-        }
-        
-        tasks_.emplace([task]() { (*task)(); });
+auto ThreadPool::Submit(F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+
+    using return_type = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+    // 防止在关闭后提交新任务
+    if (shutdown_.load(std::memory_order_acquire)) {
+        throw std::runtime_error("ThreadPool is shutdown");
+    }
+
+    // packaged_task只可移动，直接放进Task，不再经过shared_ptr和std::bind
+    std::packaged_task<return_type()> task(
+        [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            return std::apply(std::move(f), std::move(args));
+        });
+
+    std::future<return_type> res = task.get_future();
+    Task wrapped(std::move(task));
+    if (!Schedule(wrapped)) {
+        throw TaskRejectedError();
     }
-    
-    condition_.notify_one();//唤醒一个线程在队列中等待的任务
     return res;
 }
 
-} // namespace ppsever
\ No newline at end of file
+} // namespace ppsever
@@ -0,0 +1,303 @@
+#include "timing_wheel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ppserver {
+
+namespace {
+
+inline uint64_t RotateLeft(uint64_t value, int count) {
+    count &= 63;
+    return count ? (value << count) | (value >> (64 - count)) : value;
+}
+
+inline uint64_t RotateRight(uint64_t value, int count) {
+    count &= 63;
+    return count ? (value >> count) | (value << (64 - count)) : value;
+}
+
+// 最高置位的位置（从1开始），value必须非0
+inline int FindLastSet(uint64_t value) {
+    return 64 - __builtin_clzll(value);
+}
+
+} // namespace
+
+TimingWheel::TimingWheel(uint64_t now_ms)
+    : current_time_(now_ms),
+      pending_{},
+      active_count_(0) {
+}
+
+TimingWheel::TimerId TimingWheel::MakeId(uint32_t index, uint32_t generation) {
+    // 低32位存放index+1，保证有效ID不为0；高32位为代数，防止节点复用后误操作
+    return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) + 1);
+}
+
+TimingWheel::Node* TimingWheel::Lookup(TimerId id) {
+    uint32_t low = static_cast<uint32_t>(id);
+    if (low == 0 || low > nodes_.size()) {
+        return nullptr;
+    }
+    Node& node = nodes_[low - 1];
+    if (node.state == State::FREE || node.generation != static_cast<uint32_t>(id >> 32)) {
+        return nullptr;
+    }
+    return &node;
+}
+
+uint32_t TimingWheel::AllocateNode() {
+    if (!free_nodes_.empty()) {
+        uint32_t index = free_nodes_.back();
+        free_nodes_.pop_back();
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimingWheel::FreeNode(uint32_t index) {
+    Node& node = nodes_[index];
+    node.callback = nullptr;
+    node.state = State::FREE;
+    node.cancelled = false;
+    node.rescheduled = false;
+    ++node.generation;
+    free_nodes_.push_back(index);
+    --active_count_;
+}
+
+TimingWheel::TimerId TimingWheel::Add(uint64_t expires_ms, uint64_t interval_ms, Callback callback) {
+    uint32_t index = AllocateNode();
+    Node& node = nodes_[index];
+    node.callback = std::move(callback);
+    node.expires = expires_ms;
+    node.interval = interval_ms;
+    node.state = State::PENDING;
+    ++active_count_;
+
+    Schedule(index);
+    return MakeId(index, node.generation);
+}
+
+bool TimingWheel::Cancel(TimerId id) {
+    Node* node = Lookup(id);
+    if (!node) {
+        return false;
+    }
+    uint32_t index = static_cast<uint32_t>(id) - 1;
+    if (node->state == State::RUNNING) {
+        node->cancelled = true;   // 回调还在使用该节点，FinishRun时释放
+        return true;
+    }
+    Unlink(index);
+    FreeNode(index);
+    return true;
+}
+
+bool TimingWheel::Reschedule(TimerId id, uint64_t expires_ms) {
+    Node* node = Lookup(id);
+    if (!node || node->cancelled) {
+        return false;
+    }
+    node->expires = expires_ms;
+    if (node->state == State::RUNNING) {
+        node->rescheduled = true;
+        return true;
+    }
+    uint32_t index = static_cast<uint32_t>(id) - 1;
+    Unlink(index);
+    Schedule(index);
+    return true;
+}
+
+void TimingWheel::Schedule(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.expires <= current_time_) {
+        Link(index, kExpiredList);
+        return;
+    }
+
+    uint64_t remaining = std::min(node.expires - current_time_, kMaxTimeout);
+    int wheel = (FindLastSet(remaining) - 1) / kWheelBits;
+    // 高层槽位减1：该槽在当前时间走进它之前就会被级联到低层
+    int slot = static_cast<int>(((node.expires >> (wheel * kWheelBits)) - (wheel ? 1 : 0)) & kWheelMask);
+
+    Link(index, wheel * kWheelSize + slot);
+    pending_[wheel] |= uint64_t(1) << slot;
+}
+
+void TimingWheel::Link(uint32_t index, int list) {
+    Node& node = nodes_[index];
+    List& target = lists_[list];
+    node.list = list;
+    node.prev = target.tail;
+    node.next = kNil;
+    if (target.tail != kNil) {
+        nodes_[target.tail].next = index;
+    } else {
+        target.head = index;
+    }
+    target.tail = index;
+}
+
+void TimingWheel::Unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.list < 0) {
+        return;
+    }
+    List& source = lists_[node.list];
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        source.head = node.next;
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    } else {
+        source.tail = node.prev;
+    }
+    if (source.head == kNil && node.list != kExpiredList) {
+        int wheel = node.list / kWheelSize;
+        int slot = node.list % kWheelSize;
+        pending_[wheel] &= ~(uint64_t(1) << slot);
+    }
+    node.list = -1;
+    node.prev = kNil;
+    node.next = kNil;
+}
+
+void TimingWheel::Advance(uint64_t now_ms) {
+    if (now_ms <= current_time_) {
+        return;
+    }
+
+    uint64_t elapsed = now_ms - current_time_;
+    List todo;
+
+    // 逐层找出从current_time_走到now_ms期间经过的槽，把其中的定时器取出待重新放置
+    for (int wheel = 0; wheel < kWheelCount; ++wheel) {
+        uint64_t pending;
+        if ((elapsed >> (wheel * kWheelBits)) > kWheelMask) {
+            pending = ~uint64_t(0);  // 该层已转过一整圈
+        } else {
+            uint64_t slots_elapsed = kWheelMask & (elapsed >> (wheel * kWheelBits));
+            int old_slot = static_cast<int>(kWheelMask & (current_time_ >> (wheel * kWheelBits)));
+            int new_slot = static_cast<int>(kWheelMask & (now_ms >> (wheel * kWheelBits)));
+            uint64_t mask = (uint64_t(1) << slots_elapsed) - 1;
+            pending = RotateLeft(mask, old_slot);
+            pending |= RotateRight(RotateLeft(mask, new_slot), static_cast<int>(slots_elapsed));
+            pending |= uint64_t(1) << new_slot;
+        }
+
+        while (pending & pending_[wheel]) {
+            int slot = __builtin_ctzll(pending & pending_[wheel]);
+            List& source = lists_[wheel * kWheelSize + slot];
+            for (uint32_t i = source.head; i != kNil; i = nodes_[i].next) {
+                nodes_[i].list = -1;
+            }
+            // 整条链表拼接到todo尾部
+            if (todo.tail != kNil) {
+                nodes_[todo.tail].next = source.head;
+                nodes_[source.head].prev = todo.tail;
+            } else {
+                todo.head = source.head;
+            }
+            todo.tail = source.tail;
+            source.head = source.tail = kNil;
+            pending_[wheel] &= ~(uint64_t(1) << slot);
+        }
+
+        if (!(pending & 0x1)) {
+            break;  // 本层没有绕回0号槽，更高层不会前进
+        }
+        // 本层绕回，下一层至少前进一个槽
+        elapsed = std::max(elapsed, static_cast<uint64_t>(kWheelSize) << (wheel * kWheelBits));
+    }
+
+    current_time_ = now_ms;
+
+    for (uint32_t i = todo.head; i != kNil;) {
+        uint32_t next = nodes_[i].next;
+        nodes_[i].prev = nodes_[i].next = kNil;
+        Schedule(i);
+        i = next;
+    }
+}
+
+TimingWheel::TimerId TimingWheel::PopExpired() {
+    uint32_t index = lists_[kExpiredList].head;
+    if (index == kNil) {
+        return kInvalidTimerId;
+    }
+    Unlink(index);
+    Node& node = nodes_[index];
+    node.state = State::RUNNING;
+    return MakeId(index, node.generation);
+}
+
+TimingWheel::Callback& TimingWheel::GetCallback(TimerId id) {
+    Node* node = Lookup(id);
+    if (!node) {
+        throw std::invalid_argument("TimingWheel: invalid timer id");
+    }
+    return node->callback;
+}
+
+void TimingWheel::FinishRun(TimerId id) {
+    Node* node = Lookup(id);
+    if (!node || node->state != State::RUNNING) {
+        return;
+    }
+    uint32_t index = static_cast<uint32_t>(id) - 1;
+
+    if (node->cancelled) {
+        FreeNode(index);
+        return;
+    }
+    if (node->rescheduled) {
+        node->rescheduled = false;      // 回调中touch过，按新的到期时间放置
+    } else if (node->interval > 0) {
+        node->expires = current_time_ + node->interval;
+    } else {
+        FreeNode(index);
+        return;
+    }
+    node->state = State::PENDING;
+    Schedule(index);
+}
+
+int64_t TimingWheel::NextTimeout() const {
+    if (lists_[kExpiredList].head != kNil) {
+        return 0;
+    }
+    if (active_count_ == 0) {
+        return -1;
+    }
+
+    uint64_t timeout = ~uint64_t(0);
+    uint64_t relmask = 0;
+    bool found = false;
+    for (int wheel = 0; wheel < kWheelCount; ++wheel) {
+        if (pending_[wheel]) {
+            int slot = static_cast<int>(kWheelMask & (current_time_ >> (wheel * kWheelBits)));
+            // 高层的槽至少在一圈之后（否则会在更低层），因此+1
+            uint64_t candidate = static_cast<uint64_t>(
+                __builtin_ctzll(RotateRight(pending_[wheel], slot)) + (wheel ? 1 : 0))
+                << (wheel * kWheelBits);
+            candidate -= relmask & current_time_;  // 减去低层已走过的时间
+            timeout = std::min(timeout, candidate);
+            found = true;
+        }
+        relmask <<= kWheelBits;
+        relmask |= kWheelMask;
+    }
+    // 只有执行中的定时器时没有可等待的槽
+    return found ? static_cast<int64_t>(timeout) : -1;
+}
+
+size_t TimingWheel::Size() const {
+    return active_count_;
+}
+
+} // namespace ppserver
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace ppserver {
+
+/**
+ * TimingWheel - 分层时间轮
+ * 负责：定时器的插入、取消、重新激活（touch）与到期收集，均为O(1)
+ * 设计特点：4层 × 64槽，精度1ms，单层覆盖64^level毫秒；超出最高层范围的定时器
+ *          在最高层循环，级联时重新放置。每层用64位位图记录非空槽，计算下次超时
+ *          只需几次ctz。定时器节点存放在deque中，回调在执行期间地址稳定。
+ * 线程安全：非线程安全，由EventLoop加锁保护
+ */
+class TimingWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId kInvalidTimerId = 0;
+
+    explicit TimingWheel(uint64_t now_ms);
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // 添加定时器：expires_ms为绝对到期时间，interval_ms>0表示重复定时器
+    TimerId Add(uint64_t expires_ms, uint64_t interval_ms, Callback callback);
+
+    // 取消定时器；正在执行回调的定时器会在回调结束后释放
+    bool Cancel(TimerId id);
+
+    // 把已有定时器推迟到expires_ms，复用原节点与回调，不重新分配
+    bool Reschedule(TimerId id, uint64_t expires_ms);
+
+    // 推进时间轮到now_ms，把到期的定时器移入到期链表
+    void Advance(uint64_t now_ms);
+
+    // 取出一个到期定时器并标记为执行中；没有时返回kInvalidTimerId
+    TimerId PopExpired();
+
+    // 执行中定时器的回调（引用在FinishRun前有效）
+    Callback& GetCallback(TimerId id);
+
+    // 回调执行完毕：重复定时器重新放入时间轮，否则释放节点
+    void FinishRun(TimerId id);
+
+    // 距下一个定时器到期的毫秒数，没有定时器时返回-1
+    int64_t NextTimeout() const;
+
+    size_t Size() const;
+
+private:
+    static constexpr int kWheelBits = 6;
+    static constexpr int kWheelSize = 1 << kWheelBits;
+    static constexpr uint64_t kWheelMask = kWheelSize - 1;
+    static constexpr int kWheelCount = 4;
+    static constexpr uint64_t kMaxTimeout = (uint64_t(1) << (kWheelBits * kWheelCount)) - 1;
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr int kExpiredList = kWheelCount * kWheelSize;  // 最后一个链表存放已到期定时器
+    static constexpr int kListCount = kExpiredList + 1;
+
+    enum class State : uint8_t { FREE, PENDING, RUNNING };
+
+    struct Node {
+        Callback callback;
+        uint64_t expires = 0;
+        uint64_t interval = 0;
+        uint32_t generation = 1;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        int list = -1;              // 所在链表下标
+        State state = State::FREE;
+        bool cancelled = false;     // 执行期间被取消
+        bool rescheduled = false;   // 执行期间被touch
+    };
+
+    struct List {
+        uint32_t head = kNil;
+        uint32_t tail = kNil;
+    };
+
+    Node* Lookup(TimerId id);
+    static TimerId MakeId(uint32_t index, uint32_t generation);
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t index);
+    void Schedule(uint32_t index);
+    void Link(uint32_t index, int list);
+    void Unlink(uint32_t index);
+
+    uint64_t current_time_;                 // 时间轮当前时间(毫秒)
+    uint64_t pending_[kWheelCount];         // 每层非空槽位图
+    List lists_[kListCount];
+    std::deque<Node> nodes_;                // deque追加不移动已有元素
+    std::vector<uint32_t> free_nodes_;
+    size_t active_count_;
+};
+
+} // namespace ppserver
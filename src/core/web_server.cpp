@@ -2,14 +2,18 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 #include <iostream>
 #include <memory>
+#include <thread>
 
 #include <cstring>
 #include <cerrno>
+#include <csignal>
+#include <stdexcept>
 namespace ppserver {
-    WebServer* WebServer::instance_ = nullptr;
+    std::atomic<int> WebServer::signal_fd_{-1};
 
 WebServer::WebServer(Config& config, 
                      EventLoop& event_loop,
@@ -19,12 +23,16 @@ WebServer::WebServer(Config& config,
     : config_(config), 
     event_loop_(event_loop),
     connection_manager_(connection_manager)
-    ,thread_pool_(thread_pool) {
-        instance_ = this;
+    ,thread_pool_(thread_pool)
+    ,router_(std::make_shared<Router>()) {
 }
 
 WebServer::~WebServer() {
     Stop();
+    int fd = signal_fd_.exchange(-1);
+    if (fd >= 0) {
+        close(fd);
+    }
 }
 
 
@@ -33,58 +41,269 @@ bool WebServer::Start() {
         return true;
     }
 
-    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-    if (listen_fd_ < 0) {
-        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+    // 对端关闭后sendfile写入会触发SIGPIPE，改为返回EPIPE由连接自行处理
+    signal(SIGPIPE, SIG_IGN);
+    // 进程级设置，IO线程启动前完成
+    RequestBody::SetSpillDirectory(config_.body_spill_directory);
+    // 连接创建时取用，须在监听之前组合好
+    BuildRequestHandler();
+
+    bool ok = false;
+    switch (config_.reactor_mode) {
+        case ReactorMode::SINGLE:
+            ok = StartSingleReactor();
+            break;
+        case ReactorMode::REUSEPORT:
+            ok = StartMultiReactor();
+            break;
+        case ReactorMode::ACCEPTOR:
+            ok = StartAcceptorReactor();
+            break;
+    }
+    if (!ok) {
         return false;
     }
 
+    running_ = true;
+    return true;
+}
+
+int WebServer::CreateListenSocket(bool reuse_port) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
     int opt = 1;
-    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // 多个socket绑定同一端口，由内核按四元组哈希把新连接分发到各个监听队列
+    if (reuse_port &&
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        std::cerr << "Failed to set SO_REUSEPORT: " << strerror(errno) << std::endl;
+        close(listen_fd);
+        return -1;
+    }
 
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_port = htons(config_.port);
     if (inet_pton(AF_INET, config_.host.c_str(), &addr.sin_addr) <= 0) {
         std::cerr << "Invalid address: " << config_.host << std::endl;
-        close(listen_fd_);
-        return false;
+        close(listen_fd);
+        return -1;
     }
 
-    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
         std::cerr << "Failed to bind to " << config_.host << ":" << config_.port 
                   << ": " << strerror(errno) << std::endl;
-        close(listen_fd_);
-        return false;
+        close(listen_fd);
+        return -1;
     }
 
-    if (listen(listen_fd_, config_.backlog) < 0) {
+    if (listen(listen_fd, config_.backlog) < 0) {
         std::cerr << "Failed to listen on socket: " << strerror(errno) << std::endl;
-        close(listen_fd_);
+        close(listen_fd);
+        return -1;
+    }
+
+    return listen_fd;
+}
+
+bool WebServer::StartSingleReactor() {
+    listen_fd_ = CreateListenSocket(false);
+    if (listen_fd_ < 0) {
         return false;
     }
-    
+
+    auto context = std::make_unique<LoopContext>();
+    context->loop = &event_loop_;
+    context->connection_manager = &connection_manager_;
+    context->listen_fd = listen_fd_;
+    InitLoopContext(*context);
+    loop_contexts_.push_back(std::move(context));
+
     // 注册监听listen_fd_的可读事件回调
     event_loop_.AddFd(listen_fd_, EventLoop::EPOLL_READ, [this](int fd, uint32_t /*events*/) {
-        HandleNewConnection(fd, *this);
+        HandleNewConnection(fd, 0);
     });
+    return true;
+}
 
-    running_ = true;
+bool WebServer::StartMultiReactor() {
+    size_t num_loops = ResolveLoopThreads(config_.loop_threads);
+
+    // 先在当前线程创建全部监听socket，任何一个失败都不启动IO线程
+    std::vector<int> listen_fds;
+    for (size_t i = 0; i < num_loops; ++i) {
+        int fd = CreateListenSocket(true);
+        if (fd < 0) {
+            for (int opened : listen_fds) {
+                close(opened);
+            }
+            return false;
+        }
+        listen_fds.push_back(fd);
+    }
+
+    StartIoLoops(num_loops);
+    for (size_t i = 0; i < num_loops; ++i) {
+        loop_contexts_[i]->listen_fd = listen_fds[i];
+    }
+
+    // 监听fd必须在各自的loop线程内注册，保证epoll_ctl串行化到同一线程
+    for (size_t i = 0; i < num_loops; ++i) {
+        LoopContext* context = loop_contexts_[i].get();
+        context->loop->RunInLoop([this, context, i]() {
+            context->loop->AddFd(context->listen_fd, EventLoop::EPOLL_READ,
+                [this, i](int fd, uint32_t /*events*/) {
+                    HandleNewConnection(fd, i);
+                });
+        });
+    }
+
+    std::cout << "Multi-reactor started with " << num_loops
+              << " SO_REUSEPORT listeners" << std::endl;
+    return true;
+}
+
+bool WebServer::StartAcceptorReactor() {
+    listen_fd_ = CreateListenSocket(false);
+    if (listen_fd_ < 0) {
+        return false;
+    }
+
+    size_t num_loops = ResolveLoopThreads(config_.loop_threads);
+    StartIoLoops(num_loops);
+
+    // 主Reactor只负责accept，连接按策略交给IO线程
+    event_loop_.AddFd(listen_fd_, EventLoop::EPOLL_READ, [this](int fd, uint32_t /*events*/) {
+        HandleNewConnection(fd, kAnyLoop);
+    });
+
+    std::cout << "Acceptor reactor started with " << num_loops << " IO loops ("
+              << (config_.load_balance == LoadBalance::ROUND_ROBIN ? "round-robin" : "least-connections")
+              << ")" << std::endl;
     return true;
 }
+
+void WebServer::StartIoLoops(size_t num_loops) {
+    loop_pool_ = std::make_unique<EventLoopThreadPool>(num_loops, config_.io_backend);
+    loop_pool_->Start();
+
+    ConnectionManager::Config manager_config;
+    manager_config.max_connections = config_.max_connections;
+    manager_config.timeout_seconds = config_.timeout_seconds;
+
+    for (size_t i = 0; i < num_loops; ++i) {
+        auto context = std::make_unique<LoopContext>();
+        context->loop = &loop_pool_->GetLoop(i);
+        context->owned_manager = std::make_unique<ConnectionManager>(manager_config);
+        context->connection_manager = context->owned_manager.get();
+        InitLoopContext(*context);
+        loop_contexts_.push_back(std::move(context));
+    }
+}
+
+void WebServer::InitLoopContext(LoopContext& context) {
+    if (!config_.document_root.empty()) {
+        StaticFileHandler::Config files_config;
+        files_config.document_root = config_.document_root;
+        context.static_files = std::make_unique<StaticFileHandler>(files_config);
+    }
+    if (config_.handler_mode == HandlerMode::ADAPTIVE) {
+        RouteCostTracker::Config routes_config;
+        routes_config.inline_threshold = std::chrono::microseconds(config_.inline_threshold_us);
+        routes_config.max_routes = config_.max_tracked_routes;
+        context.route_costs = std::make_unique<RouteCostTracker>(routes_config);
+    }
+    if (config_.pool_connections) {
+        LoopContext* ctx = &context;
+        context.connection_slab = std::make_unique<ConnectionSlab>(config_.connection_pool_size,
+            [this, ctx](int fd) {
+                auto conn = std::make_unique<Connection>(fd, *this, *ctx->loop);
+                ConfigureConnection(*conn, *ctx);
+                return conn.release();
+            });
+    }
+}
+
+size_t WebServer::ResolveLoopThreads(size_t configured) {
+    if (configured > 0) {
+        return configured;
+    }
+    size_t cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+void WebServer::StopLoopContext(LoopContext& context) {
+    if (context.listen_fd >= 0) {
+        context.loop->RemoveFd(context.listen_fd);
+        close(context.listen_fd);
+        context.listen_fd = -1;
+    }
+    context.connection_manager->CloseAllConnections();
+    context.stopped.store(true, std::memory_order_release);
+}
+
 void WebServer::Stop() {
     if (!running_) return;
 
     std::cout << "Stopping server..." << std::endl;
     
     running_ = false;
-    // 关闭监听事件
-    if (listen_fd_ >= 0) {
+
+    // ACCEPTOR模式的监听fd注册在主loop上
+    if (config_.reactor_mode == ReactorMode::ACCEPTOR && listen_fd_ >= 0) {
         event_loop_.RemoveFd(listen_fd_);
         close(listen_fd_);
-        listen_fd_ = -1;
     }
-    connection_manager_.CloseAllConnections();
+
+    if (loop_pool_) {
+        // 收尾任务投递到各自loop线程执行
+        for (auto& context : loop_contexts_) {
+            LoopContext* ctx = context.get();
+            ctx->loop->QueueInLoop([this, ctx]() { StopLoopContext(*ctx); });
+        }
+    } else {
+        for (auto& context : loop_contexts_) {
+            StopLoopContext(*context);
+        }
+    }
+    listen_fd_ = -1;
+    FinishStop();
+}
+
+bool WebServer::HasOffloadsInFlight() const {
+    for (const auto& context : loop_contexts_) {
+        if (!context->stopped.load(std::memory_order_acquire) ||
+            context->offloads_in_flight.load(std::memory_order_acquire) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebServer::FinishStop() {
+    // 交给线程池的请求经所属loop交回，途中持有的连接还引用着loop与连接池：全部交回之前loop须继续运行
+    if (HasOffloadsInFlight()) {
+        if (!loop_pool_ && event_loop_.IsInLoopThread()) {
+            // 单Reactor且在loop线程内：不能阻塞等待，交回之后再检查
+            event_loop_.RunAfter(1, [this]() { FinishStop(); });
+            return;
+        }
+        while (HasOffloadsInFlight()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    if (loop_pool_) {
+        loop_pool_->Stop();
+    }
+    loop_contexts_.clear();
+    loop_pool_.reset();
+
     event_loop_.Stop();
 
     std::cout << "Web server stopped" << std::endl;
@@ -100,64 +319,254 @@ EventLoop& WebServer::GetEventLoop() const {
 }
 
 void WebServer::SetSignalHandlers() {
+    if (signal_fd_.load() < 0) {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create signal eventfd: " + std::string(strerror(errno)));
+        }
+        signal_fd_.store(fd);
+        event_loop_.AddFd(fd, EventLoop::EPOLL_READ, [this](int, uint32_t) { HandleSignal(); });
+    }
     signal(SIGINT, SignalHandler);   // Ctrl+C
     signal(SIGTERM, SignalHandler);  // 终止信号
 }
 
-void WebServer::SignalHandler(int signal) {
-    std::cout << "\nReceived signal " << signal << ", shutting down gracefully..." << std::endl;
-    
-    if (instance_) {
-        instance_->HandleSignal(signal);
+void WebServer::SignalHandler(int /*signal*/) {
+    // 信号可能打断任意线程的任意代码（包括持锁的loop线程），这里只做异步信号安全的write，
+    // 停止流程交给主loop
+    int saved_errno = errno;
+    int fd = signal_fd_.load();
+    if (fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(fd, &one, sizeof(one));
+        (void)n;
     }
+    errno = saved_errno;
 }
 
-void WebServer::HandleSignal(int signal) {
-    std::cout << "Handling signal " << signal << std::endl;
-    Stop();
-    event_loop_.Stop();
+void WebServer::HandleSignal() {
+    uint64_t count = 0;
+    ssize_t n = read(signal_fd_.load(), &count, sizeof(count));
+    (void)n;
+    std::cout << "\nReceived shutdown signal, shutting down gracefully..." << std::endl;
+    event_loop_.RemoveFd(signal_fd_.load());
+    Stop();   // 交给线程池的请求全部交回后停止主loop
 }
 
 
-void WebServer::HandleNewConnection(int listen_fd, WebServer& server) {
-    sockaddr_in client_addr{};
-    socklen_t addr_len = sizeof(client_addr);
-    std::cout << "New connection from " << inet_ntoa(client_addr.sin_addr) << ":" << ntohs(client_addr.sin_port) << std::endl;
-    
-    int client_fd = accept4(listen_fd, reinterpret_cast<sockaddr*>(&client_addr), 
-                           &addr_len, SOCK_NONBLOCK);
-    if (client_fd < 0) {
-        if (on_error_callback_) {
-            on_error_callback_("Accept failed: " + std::string(strerror(errno)));
-        }
+size_t WebServer::GetLoopCount() const {
+    return loop_contexts_.size();
+}
+
+void WebServer::SetBodyHandler(BodyHandler handler) {
+    body_handler_ = std::move(handler);
+}
+
+void WebServer::SetRequestHandler(RequestHandler handler) {
+    user_handler_ = handler ? std::make_shared<const RequestHandler>(std::move(handler)) : nullptr;
+}
+
+void WebServer::Get(std::string_view pattern, RouteHandler handler) {
+    AddRoute(HttpRequest::Method::GET, pattern, std::move(handler));
+}
+
+void WebServer::Post(std::string_view pattern, RouteHandler handler) {
+    AddRoute(HttpRequest::Method::POST, pattern, std::move(handler));
+}
+
+void WebServer::AddRoute(HttpRequest::Method method, std::string_view pattern, RouteHandler handler) {
+    router_->Add(method, pattern, std::move(handler));
+}
+
+void WebServer::Use(Middleware middleware) {
+    router_->Use(std::move(middleware));
+}
+
+void WebServer::BuildRequestHandler() {
+    if (router_->Empty()) {
+        request_handler_ = user_handler_;
         return;
     }
+    // 处理函数捕获路由器与用户处理函数的引用，服务对象先于线程池中的在途任务销毁时依然有效
+    std::shared_ptr<const Router> router = router_;
+    std::shared_ptr<const RequestHandler> fallback = user_handler_;
+    request_handler_ = std::make_shared<const RequestHandler>(
+        [router, fallback](const HttpRequestView& request, HttpResponse& response) {
+            return router->Dispatch(request, response) || (fallback && (*fallback)(request, response));
+        });
+}
+
+std::vector<WebServer::LoopStatistics> WebServer::GetLoopStatistics() const {
+    std::vector<LoopStatistics> stats;
+    stats.reserve(loop_contexts_.size());
+    for (const auto& context : loop_contexts_) {
+        LoopStatistics item;
+        item.active_connections = context->active_connections.load(std::memory_order_relaxed);
+        item.total_connections = context->total_connections.load(std::memory_order_relaxed);
+        item.requests = context->requests.load(std::memory_order_relaxed);
+        item.bytes_read = context->bytes_read.load(std::memory_order_relaxed);
+        item.read_calls = context->read_calls.load(std::memory_order_relaxed);
+        item.bytes_copied = context->bytes_copied.load(std::memory_order_relaxed);
+        item.bytes_written = context->bytes_written.load(std::memory_order_relaxed);
+        item.write_calls = context->write_calls.load(std::memory_order_relaxed);
+        if (context->connection_slab) {
+            ConnectionSlab::Statistics slab = context->connection_slab->GetStatistics();
+            item.connections_created = slab.created;
+            item.connections_reused = slab.reused;
+        }
+        if (context->route_costs) {
+            RouteCostTracker::Statistics routes = context->route_costs->GetStatistics();
+            item.inline_routes = routes.inline_routes;
+            item.offloaded_routes = routes.offloaded_routes;
+            item.switches_to_inline = routes.switches_to_inline;
+            item.switches_to_offload = routes.switches_to_offload;
+            item.inline_requests = routes.inline_requests;
+            item.offloaded_requests = routes.offloaded_requests;
+        }
+        stats.push_back(item);
+    }
+    return stats;
+}
+
+std::vector<WebServer::RouteStatistics> WebServer::GetRouteStatistics() const {
+    std::vector<RouteStatistics> stats;
+    for (size_t i = 0; i < loop_contexts_.size(); ++i) {
+        if (!loop_contexts_[i]->route_costs) {
+            continue;
+        }
+        for (auto& route : loop_contexts_[i]->route_costs->GetRouteStatistics()) {
+            stats.push_back(RouteStatistics{i, std::move(route)});
+        }
+    }
+    return stats;
+}
 
-    // 创建连接对象
-    auto conn = std::make_shared<Connection>(client_fd, server);
-  
+size_t WebServer::SelectLoop() {
+    if (config_.load_balance == LoadBalance::ROUND_ROBIN) {
+        size_t index = next_loop_;
+        next_loop_ = (next_loop_ + 1) % loop_contexts_.size();
+        return index;
+    }
+
+    // 最少连接：计数在分发时已递增，连续accept的突发连接也能分散开
+    size_t best = 0;
+    size_t best_count = loop_contexts_[0]->active_connections.load(std::memory_order_relaxed);
+    for (size_t i = 1; i < loop_contexts_.size(); ++i) {
+        size_t count = loop_contexts_[i]->active_connections.load(std::memory_order_relaxed);
+        if (count < best_count) {
+            best = i;
+            best_count = count;
+        }
+    }
+    return best;
+}
+
+void WebServer::HandleNewConnection(int listen_fd, size_t loop_index) {
+    // 监听fd以边缘触发注册，必须accept到EAGAIN，否则积压的连接不会再次通知
+    while (true) {
+        // 对端地址在Connection初始化时经getpeername获取，这里不取
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && on_error_callback_) {
+                on_error_callback_("Accept failed: " + std::string(strerror(errno)));
+            }
+            return;
+        }
+        size_t target = (loop_index == kAnyLoop) ? SelectLoop() : loop_index;
+        LoopContext& context = *loop_contexts_[target];
+        context.active_connections.fetch_add(1, std::memory_order_relaxed);
+        context.total_connections.fetch_add(1, std::memory_order_relaxed);
+
+        // 连接对象在目标IO线程内创建，之后的读写都不再跨线程。
+        // loop下标压成32位，闭包恰好16字节，放得进std::function的内联存储，不单独分配
+        uint32_t target_index = static_cast<uint32_t>(target);
+        context.loop->RunInLoop([this, client_fd, target_index]() {
+            SetupConnection(client_fd, target_index);
+        });
+    }
+}
+
+void WebServer::ConfigureConnection(Connection& conn, LoopContext& context) {
+    // Handler与连接一一绑定，对象池复用连接时一并复用
     //===================设置自定义有的处理器=============================================================
-    auto handler = std::make_shared<Handler>(event_loop_, *conn, thread_pool_);
-    conn->SetHandler(handler);
+    auto handler = std::make_shared<Handler>(*context.loop, conn, thread_pool_);
+    handler->SetStaticFileHandler(context.static_files.get());
+    handler->SetZeroCopyParsing(config_.zero_copy_parser);
+    handler->SetRequestHandler(request_handler_, config_.handler_mode);
+    handler->SetRouteCostTracker(context.route_costs.get());
+    handler->SetOffloadCounter(&context.offloads_in_flight);
+    handler->SetRouter(router_->Empty() ? nullptr : router_.get(), user_handler_.get());
+    conn.SetHandler(handler);
+    conn.SetTimeout(config_.timeout_seconds);
+    conn.SetKeepAliveTimeout(config_.keep_alive_timeout_seconds);
+    conn.SetBodyLimits(config_.body_memory_limit, config_.max_body_size);
+    conn.SetBodyHandler(body_handler_);
 
+    // 回调由连接自身持有，调用时连接必然存活；fd在调用时读取，复用后依然正确
+    ConnectionManager* manager = context.connection_manager;
+    LoopContext* ctx = &context;
+    Connection* raw_conn = &conn;
+    conn.SetCloseCallback([manager, ctx, raw_conn]() {
+        Connection::IoStatistics io = raw_conn->GetIoStatistics();
+        ctx->requests.fetch_add(io.requests, std::memory_order_relaxed);
+        ctx->bytes_read.fetch_add(io.bytes_read, std::memory_order_relaxed);
+        ctx->read_calls.fetch_add(io.read_calls, std::memory_order_relaxed);
+        ctx->bytes_copied.fetch_add(io.bytes_copied, std::memory_order_relaxed);
+        ctx->bytes_written.fetch_add(io.bytes_written, std::memory_order_relaxed);
+        ctx->write_calls.fetch_add(io.write_calls, std::memory_order_relaxed);
+        manager->RemoveConnection(raw_conn->GetFd());
+        ctx->active_connections.fetch_sub(1, std::memory_order_relaxed);
+    });
+}
 
-    // 注册客户端连接的可读事件回调
-    
-    event_loop_.AddFd(client_fd, EventLoop::EPOLL_READ | EventLoop::EPOLL_ET, 
-        [conn](int , uint32_t events) {
+void WebServer::SetupConnection(int client_fd, size_t loop_index) {
+    LoopContext& context = *loop_contexts_[loop_index];
+    EventLoop& loop = *context.loop;
+
+    // 创建连接对象：优先从本loop的对象池复用
+    std::shared_ptr<Connection> conn;
+    try {
+        if (context.connection_slab) {
+            conn = context.connection_slab->Acquire(client_fd);
+        } else {
+            conn = std::make_shared<Connection>(client_fd, *this, loop);
+            ConfigureConnection(*conn, context);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to create connection: " << e.what() << std::endl;
+        close(client_fd);
+        context.active_connections.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // 注册客户端连接的可读事件回调。只捕获裸指针（闭包放得进std::function的内联存储）：
+    // Close()先RemoveFd再释放连接，回调被调用时连接必然存活
+    Connection* raw_conn = conn.get();
+    loop.AddFd(client_fd, EventLoop::EPOLL_READ | EventLoop::EPOLL_ET, 
+        [raw_conn](int , uint32_t events) {
+            // 处理期间持有引用：读回调中可能Close()并释放管理器中的引用
+            std::shared_ptr<Connection> conn = raw_conn->shared_from_this();
+            // 读回调中可能已Close()，此时不再分发后续事件
             if(events & EventLoop::EPOLL_READ) {
                 conn->HandleReadable();
             }
-            if(events & EventLoop::EPOLL_WRITE) {
+            if((events & EventLoop::EPOLL_WRITE) && conn->GetState() != Connection::State::DISCONNECTED) {
                 conn->HandleWritable();
             }
-            if(events & EventLoop::EPOLL_ERROR) {
+            if((events & EventLoop::EPOLL_ERROR) && conn->GetState() != Connection::State::DISCONNECTED) {
                 conn->HandleError();
             }
         });
 
-    // 将连接添加到管理器中
-    connection_manager_.AddConnection(client_fd, conn);
+    // 将连接添加到所属loop的管理器中，超过上限直接关闭
+    if (!context.connection_manager->AddConnection(client_fd, conn)) {
+        std::cerr << "Too many connections, rejecting fd " << client_fd << std::endl;
+        conn->Close();
+        return;
+    }
     
     // 启动连接
     conn->Start();
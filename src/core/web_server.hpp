@@ -7,10 +7,18 @@
 #include <mutex>
 #include <vector>
 #include <memory>
+#include <atomic>
 #include "event_loop.hpp"
+#include "event_loop_thread_pool.hpp"
+#include "static_file_handler.hpp"
+#include "connection_slab.hpp"
 #include "connection_manager.hpp"
 #include "connection.hpp"
 #include "http_parser.hpp"
+#include "request_body.hpp"
+#include "request_handler.hpp"
+#include "route_cost_tracker.hpp"
+#include "router.hpp"
 
 /*
 WebServer 类定义了一个基于事件驱动的高性能 HTTP 服务器框架，支持路由注册、中间件、连接管理等功能。
@@ -33,6 +41,21 @@ class ConnectionManager;
 class WebServer {
 public:
 
+    // Reactor线程模型
+    enum class ReactorMode {
+        SINGLE,     // 单Reactor：所有accept/读写都在构造时传入的event_loop上
+        REUSEPORT,  // 多Reactor：每个IO线程一个EventLoop + 一个SO_REUSEPORT监听socket
+        ACCEPTOR    // 主从Reactor：event_loop只负责accept，连接通过QueueInLoop交给IO线程
+    };
+
+    using HandlerMode = ppserver::HandlerMode;
+
+    // ACCEPTOR模式下选择IO线程的策略
+    enum class LoadBalance {
+        ROUND_ROBIN,        // 轮询
+        LEAST_CONNECTIONS   // 活跃连接数最少
+    };
+
     struct Config {
         std::string host = "192.168.125.128";      // 监听地址
         uint16_t port = 8888;              // 监听端口
@@ -40,7 +63,54 @@ public:
         int backlog = 1024;                 // 连接队列长度
         size_t max_request_size = 1024 * 1024; // 最大请求大小
         int timeout_seconds = 30;           // 连接超时时间
+        int keep_alive_timeout_seconds = 15; // keep-alive连接在两个请求之间的空闲超时
+        ReactorMode reactor_mode = ReactorMode::SINGLE; // 线程模型
+        size_t loop_threads = 0;            // IO线程数（多Reactor模式下生效，0表示CPU核数）
+        LoadBalance load_balance = LoadBalance::ROUND_ROBIN; // ACCEPTOR模式的分发策略
+        EventLoop::Backend io_backend = EventLoop::Backend::EPOLL; // IO线程的多路复用后端（主loop由调用方创建）
+        std::string document_root;          // 静态文件根目录，为空时不提供静态文件
+        bool zero_copy_parser = true;       // 请求以视图引用读缓冲区，解析不分配内存
+        bool pool_connections = true;       // 每个loop回收复用Connection/Handler对象
+        size_t connection_pool_size = 1024; // 每个loop保留的空闲连接对象上限
+        size_t body_memory_limit = 64 * 1024;   // 请求正文在内存中保留的上限，其余溢出到临时文件
+        size_t max_body_size = 1024ull * 1024 * 1024; // 请求正文上限，超出回复413
+        std::string body_spill_directory = "/tmp";    // 正文溢出临时文件所在目录
+        HandlerMode handler_mode = HandlerMode::INLINE; // 业务处理函数的执行位置
+        size_t inline_threshold_us = 100;   // ADAPTIVE模式：p99耗时低于该值（微秒）的路由在loop线程内执行
+        size_t max_tracked_routes = 1024;   // ADAPTIVE模式：每个loop单独统计耗时的路由数上限
+    };
+
+    // 单个IO线程的连接分布统计
+    struct LoopStatistics {
+        size_t active_connections = 0;   // 当前活跃连接数
+        uint64_t total_connections = 0;  // 累计分配到该loop的连接数
+        // 以下为该loop上已关闭连接的读写路径累计值（见Connection::IoStatistics）
+        uint64_t requests = 0;           // 解析完成的请求数
+        uint64_t bytes_read = 0;         // 读入字节数
+        uint64_t read_calls = 0;         // readv调用次数
+        uint64_t bytes_copied = 0;       // 用户态拷贝字节数
+        uint64_t bytes_written = 0;      // 写出字节数
+        uint64_t write_calls = 0;        // sendmsg/sendfile调用次数
+        // 连接对象池（pool_connections关闭时为0）
+        uint64_t connections_created = 0; // 新建的连接对象数
+        uint64_t connections_reused = 0;  // 复用的连接对象数
+        // ADAPTIVE模式下的路由分类（见RouteCostTracker::Statistics，其它模式为0）
+        size_t inline_routes = 0;         // 当前在loop线程内执行的路由数
+        size_t offloaded_routes = 0;      // 当前交给线程池的路由数
+        uint64_t switches_to_inline = 0;  // 路由改为loop线程内执行的次数
+        uint64_t switches_to_offload = 0; // 路由改为交给线程池的次数
+        uint64_t inline_requests = 0;     // 在loop线程内执行处理函数的请求数
+        uint64_t offloaded_requests = 0;  // 交给线程池执行处理函数的请求数
     };
+
+    // ADAPTIVE模式下单个路由的耗时与当前分类
+    struct RouteStatistics {
+        size_t loop = 0;                  // 所属IO线程（各loop独立分类）
+        RouteCostTracker::RouteStatistics route;
+    };
+
+    // HandleNewConnection的loop_index取该值时，按load_balance策略分发
+    static constexpr size_t kAnyLoop = static_cast<size_t>(-1);
    
     void Stop();
     bool Start();
@@ -55,10 +125,33 @@ public:
             );
     ~WebServer();
 
-    void HandleNewConnection(int listen_fd, WebServer& server);
+    // accept监听fd上的所有新连接，并交给loop_index对应的IO线程（kAnyLoop表示按策略选择）
+    void HandleNewConnection(int listen_fd, size_t loop_index);
 
 
     EventLoop& GetEventLoop() const;
+    size_t GetLoopCount() const;
+    std::vector<LoopStatistics> GetLoopStatistics() const;
+    std::vector<RouteStatistics> GetRouteStatistics() const;
+
+    // 为请求正文选择分段回调（与Connection::BodyHandler相同），须在Start之前设置
+    using BodyHandler = std::function<BodyChunkCallback(Connection& conn, const HttpRequest& request)>;
+    void SetBodyHandler(BodyHandler handler);
+
+    // 业务处理函数（见request_handler.hpp），config.handler_mode为ASYNC时在工作线程中调用，
+    // request引用请求的独立拷贝；须在Start之前设置
+    using RequestHandler = ppserver::RequestHandler;
+    void SetRequestHandler(RequestHandler handler);
+
+    // 注册路由与中间件（见Router），须在Start之前调用；模式非法或与已有路由冲突时抛出std::runtime_error。
+    // 注册后请求先经路由器分发，未匹配的再交给SetRequestHandler设置的处理函数，最后回退到静态文件/默认页面；
+    // 处理函数的执行位置同样由config.handler_mode决定
+    using RouteHandler = Router::Handler;
+    using Middleware = Router::Middleware;
+    void Get(std::string_view pattern, RouteHandler handler);
+    void Post(std::string_view pattern, RouteHandler handler);
+    void AddRoute(HttpRequest::Method method, std::string_view pattern, RouteHandler handler);
+    void Use(Middleware middleware);
 
    
 
@@ -69,15 +162,54 @@ public:
     WebServer& operator=(WebServer&&) = delete;
 
 
-     // 信号处理相关方法
+     // 信号处理相关方法：信号处理函数只写eventfd，Stop在主loop线程内执行
     void SetSignalHandlers();
     static void SignalHandler(int signal);
-    void HandleSignal(int signal);
+    void HandleSignal();
 
           
     
 private:
 
+    // 每个IO线程独占的上下文：loop、监听fd与连接集合只在该loop线程内访问
+    struct LoopContext {
+        EventLoop* loop = nullptr;
+        ConnectionManager* connection_manager = nullptr;
+        std::unique_ptr<ConnectionManager> owned_manager;  // 多Reactor模式下每个loop独立的连接集合
+        int listen_fd = -1;
+        std::unique_ptr<StaticFileHandler> static_files;  // 每个loop独立的文件缓存（无需加锁）
+        std::unique_ptr<ConnectionSlab> connection_slab;  // 每个loop独立的连接对象池
+        std::unique_ptr<RouteCostTracker> route_costs;    // ADAPTIVE模式下每个loop独立的路由耗时统计
+        // 交给线程池、结果尚未在本loop处理完的请求数；Stop等其归零后才销毁loop与本上下文
+        std::atomic<size_t> offloads_in_flight{0};
+        std::atomic<bool> stopped{false};           // StopLoopContext已执行，之后不会再有新的请求交给线程池
+        std::atomic<size_t> active_connections{0};  // 分发时递增（含在途连接），关闭时递减
+        std::atomic<uint64_t> total_connections{0};
+        // 连接关闭时汇总其读写路径统计，只在该loop线程内写入
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> bytes_read{0};
+        std::atomic<uint64_t> read_calls{0};
+        std::atomic<uint64_t> bytes_copied{0};
+        std::atomic<uint64_t> bytes_written{0};
+        std::atomic<uint64_t> write_calls{0};
+    };
+
+    int CreateListenSocket(bool reuse_port);
+    void InitLoopContext(LoopContext& context);
+    void ConfigureConnection(Connection& conn, LoopContext& context);
+    void BuildRequestHandler();
+    bool StartSingleReactor();
+    bool StartMultiReactor();
+    bool StartAcceptorReactor();
+    void StartIoLoops(size_t num_loops);
+    size_t SelectLoop();
+    void SetupConnection(int client_fd, size_t loop_index);
+    void StopLoopContext(LoopContext& context);
+    // 等各loop交给线程池的请求全部交回后销毁loop与上下文，并停止主loop
+    void FinishStop();
+    bool HasOffloadsInFlight() const;
+    static size_t ResolveLoopThreads(size_t configured);
+
     // 添加缺失的成员变量
     Config &config_;
     EventLoop& event_loop_;
@@ -88,13 +220,21 @@ private:
     bool running_ = false;
     int listen_fd_ = -1;
 
-    // 用于信号处理的静态成员
-    static WebServer* instance_;
+    std::unique_ptr<EventLoopThreadPool> loop_pool_;          // 多Reactor模式下的IO线程
+    std::vector<std::unique_ptr<LoopContext>> loop_contexts_;
+    size_t next_loop_ = 0;                                     // 轮询游标，仅accept线程访问
+
+    // 信号到达时写入的eventfd，由主loop监听；静态原子量保证信号处理函数内读取是异步信号安全的
+    static std::atomic<int> signal_fd_;
     
 
     std::function<void(Connection&)> on_connection_callback_;
     std::function<void(Connection&)> on_disconnection_callback_;
     std::function<void(const std::string&)> on_error_callback_;
+    BodyHandler body_handler_;
+    std::shared_ptr<const RequestHandler> user_handler_;      // SetRequestHandler设置的处理函数
+    std::shared_ptr<Router> router_;
+    std::shared_ptr<const RequestHandler> request_handler_;   // Start时组合路由器与user_handler_，在途的异步任务各持一份引用
     
 
 };
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ppserver {
+
+/**
+ * WorkStealingDeque - Chase-Lev工作窃取双端队列
+ * 负责：ThreadPool中每个工作线程的本地任务队列
+ * 设计特点：所有者在底部Push/Pop（LIFO，缓存友好），其它线程从顶部Steal（FIFO）；
+ *          所有者操作只在队列剩最后一个元素时才与窃取者CAS竞争，其余情况无原子读改写；
+ *          环形数组满时所有者换成两倍大小的新数组，旧数组保留到队列销毁，
+ *          正在读旧数组的窃取者不会访问已释放内存（算法见Lê等人2013年的C11版本）。
+ *          T须可平凡拷贝（通常为指针）
+ */
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256)
+        : top_(0), bottom_(0) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        arrays_.push_back(std::make_unique<Array>(rounded));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // 仅所有者线程调用
+    void Push(T item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(array->capacity) - 1) {
+            array = Grow(array, top, bottom);
+        }
+        array->Put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    // 仅所有者线程调用，取最近Push的元素
+    bool Pop(T& item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);   // 队列为空
+            return false;
+        }
+        item = array->Get(bottom);
+        if (top == bottom) {
+            // 最后一个元素：与窃取者竞争
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // 任意线程调用，取最早Push的元素；与其它线程竞争失败时返回false
+    bool Steal(T& item) {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+        Array* array = array_.load(std::memory_order_acquire);
+        T candidate = array->Get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        item = candidate;
+        return true;
+    }
+
+    // 近似值，供调度决策与统计使用
+    size_t Size() const {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+    bool Empty() const { return Size() == 0; }
+
+private:
+    struct Array {
+        explicit Array(size_t capacity)
+            : capacity(capacity), mask(capacity - 1), items(new std::atomic<T>[capacity]) {}
+
+        T Get(int64_t index) const {
+            return items[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+        void Put(int64_t index, T item) {
+            items[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    Array* Grow(Array* old_array, int64_t top, int64_t bottom) {
+        arrays_.push_back(std::make_unique<Array>(old_array->capacity * 2));
+        Array* array = arrays_.back().get();
+        for (int64_t i = top; i < bottom; ++i) {
+            array->Put(i, old_array->Get(i));
+        }
+        array_.store(array, std::memory_order_release);
+        return array;
+    }
+
+    alignas(64) std::atomic<int64_t> top_;      // 窃取端
+    alignas(64) std::atomic<int64_t> bottom_;   // 所有者端
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;  // 当前与已替换的数组，只由所有者修改
+};
+
+} // namespace ppserver
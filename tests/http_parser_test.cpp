@@ -0,0 +1,128 @@
+#include <iostream>
+#include <string>
+
+#include "http_parser.hpp"
+#include "http_request.hpp"
+#include "http_request_view.hpp"
+#include "test_check.hpp"
+
+using namespace ppserver;
+
+namespace {
+
+// 一次传入完整数据的解析结果
+struct Outcome {
+    bool success = false;
+    ParseState state = ParseState::START_LINE;
+    size_t bytes_parsed = 0;
+    std::string body;
+};
+
+Outcome ParseCopy(const std::string& data) {
+    HttpParser parser;
+    ParseResult result = parser.Parse(data.data(), data.size());
+    Outcome outcome{result.success, result.state, result.bytes_parsed, {}};
+    if (result.state == ParseState::COMPLETE) {
+        outcome.body = std::string(parser.GetRequest()->GetBody());
+    }
+    return outcome;
+}
+
+// 与Connection相同：ParseView要求回退时在同一个解析器上改用Parse
+Outcome ParseZeroCopy(const std::string& data) {
+    HttpParser parser;
+    HttpRequestView view;
+    ParseResult result = parser.ParseView(data.data(), data.size(), view);
+    if (result.success && result.fallback) {
+        result = parser.Parse(data.data(), data.size());
+        Outcome outcome{result.success, result.state, result.bytes_parsed, {}};
+        if (result.state == ParseState::COMPLETE) {
+            outcome.body = std::string(parser.GetRequest()->GetBody());
+        }
+        return outcome;
+    }
+    return Outcome{result.success, result.state, result.bytes_parsed, std::string(view.GetBody())};
+}
+
+void ExpectRejected(const std::string& data) {
+    Outcome copy = ParseCopy(data);
+    Outcome view = ParseZeroCopy(data);
+    CHECK(!copy.success && copy.state == ParseState::ERROR);
+    CHECK(!view.success && view.state == ParseState::ERROR);
+}
+
+// 两种模式都解析出完整请求，请求边界与正文一致
+void ExpectComplete(const std::string& data, size_t length, const std::string& body) {
+    Outcome copy = ParseCopy(data);
+    Outcome view = ParseZeroCopy(data);
+    CHECK(copy.success && copy.state == ParseState::COMPLETE);
+    CHECK(view.success && view.state == ParseState::COMPLETE);
+    CHECK(copy.bytes_parsed == length && view.bytes_parsed == length);
+    CHECK(copy.body == body && view.body == body);
+}
+
+} // namespace
+
+static void TestContentLength() {
+    std::string request = "POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    ExpectComplete(request, request.size(), "hello");
+    // 流水线上的下一个请求不计入本请求
+    ExpectComplete(request + "GET /b HTTP/1.1\r\n\r\n", request.size(), "hello");
+    // 相同值的重复Content-Length可以接受
+    std::string duplicate = "POST /a HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 5\r\n\r\nhello";
+    ExpectComplete(duplicate, duplicate.size(), "hello");
+
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: 5abc\r\n\r\nhello");
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: +5\r\n\r\nhello");
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: -1\r\n\r\nhello");
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: \r\n\r\nhello");
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n");
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\nhello!");
+}
+
+static void TestTransferEncoding() {
+    std::string chunked = "POST /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                          "5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+    ExpectComplete(chunked, chunked.size(), "hello world");
+    // 编码名不区分大小写
+    std::string upper = "POST /a HTTP/1.1\r\nTransfer-Encoding: CHUNKED\r\n\r\n5\r\nhello\r\n0\r\n\r\n";
+    ExpectComplete(upper, upper.size(), "hello");
+
+    // 同时带Transfer-Encoding与Content-Length：两种理解的请求边界不同，拒绝
+    ExpectRejected("POST /a HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n"
+                   "5\r\nhello\r\n0\r\n\r\n");
+    ExpectRejected("POST /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n"
+                   "5\r\nhello\r\n0\r\n\r\n");
+    // 不支持的编码与重复的Transfer-Encoding
+    ExpectRejected("POST /a HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n");
+    ExpectRejected("POST /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n"
+                   "0\r\n\r\n");
+}
+
+// 数据逐字节到达时与一次到达的结果一致
+static void TestIncrementalInput() {
+    std::string request = "POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    HttpParser parser;
+    std::string buffer;
+    ParseResult result{};
+    for (char c : request) {
+        buffer.push_back(c);
+        result = parser.Parse(buffer.data(), buffer.size());
+        CHECK(result.success);
+        buffer.erase(0, result.bytes_parsed);
+        if (result.state == ParseState::COMPLETE) {
+            break;
+        }
+    }
+    CHECK(result.state == ParseState::COMPLETE);
+    CHECK(buffer.empty());
+    CHECK(parser.GetRequest()->GetBody() == "hello");
+}
+
+int main() {
+    TestContentLength();
+    TestTransferEncoding();
+    TestIncrementalInput();
+    std::cout << "http_parser_test passed" << std::endl;
+    return 0;
+}
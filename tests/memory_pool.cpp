@@ -1,2 +0,0 @@
-#include"memory_pool"
-
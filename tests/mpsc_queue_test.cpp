@@ -0,0 +1,87 @@
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "mpsc_queue.hpp"
+#include "test_check.hpp"
+
+using namespace ppserver;
+
+namespace {
+
+struct Node {
+    std::atomic<Node*> next{nullptr};
+    int producer = 0;
+    int sequence = 0;
+};
+
+} // namespace
+
+// 单线程：先进先出，取空后可继续使用（stub节点被放回的路径）
+static void TestSingleThreaded() {
+    MpscQueue<Node> queue;
+    CHECK(queue.Pop() == nullptr);
+
+    std::vector<Node> nodes(5);
+    for (int round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].sequence = static_cast<int>(i);
+            queue.Push(&nodes[i]);
+        }
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            Node* node = queue.Pop();
+            CHECK(node == &nodes[i]);
+        }
+        CHECK(queue.Pop() == nullptr);
+    }
+}
+
+// 多个生产者并发Push：消费者取到全部节点，且同一生产者的节点保持入队顺序。
+// Pop在生产者链接next之前可能暂时返回nullptr，消费者重试即可
+static void TestConcurrentProducers() {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 100000;
+
+    MpscQueue<Node> queue;
+    std::vector<std::vector<Node>> nodes;
+    for (int p = 0; p < kProducers; ++p) {
+        nodes.emplace_back(kPerProducer);
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, &nodes, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                Node& node = nodes[p][i];
+                node.producer = p;
+                node.sequence = i;
+                queue.Push(&node);
+            }
+        });
+    }
+
+    std::vector<int> next_sequence(kProducers, 0);
+    int received = 0;
+    while (received < kProducers * kPerProducer) {
+        Node* node = queue.Pop();
+        if (!node) {
+            std::this_thread::yield();
+            continue;
+        }
+        CHECK(node->producer >= 0 && node->producer < kProducers);
+        CHECK(node->sequence == next_sequence[node->producer]);
+        ++next_sequence[node->producer];
+        ++received;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    CHECK(queue.Pop() == nullptr);
+}
+
+int main() {
+    TestSingleThreaded();
+    TestConcurrentProducers();
+    std::cout << "mpsc_queue_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// 单元测试用的断言：失败时打印位置并以非零退出码结束，由ctest判定结果
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond << std::endl; \
+            std::exit(1);                                                               \
+        }                                                                               \
+    } while (0)
+
+namespace ppserver {
+namespace test {
+
+// 轮询等待条件成立，超时返回false；用于等待其它线程推进到某个状态
+template <typename Predicate>
+bool WaitUntil(Predicate pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace test
+} // namespace ppserver
@@ -0,0 +1,227 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "test_check.hpp"
+#include "thread_pool.hpp"
+
+using namespace ppserver;
+using ppserver::test::WaitUntil;
+using namespace std::chrono_literals;
+
+namespace {
+
+// 让工作线程卡在任务里，直到Open；用于把队列填满或制造积压
+class Gate {
+public:
+    void Wait() {
+        entered_.fetch_add(1, std::memory_order_relaxed);
+        while (!open_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    void Open() { open_.store(true, std::memory_order_release); }
+    int Entered() const { return entered_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> open_{false};
+    std::atomic<int> entered_{0};
+};
+
+// 单线程、队列容量为2的池，唯一的工作线程已被gate占住
+ThreadPool::Config_thread_pool SaturatedConfig(ThreadPool::RejectPolicy policy) {
+    ThreadPool::Config_thread_pool config;
+    config.core_threads = 1;
+    config.max_threads = 1;
+    config.max_tasks = 2;
+    config.reject_policy = policy;
+    config.block_timeout = 100ms;
+    return config;
+}
+
+void Occupy(ThreadPool& pool, Gate& gate) {
+    pool.Post([&gate]() { gate.Wait(); });
+    CHECK(WaitUntil([&gate]() { return gate.Entered() == 1; }));
+}
+
+} // namespace
+
+static void TestRejectPolicy() {
+    ThreadPool pool(SaturatedConfig(ThreadPool::RejectPolicy::REJECT));
+    Gate gate;
+    Occupy(pool, gate);
+
+    std::atomic<int> ran{0};
+    CHECK(pool.TryPost([&ran]() { ran.fetch_add(1); }));
+    CHECK(pool.TryPost([&ran]() { ran.fetch_add(1); }));
+    CHECK(!pool.TryPost([&ran]() { ran.fetch_add(100); }));
+    bool threw = false;
+    try {
+        pool.Post([&ran]() { ran.fetch_add(100); });
+    } catch (const TaskRejectedError&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(pool.GetStatistics().rejected == 2);
+
+    gate.Open();
+    pool.Shutdown(true);
+    CHECK(ran.load() == 2);
+}
+
+static void TestCallerRunsPolicy() {
+    ThreadPool pool(SaturatedConfig(ThreadPool::RejectPolicy::CALLER_RUNS));
+    Gate gate;
+    Occupy(pool, gate);
+
+    CHECK(pool.TryPost([]() {}));
+    CHECK(pool.TryPost([]() {}));
+    std::thread::id ran_on;
+    CHECK(pool.TryPost([&ran_on]() { ran_on = std::this_thread::get_id(); }));
+    CHECK(ran_on == std::this_thread::get_id());
+    CHECK(pool.GetStatistics().caller_runs == 1);
+
+    // IO线程使用的提交方式：不在调用方执行，直接拒绝
+    CHECK(!pool.TryPostNoWait([]() {}));
+    CHECK(pool.GetStatistics().rejected == 1);
+
+    gate.Open();
+    pool.Shutdown(true);
+}
+
+static void TestDropOldestPolicy() {
+    ThreadPool pool(SaturatedConfig(ThreadPool::RejectPolicy::DROP_OLDEST));
+    Gate gate;
+    Occupy(pool, gate);
+
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&mutex, &order](int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(value);
+    };
+    std::future<void> oldest = pool.Submit([&record]() { record(1); });
+    pool.Post([&record]() { record(2); });
+    // 新任务把最早排队的任务挤出队列，其future得到broken_promise
+    pool.Post([&record]() { record(3); });
+    // IO线程使用的提交方式同样丢弃最旧任务
+    CHECK(pool.TryPostNoWait([&record]() { record(4); }));
+    CHECK(pool.GetStatistics().dropped == 2);
+
+    gate.Open();
+    bool broken = false;
+    try {
+        oldest.get();
+    } catch (const std::future_error& e) {
+        broken = e.code() == std::future_errc::broken_promise;
+    }
+    CHECK(broken);
+    pool.Shutdown(true);
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(order.size() == 2 && order[0] == 3 && order[1] == 4);
+}
+
+static void TestBlockPolicy() {
+    ThreadPool pool(SaturatedConfig(ThreadPool::RejectPolicy::BLOCK));
+    Gate gate;
+    Occupy(pool, gate);
+
+    CHECK(pool.TryPost([]() {}));
+    CHECK(pool.TryPost([]() {}));
+
+    // 队列一直满：等满block_timeout后拒绝
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!pool.TryPost([]() {}));
+    auto waited = std::chrono::steady_clock::now() - start;
+    CHECK(waited >= 90ms);
+    CHECK(pool.GetStatistics().rejected == 1);
+
+    // IO线程使用的提交方式不等待
+    start = std::chrono::steady_clock::now();
+    CHECK(!pool.TryPostNoWait([]() {}));
+    CHECK(std::chrono::steady_clock::now() - start < 50ms);
+    CHECK(pool.GetStatistics().rejected == 2);
+
+    // 等待期间腾出空位：提交成功
+    std::thread opener([&gate]() {
+        std::this_thread::sleep_for(20ms);
+        gate.Open();
+    });
+    std::atomic<bool> ran{false};
+    CHECK(pool.TryPost([&ran]() { ran.store(true); }));
+    opener.join();
+    pool.Shutdown(true);
+    CHECK(ran.load());
+    CHECK(pool.GetStatistics().rejected == 2);
+}
+
+// 全部线程卡住且任务排队超过grow_threshold时扩容到max_threads，空闲keep_alive_time后退回core_threads
+static void TestElasticGrowAndRetire() {
+    ThreadPool::Config_thread_pool config;
+    config.core_threads = 1;
+    config.max_threads = 3;
+    config.max_tasks = 0;
+    config.grow_threshold = 1ms;
+    config.keep_alive_time = std::chrono::seconds(1);
+    ThreadPool pool(config);
+    CHECK(pool.GetStatistics().threads == 1);
+
+    Gate gate;
+    for (int i = 0; i < 6; ++i) {
+        pool.Post([&gate]() { gate.Wait(); });
+        std::this_thread::sleep_for(5ms);
+    }
+    CHECK(WaitUntil([&gate]() { return gate.Entered() == 3; }));
+    ThreadPool::Statistics stats = pool.GetStatistics();
+    CHECK(stats.threads == 3);
+    CHECK(stats.peak_threads == 3);
+    CHECK(stats.threads_started == 3);
+
+    gate.Open();
+    CHECK(WaitUntil([&pool]() { return pool.GetStatistics().completed == 6; }));
+    CHECK(WaitUntil([&pool]() { return pool.GetStatistics().threads == 1; }, 5000ms));
+    stats = pool.GetStatistics();
+    CHECK(stats.threads_retired == 2);
+    CHECK(stats.peak_threads == 3);
+
+    // 退出的线程不影响之后的任务
+    std::future<int> result = pool.Submit([]() { return 42; });
+    CHECK(result.get() == 42);
+}
+
+// 工作线程内提交的任务进入本地队列，空闲线程从中窃取，全部执行一次
+static void TestWorkStealing() {
+    ThreadPool::Config_thread_pool config;
+    config.core_threads = 4;
+    config.max_threads = 4;
+    config.max_tasks = 0;
+    ThreadPool pool(config);
+
+    constexpr int kTasks = 20000;
+    std::atomic<int> ran{0};
+    pool.Post([&pool, &ran]() {
+        for (int i = 0; i < kTasks; ++i) {
+            pool.Post([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+        }
+    });
+    CHECK(WaitUntil([&ran]() { return ran.load() == kTasks; }));
+    ThreadPool::Statistics stats = pool.GetStatistics();
+    CHECK(stats.local_pushes == kTasks);
+    pool.Shutdown(true);
+    CHECK(ran.load() == kTasks);
+}
+
+int main() {
+    TestRejectPolicy();
+    TestCallerRunsPolicy();
+    TestDropOldestPolicy();
+    TestBlockPolicy();
+    TestElasticGrowAndRetire();
+    TestWorkStealing();
+    std::cout << "thread_pool_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "test_check.hpp"
+#include "timing_wheel.hpp"
+
+using namespace ppserver;
+
+// 推进到now_ms并执行全部到期定时器，返回执行的个数
+static size_t RunExpired(TimingWheel& wheel, uint64_t now_ms) {
+    wheel.Advance(now_ms);
+    size_t count = 0;
+    TimingWheel::TimerId id;
+    while ((id = wheel.PopExpired()) != TimingWheel::kInvalidTimerId) {
+        wheel.GetCallback(id)();
+        wheel.FinishRun(id);
+        ++count;
+    }
+    return count;
+}
+
+static void TestOneShotCancelAndReschedule() {
+    TimingWheel wheel(1000);
+    int fired = 0;
+    TimingWheel::TimerId a = wheel.Add(1010, 0, [&]() { ++fired; });
+    TimingWheel::TimerId b = wheel.Add(1020, 0, [&]() { fired += 10; });
+    TimingWheel::TimerId c = wheel.Add(1030, 0, [&]() { fired += 100; });
+    CHECK(wheel.Size() == 3);
+    CHECK(wheel.NextTimeout() >= 0 && wheel.NextTimeout() <= 10);
+
+    CHECK(wheel.Cancel(b));
+    CHECK(!wheel.Cancel(b));
+    CHECK(wheel.Reschedule(c, 1100));
+
+    CHECK(RunExpired(wheel, 1009) == 0);
+    CHECK(RunExpired(wheel, 1010) == 1 && fired == 1);
+    CHECK(RunExpired(wheel, 1099) == 0);
+    CHECK(RunExpired(wheel, 1100) == 1 && fired == 101);
+    CHECK(wheel.Size() == 0);
+    CHECK(wheel.NextTimeout() == -1);
+    // 已执行完的一次性定时器ID失效
+    CHECK(!wheel.Cancel(a));
+    CHECK(!wheel.Reschedule(c, 2000));
+}
+
+static void TestRepeatingTimer() {
+    TimingWheel wheel(0);
+    int fired = 0;
+    TimingWheel::TimerId id = 0;
+    id = wheel.Add(5, 5, [&]() {
+        // 回调中取消自身：本次执行完后释放
+        if (++fired == 3) {
+            wheel.Cancel(id);
+        }
+    });
+    for (uint64_t now = 1; now <= 40; ++now) {
+        RunExpired(wheel, now);
+    }
+    CHECK(fired == 3);
+    CHECK(wheel.Size() == 0);
+}
+
+// 跨越各层（含超出最高层范围）的定时器：都不会提前触发，且在第一次推进到到期时间时触发
+static void TestCascadingAcrossWheels() {
+    constexpr uint64_t kStart = 123456;
+    TimingWheel wheel(kStart);
+    std::unordered_map<uint64_t, uint64_t> expires;   // 序号 -> 到期时间
+    std::vector<uint64_t> fired_at;
+    uint64_t now = kStart;
+
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    auto next_random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+
+    constexpr size_t kTimers = 2000;
+    fired_at.assign(kTimers, 0);
+    for (size_t i = 0; i < kTimers; ++i) {
+        // 延迟分布在1ms到约2^25ms之间，覆盖全部4层并超出最高层
+        uint64_t delay = 1 + (next_random() % (uint64_t(1) << (6 * (1 + i % 5))));
+        expires[i] = kStart + delay;
+        wheel.Add(kStart + delay, 0, [&fired_at, &now, i]() { fired_at[i] = now; });
+    }
+
+    uint64_t previous = now;
+    while (wheel.Size() > 0) {
+        uint64_t step = 1 + next_random() % (next_random() % 4 == 0 ? 200000 : 100);
+        previous = now;
+        now += step;
+        RunExpired(wheel, now);
+        for (size_t i = 0; i < kTimers; ++i) {
+            if (fired_at[i] == now) {
+                CHECK(expires[i] <= now);
+                CHECK(expires[i] > previous);
+            }
+        }
+    }
+    for (size_t i = 0; i < kTimers; ++i) {
+        CHECK(fired_at[i] != 0);
+    }
+}
+
+int main() {
+    TestOneShotCancelAndReschedule();
+    TestRepeatingTimer();
+    TestCascadingAcrossWheels();
+    std::cout << "timing_wheel_test passed" << std::endl;
+    return 0;
+}
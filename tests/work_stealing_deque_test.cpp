@@ -0,0 +1,91 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "test_check.hpp"
+#include "work_stealing_deque.hpp"
+
+using namespace ppserver;
+
+// 单线程：所有者端LIFO，窃取端FIFO，扩容后元素不丢
+static void TestSingleThreaded() {
+    WorkStealingDeque<int64_t> deque(2);
+    for (int64_t i = 1; i <= 10; ++i) {
+        deque.Push(i);
+    }
+    CHECK(deque.Size() == 10);
+
+    int64_t item = 0;
+    CHECK(deque.Steal(item) && item == 1);
+    CHECK(deque.Pop(item) && item == 10);
+    CHECK(deque.Steal(item) && item == 2);
+    CHECK(deque.Pop(item) && item == 9);
+    for (int64_t expected = 8; expected >= 3; --expected) {
+        CHECK(deque.Pop(item) && item == expected);
+    }
+    CHECK(!deque.Pop(item));
+    CHECK(!deque.Steal(item));
+    CHECK(deque.Empty());
+}
+
+// 所有者边Push边Pop，多个窃取者同时Steal：每个元素恰好被取走一次。
+// 初始容量很小，运行中会多次扩容；所有者频繁Pop到只剩一个元素，与窃取者在top上竞争
+static void TestConcurrentPopAndSteal() {
+    constexpr int64_t kItems = 200000;
+    constexpr int kThieves = 3;
+
+    WorkStealingDeque<int64_t> deque(4);
+    std::vector<std::atomic<uint8_t>> taken(kItems);
+    for (auto& flag : taken) {
+        flag.store(0, std::memory_order_relaxed);
+    }
+    std::atomic<int64_t> total{0};
+    std::atomic<bool> done{false};
+
+    auto take = [&](int64_t item) {
+        CHECK(item >= 0 && item < kItems);
+        CHECK(taken[item].fetch_add(1, std::memory_order_relaxed) == 0);
+        total.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < kThieves; ++t) {
+        thieves.emplace_back([&]() {
+            int64_t item = 0;
+            while (!done.load(std::memory_order_acquire) || !deque.Empty()) {
+                if (deque.Steal(item)) {
+                    take(item);
+                }
+            }
+        });
+    }
+
+    int64_t item = 0;
+    for (int64_t i = 0; i < kItems; ++i) {
+        deque.Push(i);
+        if (i % 3 == 0 && deque.Pop(item)) {
+            take(item);
+        }
+    }
+    while (deque.Pop(item)) {
+        take(item);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    CHECK(total.load() == kItems);
+    for (int64_t i = 0; i < kItems; ++i) {
+        CHECK(taken[i].load(std::memory_order_relaxed) == 1);
+    }
+}
+
+int main() {
+    TestSingleThreaded();
+    TestConcurrentPopAndSteal();
+    std::cout << "work_stealing_deque_test passed" << std::endl;
+    return 0;
+}